@@ -23,12 +23,20 @@
 #pragma once
 
 #define DECLARE_DETOUR_FUNCTION(ReturnType, FunctionName, ...)                                                         \
-    extern ReturnType (*original_##FunctionName)(##__VA_ARGS__);                                                       \
-    ReturnType hooked_##FunctionName(##__VA_ARGS__)
+    extern ReturnType (*original_##FunctionName)(__VA_ARGS__);                                                         \
+    ReturnType hooked_##FunctionName(__VA_ARGS__)
 
 #define DEFINE_DETOUR_FUNCTION(ReturnType, FunctionName, ...)                                                          \
-    ReturnType (*original_##FunctionName)(##__VA_ARGS__) = nullptr;                                                    \
-    ReturnType hooked_##FunctionName(##__VA_ARGS__)
+    ReturnType (*original_##FunctionName)(__VA_ARGS__) = nullptr;                                                      \
+    ReturnType hooked_##FunctionName(__VA_ARGS__)
+
+// The address of a virtual method, eg: to tell whether two interfaces share an implementation.
+template <class T>
+void* GetMethodAddress(T* instance, unsigned int methodOffset) {
+    return (*(void***)instance)[methodOffset];
+}
+
+#ifndef DRIVER_SHIM_PORTABLE
 
 template <class T, typename TMethod>
 void DetourMethodAttach(T* instance, unsigned int methodOffset, TMethod hooked, TMethod& original) {
@@ -83,3 +91,30 @@ void DetourFunctionAttach(TMethod target, TMethod hooked, TMethod& original) {
 
     DetourTransactionCommit();
 }
+
+#else
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Without Detours, we patch the vtable slot directly. This only intercepts calls made through the vtable, which is
+// all we need for the interfaces of the (fake) runtime.
+template <class T, typename TMethod>
+void DetourMethodAttach(T* instance, unsigned int methodOffset, TMethod hooked, TMethod& original) {
+    if (original) {
+        // Already hooked.
+        return;
+    }
+
+    void** vtable = *((void***)instance);
+    const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    void* const page = (void*)((uintptr_t)&vtable[methodOffset] & ~(pageSize - 1));
+
+    // vtables live in read-only relocated data. The page is left writable so that other slots may be patched later.
+    mprotect(page, pageSize, PROT_READ | PROT_WRITE);
+
+    original = (TMethod)vtable[methodOffset];
+    vtable[methodOffset] = (void*)hooked;
+}
+
+#endif
@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "DeviceRegistry.h"
+
+namespace driver_shim {
+
+    void DeviceRegistry::Add(std::shared_ptr<ShimDevice> device, vr::ITrackedDeviceServerDriver* driver) {
+        std::unique_lock lock(m_mutex);
+        m_devices.push_back({std::move(device), driver});
+    }
+
+    bool DeviceRegistry::IsShimDriver(const vr::ITrackedDeviceServerDriver* driver) const {
+        std::unique_lock lock(m_mutex);
+        return std::any_of(
+            m_devices.cbegin(), m_devices.cend(), [&](const Owned& owned) { return owned.driver == driver; });
+    }
+
+    void DeviceRegistry::SetActive(ShimDevice* device, vr::TrackedDeviceIndex_t deviceIndex) {
+        std::unique_lock lock(m_mutex);
+        const auto it = std::find_if(
+            m_devices.cbegin(), m_devices.cend(), [&](const Owned& owned) { return owned.device.get() == device; });
+        if (it == m_devices.cend()) {
+            return;
+        }
+
+        Snapshot active;
+        for (const Entry& entry : *m_active) {
+            if (entry.device.get() != device) {
+                active.push_back(entry);
+            }
+        }
+        active.push_back({deviceIndex, it->device});
+        Publish(std::move(active));
+    }
+
+    void DeviceRegistry::SetInactive(ShimDevice* device) {
+        std::unique_lock lock(m_mutex);
+        Snapshot active;
+        for (const Entry& entry : *m_active) {
+            if (entry.device.get() != device) {
+                active.push_back(entry);
+            }
+        }
+        Publish(std::move(active));
+    }
+
+    std::shared_ptr<ShimDevice> DeviceRegistry::Find(vr::TrackedDeviceIndex_t deviceIndex) const {
+        const std::shared_ptr<const Snapshot> active = GetActiveDevices();
+        for (const Entry& entry : *active) {
+            if (entry.deviceIndex == deviceIndex) {
+                return entry.device;
+            }
+        }
+        return nullptr;
+    }
+
+    void DeviceRegistry::Clear() {
+        // The devices are destroyed outside of the lock, and only once no snapshot refers to them.
+        decltype(m_devices) devices;
+        {
+            std::unique_lock lock(m_mutex);
+            std::swap(devices, m_devices);
+            Publish({});
+        }
+    }
+
+    void DeviceRegistry::Publish(Snapshot active) {
+        std::atomic_store(&m_active, std::make_shared<const Snapshot>(std::move(active)));
+    }
+
+    DeviceRegistry& GetDeviceRegistry() {
+        static DeviceRegistry* const registry = new DeviceRegistry();
+        return *registry;
+    }
+
+} // namespace driver_shim
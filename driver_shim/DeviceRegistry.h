@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <openvr_driver.h>
+
+#include "MemoryAccounting.h"
+
+namespace driver_shim {
+
+    // A device created by the shim, wrapping a device of the target driver.
+    struct ShimDevice {
+        virtual ~ShimDevice() = default;
+
+        virtual void ApplySettingsChanges() = 0;
+    };
+
+    // The devices created by the shim. The registry owns them until Clear(), since vrserver never destroys the device
+    // drivers it is given.
+    //
+    // The active devices are published as an immutable snapshot, so that iterating them does not take any lock while
+    // devices are activated or deactivated on other threads.
+    class DeviceRegistry {
+      public:
+        struct Entry {
+            vr::TrackedDeviceIndex_t deviceIndex;
+            std::shared_ptr<ShimDevice> device;
+        };
+        using Snapshot = TaggedVector<Entry, MemoryTag::DriverObjects>;
+
+        // The driver is the device as handed to vrserver.
+        void Add(std::shared_ptr<ShimDevice> device, vr::ITrackedDeviceServerDriver* driver);
+
+        // Whether a device driver was created by the shim, active or not.
+        bool IsShimDriver(const vr::ITrackedDeviceServerDriver* driver) const;
+
+        // Called upon Activate() and Deactivate() of the device.
+        void SetActive(ShimDevice* device, vr::TrackedDeviceIndex_t deviceIndex);
+        void SetInactive(ShimDevice* device);
+
+        // The active devices.
+        std::shared_ptr<const Snapshot> GetActiveDevices() const {
+            return std::atomic_load(&m_active);
+        }
+
+        // The active device at an index, or nullptr.
+        std::shared_ptr<ShimDevice> Find(vr::TrackedDeviceIndex_t deviceIndex) const;
+
+        // Release all the devices, once vrserver no longer calls them (ie: upon Cleanup() of the provider).
+        void Clear();
+
+      private:
+        // Requires m_mutex.
+        void Publish(Snapshot active);
+
+        struct Owned {
+            std::shared_ptr<ShimDevice> device;
+            const vr::ITrackedDeviceServerDriver* driver;
+        };
+
+        mutable std::mutex m_mutex;
+        TaggedVector<Owned, MemoryTag::DriverObjects> m_devices;
+
+        // Read with std::atomic_load() and replaced with std::atomic_store().
+        std::shared_ptr<const Snapshot> m_active = std::make_shared<const Snapshot>();
+    };
+
+    // Never destroyed, so that it outlives the provider (destroyed at exit).
+    DeviceRegistry& GetDeviceRegistry();
+
+} // namespace driver_shim
@@ -0,0 +1,159 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "DistortionPipeline.h"
+
+namespace {
+    using namespace driver_shim;
+
+    const struct {
+        PipelineStage stage;
+        const char* name;
+    } stageNames[] = {
+        {PipelineStage::IpdShift, "ipd_shift"},
+        {PipelineStage::Residual, "residual"},
+        {PipelineStage::BrownConrady, "brown_conrady"},
+        {PipelineStage::Vendor, "vendor"},
+    };
+
+    // Far more nodes per side than any measurement, but small enough that a corrupt size cannot exhaust the memory.
+    constexpr uint32_t MaxGridSize = 1024;
+
+    // The number of columns or rows of a residual grid: an integer in [2, MaxGridSize].
+    bool IsValidGridSize(float value) {
+        return std::isfinite(value) && value == std::floor(value) && value >= 2 && value <= MaxGridSize;
+    }
+
+    // Catmull-Rom weights of the 4 nodes around t in [0, 1].
+    void CatmullRomWeights(float t, float* weights) {
+        const float t2 = t * t;
+        const float t3 = t2 * t;
+        weights[0] = 0.5f * (-t3 + 2 * t2 - t);
+        weights[1] = 0.5f * (3 * t3 - 5 * t2 + 2);
+        weights[2] = 0.5f * (-3 * t3 + 4 * t2 + t);
+        weights[3] = 0.5f * (t3 - t2);
+    }
+
+} // namespace
+
+namespace driver_shim {
+
+    const char* GetPipelineStageName(PipelineStage stage) {
+        for (const auto& entry : stageNames) {
+            if (entry.stage == stage) {
+                return entry.name;
+            }
+        }
+        return "unknown";
+    }
+
+    bool ParsePipeline(const std::string& description, PipelineStages& stages) {
+        stages.clear();
+        size_t start = 0;
+        while (start <= description.size()) {
+            size_t end = description.find(',', start);
+            if (end == std::string::npos) {
+                end = description.size();
+            }
+            std::string_view name(description.data() + start, end - start);
+            while (!name.empty() && name.front() == ' ') {
+                name.remove_prefix(1);
+            }
+            while (!name.empty() && name.back() == ' ') {
+                name.remove_suffix(1);
+            }
+
+            const auto it = std::find_if(std::begin(stageNames), std::end(stageNames), [&](const auto& entry) {
+                return name == entry.name;
+            });
+            if (it == std::end(stageNames) || std::find(stages.cbegin(), stages.cend(), it->stage) != stages.cend()) {
+                return false;
+            }
+            stages.push_back(it->stage);
+            start = end + 1;
+        }
+
+        // The vendor distortion maps to UVs, so it can only be last.
+        const auto vendor = std::find(stages.cbegin(), stages.cend(), PipelineStage::Vendor);
+        return !stages.empty() && (vendor == stages.cend() || vendor == stages.cend() - 1) &&
+               (stages.back() == PipelineStage::Vendor || stages.back() == PipelineStage::BrownConrady);
+    }
+
+    std::unique_ptr<ResidualGrid> ResidualGrid::Load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            return nullptr;
+        }
+
+        std::unique_ptr<ResidualGrid> grid(new ResidualGrid());
+        std::vector<float> values;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            const char* cursor = line.c_str();
+            char* end;
+            for (float value = strtof(cursor, &end); end != cursor; value = strtof(cursor, &end)) {
+                values.push_back(value);
+                cursor = end;
+            }
+        }
+
+        if (values.size() < 2 || !IsValidGridSize(values[0]) || !IsValidGridSize(values[1])) {
+            return nullptr;
+        }
+        grid->m_columns = (uint32_t)values[0];
+        grid->m_rows = (uint32_t)values[1];
+        if (values.size() - 2 != (size_t)2 * grid->m_columns * grid->m_rows * 2) {
+            return nullptr;
+        }
+        grid->m_offsets.assign(values.cbegin() + 2, values.cend());
+        return grid;
+    }
+
+    void ResidualGrid::Sample(vr::EVREye eye, float u, float v, float& offsetX, float& offsetY) const {
+        const float x = std::clamp(u, 0.f, 1.f) * (m_columns - 1);
+        const float y = std::clamp(v, 0.f, 1.f) * (m_rows - 1);
+        const int column = std::min((int)x, (int)m_columns - 2);
+        const int row = std::min((int)y, (int)m_rows - 2);
+        float weightsX[4], weightsY[4];
+        CatmullRomWeights(x - column, weightsX);
+        CatmullRomWeights(y - row, weightsY);
+
+        // Clamp the nodes past the edges of the grid.
+        const float* const offsets = &m_offsets[(size_t)eye * m_columns * m_rows * 2];
+        offsetX = offsetY = 0.f;
+        for (int j = 0; j < 4; j++) {
+            const int nodeRow = std::clamp(row + j - 1, 0, (int)m_rows - 1);
+            for (int i = 0; i < 4; i++) {
+                const int nodeColumn = std::clamp(column + i - 1, 0, (int)m_columns - 1);
+                const float weight = weightsX[i] * weightsY[j];
+                const float* const node = &offsets[((size_t)nodeRow * m_columns + nodeColumn) * 2];
+                offsetX += weight * node[0];
+                offsetY += weight * node[1];
+            }
+        }
+    }
+
+} // namespace driver_shim
@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <openvr_driver.h>
+
+#include "MemoryAccounting.h"
+
+namespace driver_shim {
+
+    // The stages of the distortion, in the order they are declared by the pipeline setting, eg:
+    // "ipd_shift,residual,brown_conrady,vendor". Each stage moves the display coordinates, except the last one, which
+    // maps them to UVs: either the vendor distortion, or the Brown-Conrady model with its affine transform. Before the
+    // vendor distortion, Brown-Conrady is only its radial part, as a correction.
+    enum class PipelineStage : uint8_t {
+        IpdShift,     // Horizontal shift of each eye, proportional to the IPD away from the nominal IPD.
+        Residual,     // Offsets interpolated from a grid (see ResidualGrid).
+        BrownConrady, // The lens model from the settings.
+        Vendor,       // The distortion of the wrapped display component.
+    };
+
+    const char* GetPipelineStageName(PipelineStage stage);
+
+    using PipelineStages = TaggedVector<PipelineStage, MemoryTag::Profiles>;
+
+    // Parse a comma-separated list of stages. Each stage appears at most once, and the last stage must map to UVs.
+    bool ParsePipeline(const std::string& description, PipelineStages& stages);
+
+    // Offsets to the display coordinates (in pixels), interpolated with a Catmull-Rom spline between the nodes of a
+    // grid spanning the viewport of each eye. The offsets apply to all channels.
+    //
+    // The text file starts with the number of columns and rows (integers between 2 and 1024), followed by the offsets
+    // (x, y) of each node, row by row, for the left eye, then for the right eye. Lines starting with '#' are ignored.
+    class ResidualGrid : public TaggedObject<MemoryTag::Profiles> {
+      public:
+        // Returns nullptr if the file is missing or invalid.
+        static std::unique_ptr<ResidualGrid> Load(const std::string& path);
+
+        void Sample(vr::EVREye eye, float u, float v, float& offsetX, float& offsetY) const;
+
+        bool operator==(const ResidualGrid& other) const {
+            return m_columns == other.m_columns && m_rows == other.m_rows && m_offsets == other.m_offsets;
+        }
+
+      private:
+        ResidualGrid() = default;
+
+        uint32_t m_columns = 0;
+        uint32_t m_rows = 0;
+        TaggedVector<float, MemoryTag::Profiles> m_offsets;
+    };
+
+} // namespace driver_shim
@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "DistortionTable.h"
+
+namespace driver_shim {
+
+    std::unique_ptr<DistortionTable>
+    DistortionTable::Bake(uint32_t resolution, const Function& function, uint32_t threadCount) {
+        std::unique_ptr<DistortionTable> table(new DistortionTable());
+        table->Fill(resolution, function, threadCount);
+        return table;
+    }
+
+    std::unique_ptr<DistortionTable> DistortionTable::Quantize(const DistortionTable& table,
+                                                               const uint32_t (&width)[2],
+                                                               const uint32_t (&height)[2],
+                                                               double maxError,
+                                                               double* error) {
+        if (error) {
+            *error = INFINITY;
+        }
+        if (table.m_format != Format::Float32) {
+            return nullptr;
+        }
+
+        const uint32_t size = table.m_resolution;
+        const size_t channelStride = (size_t)size * size * 2;
+        std::unique_ptr<DistortionTable> quantized(new DistortionTable());
+        quantized->m_resolution = size;
+        quantized->m_format = Format::Unorm16;
+        quantized->m_quantized.resize(table.m_samples.size());
+
+        double worstError = 0.0;
+        for (uint32_t eye = 0; eye < 2; eye++) {
+            for (uint32_t channel = 0; channel < 3; channel++) {
+                const size_t base = (eye * 3 + channel) * channelStride;
+                const auto Offset = [&](uint32_t row, uint32_t column, int i) {
+                    return table.m_samples[base + ((size_t)row * size + column) * 2 + i] -
+                           (float)(i ? row : column) / (size - 1);
+                };
+
+                // The range of the offsets from the identity mapping, for each coordinate.
+                float low[2] = {INFINITY, INFINITY};
+                float high[2] = {-INFINITY, -INFINITY};
+                for (uint32_t row = 0; row < size; row++) {
+                    for (uint32_t column = 0; column < size; column++) {
+                        for (int i = 0; i < 2; i++) {
+                            low[i] = std::min(low[i], Offset(row, column, i));
+                            high[i] = std::max(high[i], Offset(row, column, i));
+                        }
+                    }
+                }
+                if (!std::isfinite(low[0]) || !std::isfinite(low[1]) || !std::isfinite(high[0]) ||
+                    !std::isfinite(high[1])) {
+                    return nullptr;
+                }
+
+                const float scale[2] = {(high[0] - low[0]) / 65535, (high[1] - low[1]) / 65535};
+                quantized->m_scaleBias[eye * 3 + channel] = {scale[0], scale[1], low[0], low[1]};
+                for (uint32_t row = 0; row < size; row++) {
+                    for (uint32_t column = 0; column < size; column++) {
+                        for (int i = 0; i < 2; i++) {
+                            const float step = scale[i] > 0 ? (Offset(row, column, i) - low[i]) / scale[i] : 0.f;
+                            quantized->m_quantized[base + ((size_t)row * size + column) * 2 + i] =
+                                (uint16_t)std::clamp(std::lround(step), 0l, 65535l);
+                        }
+                    }
+                }
+
+                // Half a step from the rounding, and a few ULPs of 1 from the arithmetic of the lookup. The bilinear
+                // interpolation of the samples does not increase the error.
+                const double errorX = (scale[0] / 2.0 + 4 * std::numeric_limits<float>::epsilon()) * width[eye];
+                const double errorY = (scale[1] / 2.0 + 4 * std::numeric_limits<float>::epsilon()) * height[eye];
+                worstError = std::max(worstError, std::sqrt(errorX * errorX + errorY * errorY));
+            }
+        }
+
+        if (error) {
+            *error = worstError;
+        }
+        return worstError <= maxError ? std::move(quantized) : nullptr;
+    }
+
+    void DistortionTable::Fill(uint32_t resolution, const Function& function, uint32_t threadCount) {
+        m_resolution = std::max(resolution, 2u);
+        const uint32_t size = m_resolution;
+        m_samples.resize((size_t)2 * 3 * size * size * 2);
+
+        // Each thread fills interleaved rows of both eyes.
+        const size_t channelStride = (size_t)size * size * 2;
+        const auto FillRows = [&](uint32_t first, uint32_t step) {
+            for (uint32_t i = first; i < 2 * size; i += step) {
+                const vr::EVREye eye = i < size ? vr::Eye_Left : vr::Eye_Right;
+                const uint32_t row = i % size;
+                float* const red = &m_samples[eye * 3 * channelStride];
+                float* const green = red + channelStride;
+                float* const blue = green + channelStride;
+                const float v = (float)row / (size - 1);
+                for (uint32_t column = 0; column < size; column++) {
+                    const float u = (float)column / (size - 1);
+                    const vr::DistortionCoordinates_t result = function(eye, u, v);
+                    const size_t offset = ((size_t)row * size + column) * 2;
+                    memcpy(&red[offset], result.rfRed, sizeof(result.rfRed));
+                    memcpy(&green[offset], result.rfGreen, sizeof(result.rfGreen));
+                    memcpy(&blue[offset], result.rfBlue, sizeof(result.rfBlue));
+                }
+            }
+        };
+
+        threadCount = std::clamp(threadCount, 1u, 2 * size);
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; i++) {
+            threads.emplace_back(FillRows, i, threadCount);
+        }
+        FillRows(0, threadCount);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+} // namespace driver_shim
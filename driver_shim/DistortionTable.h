@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <openvr_driver.h>
+
+#include "MemoryAccounting.h"
+
+namespace driver_shim {
+
+    // A distortion function sampled on a regular grid, for each eye and each channel, so that evaluating it costs one
+    // bilinear interpolation per channel, whatever the cost of the function.
+    //
+    // The samples are stored for each eye, each channel, row by row: the UV (2 floats) at
+    // (column, row) / (resolution - 1). A quantized table stores instead the offset of the UV from
+    // (column, row) / (resolution - 1) as 2 unorm16, with a scale and a bias for each eye, channel and coordinate,
+    // which halves the memory read by each lookup.
+    class DistortionTable : public TaggedObject<MemoryTag::Tables> {
+      public:
+        using Function = std::function<vr::DistortionCoordinates_t(vr::EVREye eye, float u, float v)>;
+
+        enum class Format : uint8_t {
+            Float32,
+            Unorm16,
+        };
+
+        // Evaluate the function at each node of the grid, ie: resolution^2 calls for each eye. With several threads,
+        // the function must be safe to call concurrently.
+        static std::unique_ptr<DistortionTable>
+        Bake(uint32_t resolution, const Function& function, uint32_t threadCount = 1);
+
+        // A quantized copy of a Float32 table, unless its error would exceed maxError display pixels for eyes of
+        // width x height display pixels. The error bound is returned either way.
+        static std::unique_ptr<DistortionTable> Quantize(const DistortionTable& table,
+                                                         const uint32_t (&width)[2],
+                                                         const uint32_t (&height)[2],
+                                                         double maxError,
+                                                         double* error = nullptr);
+
+        // Bilinear interpolation of one channel at (u, v), clamped to the viewport.
+        void Sample(vr::EVREye eye, uint32_t channel, float u, float v, float* result) const {
+            const uint32_t last = m_resolution - 1;
+            u = std::clamp(u, 0.f, 1.f);
+            v = std::clamp(v, 0.f, 1.f);
+            const float x = u * last;
+            const float y = v * last;
+            const uint32_t column = std::min((uint32_t)x, last - 1);
+            const uint32_t row = std::min((uint32_t)y, last - 1);
+            const float tx = x - column;
+            const float ty = y - row;
+
+            const uint32_t stride = m_resolution * 2;
+            if (m_format == Format::Unorm16) {
+                using namespace DirectX;
+                using namespace DirectX::PackedVector;
+
+                // Both neighbors on a row are one vector (x0, y0, x1, y1).
+                const uint16_t* const top =
+                    &m_quantized[(eye * 3 + channel) * m_resolution * stride + row * stride + column * 2];
+                const XMVECTOR upper = XMLoadUShort4(reinterpret_cast<const XMUSHORT4*>(top));
+                const XMVECTOR lower = XMLoadUShort4(reinterpret_cast<const XMUSHORT4*>(top + stride));
+                const XMVECTOR rows = XMVectorLerp(upper, lower, ty);
+                const XMVECTOR offset = XMVectorLerp(rows, XMVectorSwizzle<2, 3, 0, 1>(rows), tx);
+
+                // The identity mapping interpolates to (u, v) itself.
+                const XMVECTOR scaleBias = XMLoadFloat4(&m_scaleBias[eye * 3 + channel]);
+                const XMVECTOR scale = XMVectorSwizzle<0, 1, 0, 1>(scaleBias);
+                const XMVECTOR bias = XMVectorAdd(XMVectorSwizzle<2, 3, 2, 3>(scaleBias), XMVectorSet(u, v, 0, 0));
+                const XMVECTOR uv = XMVectorMultiplyAdd(offset, scale, bias);
+                XMStoreFloat2(reinterpret_cast<XMFLOAT2*>(result), uv);
+                return;
+            }
+
+            const float* const top =
+                &m_samples[(eye * 3 + channel) * m_resolution * stride + row * stride + column * 2];
+            const float* const bottom = top + stride;
+            for (int i = 0; i < 2; i++) {
+                const float upper = top[i] + (top[i + 2] - top[i]) * tx;
+                const float lower = bottom[i] + (bottom[i + 2] - bottom[i]) * tx;
+                result[i] = upper + (lower - upper) * ty;
+            }
+        }
+
+        uint32_t Resolution() const {
+            return m_resolution;
+        }
+
+        Format GetFormat() const {
+            return m_format;
+        }
+
+        size_t Bytes() const {
+            return m_samples.size() * sizeof(float) + m_quantized.size() * sizeof(uint16_t);
+        }
+
+      protected:
+        DistortionTable() = default;
+
+        void Fill(uint32_t resolution, const Function& function, uint32_t threadCount);
+
+        uint32_t m_resolution = 0;
+        Format m_format = Format::Float32;
+        TaggedVector<float, MemoryTag::Tables> m_samples;
+
+        // Unorm16 only: the samples, and the (scale x, scale y, bias x, bias y) of each eye and channel.
+        TaggedVector<uint16_t, MemoryTag::Tables> m_quantized;
+        DirectX::XMFLOAT4 m_scaleBias[2 * 3]{};
+    };
+
+} // namespace driver_shim
@@ -23,6 +23,7 @@
 #include "pch.h"
 
 #include "ShimDriverManager.h"
+#include "StartupTimings.h"
 #include "Tracing.h"
 
 namespace {
@@ -42,6 +43,7 @@ namespace {
         vr::EVRInitError Init(vr::IVRDriverContext* pDriverContext) override {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "Driver_Init");
+            ScopedStartupPhase phase(StartupPhase::DriverInit);
 
             VR_INIT_SERVER_DRIVER_CONTEXT(pDriverContext);
 
@@ -58,6 +60,7 @@ namespace {
         }
 
         void Cleanup() override {
+            DestroyShimDrivers();
             VR_CLEANUP_SERVER_DRIVER_CONTEXT();
         }
 
@@ -75,6 +78,11 @@ namespace {
                 case vr::VREvent_AnyDriverSettingsChanged:
                     ApplySettingsChanges();
                     break;
+
+                case vr::VREvent_IpdChanged:
+                    // The IPD is an input of the pipeline (see ipd_shift).
+                    ApplySettingsChanges(event.trackedDeviceIndex);
+                    break;
                 }
             }
 
@@ -94,9 +102,10 @@ namespace {
 } // namespace
 
 // Entry point for vrserver.
-extern "C" __declspec(dllexport) void* HmdDriverFactory(const char* pInterfaceName, int* pReturnCode) {
+HMD_DLL_EXPORT void* HmdDriverFactory(const char* pInterfaceName, int* pReturnCode) {
     if (strcmp(vr::IServerTrackedDeviceProvider_Version, pInterfaceName) == 0) {
         if (!thisDriver) {
+            ScopedStartupPhase phase(StartupPhase::HmdDriverFactory);
             thisDriver = std::make_unique<Driver>();
         }
         return thisDriver.get();
@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <openvr_driver.h>
+
+namespace driver_shim {
+
+    // Forwards every method of ITrackedDeviceServerDriver to the shimmed device, so that a shim only overrides the
+    // methods it changes. Each pass-through loads the vtable of the shimmed device and jumps to its method (a tail
+    // call), but for the methods returning a structure (eg: GetPose()), which keep a call and return.
+    //
+    // Derived may replace the components of the shimmed device with its own by defining:
+    //     void* WrapComponent(const char* pchComponentNameAndVersion, void* component);
+    template <typename Derived>
+    class ForwardingDeviceDriver : public vr::ITrackedDeviceServerDriver {
+      public:
+        explicit ForwardingDeviceDriver(vr::ITrackedDeviceServerDriver* shimmedDevice)
+            : m_shimmedDevice(shimmedDevice) {
+        }
+
+        vr::EVRInitError Activate(uint32_t unObjectId) override {
+            return m_shimmedDevice->Activate(unObjectId);
+        }
+
+        void Deactivate() override {
+            m_shimmedDevice->Deactivate();
+        }
+
+        void EnterStandby() override {
+            m_shimmedDevice->EnterStandby();
+        }
+
+        void* GetComponent(const char* pchComponentNameAndVersion) override {
+            return static_cast<Derived*>(this)->WrapComponent(
+                pchComponentNameAndVersion, m_shimmedDevice->GetComponent(pchComponentNameAndVersion));
+        }
+
+        void DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize) override {
+            m_shimmedDevice->DebugRequest(pchRequest, pchResponseBuffer, unResponseBufferSize);
+        }
+
+        vr::DriverPose_t GetPose() override {
+            return m_shimmedDevice->GetPose();
+        }
+
+      protected:
+        // The components of the shimmed device are exposed as-is, unless Derived hides this.
+        void* WrapComponent(const char* pchComponentNameAndVersion, void* component) {
+            return component;
+        }
+
+        vr::ITrackedDeviceServerDriver* const m_shimmedDevice;
+    };
+
+    // Forwards every method of IVRDisplayComponent to the display component of the shimmed device, once acquired (see
+    // ForwardingDeviceDriver::WrapComponent()).
+    class ForwardingDisplayComponent : public vr::IVRDisplayComponent {
+      public:
+        void GetWindowBounds(int32_t* pnX, int32_t* pnY, uint32_t* pnWidth, uint32_t* pnHeight) override {
+            // Not used by drivers in direct mode.
+            m_shimmedDisplayComponent->GetWindowBounds(pnX, pnY, pnWidth, pnHeight);
+        }
+
+        bool IsDisplayOnDesktop() override {
+            // Should always be false for drivers in direct mode.
+            return m_shimmedDisplayComponent->IsDisplayOnDesktop();
+        }
+
+        bool IsDisplayRealDisplay() override {
+            // Should always be true for drivers in direct mode.
+            return m_shimmedDisplayComponent->IsDisplayRealDisplay();
+        }
+
+        void GetRecommendedRenderTargetSize(uint32_t* pnWidth, uint32_t* pnHeight) override {
+            m_shimmedDisplayComponent->GetRecommendedRenderTargetSize(pnWidth, pnHeight);
+        }
+
+        void GetEyeOutputViewport(
+            vr::EVREye eEye, uint32_t* pnX, uint32_t* pnY, uint32_t* pnWidth, uint32_t* pnHeight) override {
+            m_shimmedDisplayComponent->GetEyeOutputViewport(eEye, pnX, pnY, pnWidth, pnHeight);
+        }
+
+        void GetProjectionRaw(vr::EVREye eEye, float* pfLeft, float* pfRight, float* pfTop, float* pfBottom) override {
+            m_shimmedDisplayComponent->GetProjectionRaw(eEye, pfLeft, pfRight, pfTop, pfBottom);
+        }
+
+        vr::DistortionCoordinates_t ComputeDistortion(vr::EVREye eEye, float fU, float fV) override {
+            return m_shimmedDisplayComponent->ComputeDistortion(eEye, fU, fV);
+        }
+
+        bool ComputeInverseDistortion(
+            vr::HmdVector2_t* pResult, vr::EVREye eEye, uint32_t unChannel, float fU, float fV) override {
+            // Typically not supported, but we forward the call anyway.
+            return m_shimmedDisplayComponent->ComputeInverseDistortion(pResult, eEye, unChannel, fU, fV);
+        }
+
+      protected:
+        vr::IVRDisplayComponent* m_shimmedDisplayComponent = nullptr;
+    };
+
+} // namespace driver_shim
@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "HiddenAreaMesh.h"
+
+namespace {
+
+    const char* const eyeNames[] = {"left", "right"};
+    const char* const typeNames[] = {"standard", "inverse", "line_loop"};
+
+    // Far more than any real mask, but small enough that a corrupt count cannot exhaust the memory.
+    constexpr uint32_t MaxVertexCount = 1 << 16;
+
+    template <size_t Count>
+    int FindName(const char* const (&names)[Count], const std::string& name) {
+        for (size_t i = 0; i < Count; i++) {
+            if (name == names[i]) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+
+    // The next line that is not empty or a comment.
+    bool ReadLine(std::istream& stream, std::string& line) {
+        while (std::getline(stream, line)) {
+            if (!line.empty() && line[0] != '#' && line[0] != '\r') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace
+
+namespace driver_shim {
+
+    bool HiddenAreaMeshes::Load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+
+        HiddenAreaMeshes loaded;
+        std::string line;
+        while (ReadLine(file, line)) {
+            char eye[16]{}, type[16]{};
+            uint32_t count = 0;
+            if (sscanf(line.c_str(), "%15s %15s %u", eye, type, &count) != 3) {
+                return false;
+            }
+            const int eyeIndex = FindName(eyeNames, eye);
+            const int typeIndex = FindName(typeNames, type);
+            if (eyeIndex < 0 || typeIndex < 0) {
+                return false;
+            }
+
+            if (count > MaxVertexCount) {
+                DriverLog(
+                    "Too many vertices in the hidden area mesh %s %s: %u (max %u)", eye, type, count, MaxVertexCount);
+                return false;
+            }
+            if (typeIndex != vr::k_eHiddenAreaMesh_LineLoop && count % 3 != 0) {
+                DriverLog("Partial triangle in the hidden area mesh %s %s: %u vertices", eye, type, count);
+                return false;
+            }
+
+            HiddenAreaMesh& mesh = loaded.meshes[eyeIndex][typeIndex];
+            mesh.resize(count);
+            for (vr::HmdVector2_t& vertex : mesh) {
+                if (!ReadLine(file, line) || sscanf(line.c_str(), "%f %f", &vertex.v[0], &vertex.v[1]) != 2) {
+                    return false;
+                }
+            }
+        }
+
+        *this = std::move(loaded);
+        return true;
+    }
+
+    bool HiddenAreaMeshes::Save(const std::string& path) const {
+        std::ofstream file(path);
+        file << "# Hidden area meshes: <eye> <type> <vertex count>, then one vertex \"u v\" per line.\n";
+        char buffer[64];
+        for (int eye = 0; eye < 2; eye++) {
+            for (int type = 0; type < vr::k_eHiddenAreaMesh_Max; type++) {
+                const HiddenAreaMesh& mesh = meshes[eye][type];
+                file << eyeNames[eye] << " " << typeNames[type] << " " << mesh.size() << "\n";
+                for (const vr::HmdVector2_t& vertex : mesh) {
+                    snprintf(buffer, sizeof(buffer), "%.7g %.7g\n", vertex.v[0], vertex.v[1]);
+                    file << buffer;
+                }
+            }
+        }
+        return !!file;
+    }
+
+} // namespace driver_shim
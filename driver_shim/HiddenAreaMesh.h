@@ -0,0 +1,47 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <openvr_driver.h>
+
+#include "MemoryAccounting.h"
+
+namespace driver_shim {
+
+    // The hidden area meshes of both eyes, as passed to CVRHiddenAreaHelpers::SetHiddenArea(): triangle lists in UV
+    // for k_eHiddenAreaMesh_Standard and k_eHiddenAreaMesh_Inverse, and a closed polygon for
+    // k_eHiddenAreaMesh_LineLoop.
+    //
+    // The text file has one section per mesh: a line with the eye (left or right), the type (standard, inverse or
+    // line_loop) and the vertex count, followed by one vertex "u v" per line. Lines starting with '#' are ignored. The
+    // triangle lists must have a multiple of 3 vertices.
+    using HiddenAreaMesh = TaggedVector<vr::HmdVector2_t, MemoryTag::Tables>;
+
+    struct HiddenAreaMeshes {
+        HiddenAreaMesh meshes[2][vr::k_eHiddenAreaMesh_Max];
+
+        // Returns false if the file is missing or invalid.
+        bool Load(const std::string& path);
+        bool Save(const std::string& path) const;
+    };
+
+} // namespace driver_shim
@@ -24,7 +24,16 @@
 
 #include "ShimDriverManager.h"
 #include "DetourUtils.h"
+#include "DeviceRegistry.h"
+#include "DistortionPipeline.h"
+#include "ForwardingDriver.h"
+#include "HiddenAreaMesh.h"
+#include "LensAnalysis.h"
+#include "MemoryAccounting.h"
+#include "StartupTimings.h"
+#include "TraceRecorder.h"
 #include "Tracing.h"
+#include "VendorDistortionTable.h"
 
 namespace {
     using namespace driver_shim;
@@ -37,11 +46,77 @@ namespace {
         float k3;
     };
 
+    // An immutable version of the lens model. Settings changes publish a new snapshot, so that a concurrent
+    // ComputeDistortion() never observes a model half-way through an update.
+    struct DistortionModelSnapshot : TaggedObject<MemoryTag::Profiles> {
+        uint64_t version;
+
+        // Affine transform.
+        DirectX::XMMATRIX affine[2];
+        DirectX::XMMATRIX invAffine[2];
+
+        // Distortion parameters for 2 eyes, 3 channels.
+        DistortionModel channels[2][3];
+
+        // Square of the radius where each channel folds over (see FindFoldOverRadius()). The radius is clamped to it,
+        // so that the mapping stays monotonic beyond.
+        float maxRadius2[2][3];
+
+        // The stages of the distortion (see PipelineStage), and their parameters.
+        PipelineStages stages;
+        float ipdShift[2];
+        std::shared_ptr<const ResidualGrid> residual;
+        std::shared_ptr<const VendorDistortionTable> vendorTable;
+        uint32_t bakedResolution;
+
+        // The tables sampled by ComputeDistortion() are quantized when their error stays within this many display
+        // pixels (0 keeps them in floats).
+        float quantizedTableMaxError;
+
+        // Unless the pipeline is the Brown-Conrady model alone, the whole pipeline is baked into a table when any stage
+        // changes, so that its cost does not depend on the number of stages.
+        std::shared_ptr<const DistortionTable> bakedTable;
+    };
+
+    // Brown-Conrady function itself.
+    DirectX::XMFLOAT2 BrownConrady(float x,
+                                   float y,
+                                   DirectX::XMMATRIX invAffine,
+                                   float codX,
+                                   float codY,
+                                   float k1,
+                                   float k2,
+                                   float k3,
+                                   float maxRadius2) {
+        using namespace DirectX;
+
+        // Apply radial and tangential distortion.
+        const XMFLOAT2 delta(x - codX, y - codY);
+        const float r2 = std::min(delta.x * delta.x + delta.y * delta.y, maxRadius2);
+        const float d = 1.0f + r2 * (k1 + r2 * (k2 + r2 * k3));
+        const XMVECTOR p = XMVectorSet((delta.x * d) + codX, (delta.y * d) + codY, 1.f, 1.f);
+
+        // Correct projection.
+        XMVECTOR vp = XMVector3Transform(p, invAffine);
+        vp /= XMVectorGetW(vp);
+
+        return XMFLOAT2(XMVectorGetX(vp), XMVectorGetY(vp));
+    }
+
+    // Unique across all devices.
+    std::atomic<uint64_t> lastModelVersion{0};
+
     // The HmdShimDriver driver wraps another ITrackedDeviceServerDriver instance with the intent to override
-    // properties and behaviors.
-    struct HmdShimDriver : public vr::ITrackedDeviceServerDriver, vr::IVRDisplayComponent {
-        HmdShimDriver(vr::ITrackedDeviceServerDriver* shimmedDevice, vr::IVRServerDriverHost* driverHost)
-            : m_shimmedDevice(shimmedDevice), m_driverHost(driverHost) {
+    // properties and behaviors. The methods that are not overridden here are forwarded as-is.
+    struct HmdShimDriver : public ForwardingDeviceDriver<HmdShimDriver>,
+                           ForwardingDisplayComponent,
+                           ShimDevice,
+                           TaggedObject<MemoryTag::DriverObjects> {
+        HmdShimDriver(vr::ITrackedDeviceServerDriver* shimmedDevice,
+                      vr::IVRServerDriverHost* driverHost,
+                      const char* serialNumber)
+            : ForwardingDeviceDriver(shimmedDevice), m_driverHost(driverHost),
+              m_serialNumber(serialNumber ? serialNumber : "") {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "HmdShimDriver_Ctor");
 
@@ -51,6 +126,7 @@ namespace {
         vr::EVRInitError Activate(uint32_t unObjectId) override {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "HmdShimDriver_Activate", TLArg(unObjectId, "ObjectId"));
+            ScopedStartupPhase phase(StartupPhase::Activate);
 
             m_deviceIndex = unObjectId;
 
@@ -58,11 +134,16 @@ namespace {
                 vr::VRProperties()->TrackedDeviceToPropertyContainer(m_deviceIndex);
 
             // Activate the real device driver.
+            std::optional<ScopedStartupPhase> vendorPhase(std::in_place, StartupPhase::VendorActivate);
             const auto status = m_shimmedDevice->Activate(unObjectId);
+            vendorPhase.reset();
 
-            // Acquire the IVRDisplayComponent.
-            m_shimmedDisplayComponent =
-                (vr::IVRDisplayComponent*)m_shimmedDevice->GetComponent(vr::IVRDisplayComponent_Version);
+            // Acquire the IVRDisplayComponent. It is the same upon re-activation, and it may be in use by other
+            // threads.
+            if (!m_shimmedDisplayComponent) {
+                m_shimmedDisplayComponent =
+                    (vr::IVRDisplayComponent*)m_shimmedDevice->GetComponent(vr::IVRDisplayComponent_Version);
+            }
             if (m_shimmedDisplayComponent) {
                 // Enable our settings menu.
                 vr::VRProperties()->SetStringProperty(container, vr::Prop_ResourceRoot_String, "distortion_shim");
@@ -74,18 +155,35 @@ namespace {
                 // distortion mesh.
                 // vr::VRProperties()->SetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32, 64);
 
+                // Record the display calls if requested, for offline replay.
+                StartTraceRecording();
+
+                // Sample the vendor distortion before reading the model, when we compose on top of it.
+                if (vr::VRSettings()->GetBool("driver_distortion_shim", "compose_vendor_distortion")) {
+                    ScopedStartupPhase tablePhase(StartupPhase::VendorTable);
+                    std::unique_lock lock(m_modelMutex);
+                    AcquireVendorTable();
+                }
+
                 // Populate our distortion parameters from the config.
-                ReadDistortionModel();
+                {
+                    ScopedStartupPhase readPhase(StartupPhase::ReadSettings);
+                    ReadDistortionModel(true);
+                }
+
+                // The hidden area mesh must match the lens geometry: either the meshes exported for the lens profile
+                // (see the shim_host hiddenarea command), or none.
+                ScopedStartupPhase hiddenAreaPhase(StartupPhase::HiddenArea);
+                ApplyHiddenArea(true);
+            }
 
-                // FIXME: You will also want to modify or disable the hidden area mesh based on the lens geometry.
-                // Here we disable it.
-                vr::CVRHiddenAreaHelpers helpers{vr::VRPropertiesRaw()};
-                helpers.SetHiddenArea(vr::Eye_Left, vr::k_eHiddenAreaMesh_Standard, nullptr, 0);
-                helpers.SetHiddenArea(vr::Eye_Left, vr::k_eHiddenAreaMesh_Inverse, nullptr, 0);
-                helpers.SetHiddenArea(vr::Eye_Right, vr::k_eHiddenAreaMesh_Standard, nullptr, 0);
-                helpers.SetHiddenArea(vr::Eye_Right, vr::k_eHiddenAreaMesh_Inverse, nullptr, 0);
+            // Receive the settings changes from now on.
+            if (status == vr::VRInitError_None) {
+                GetDeviceRegistry().SetActive(this, m_deviceIndex);
             }
 
+            LogMemoryCounters();
+
             TraceLoggingWriteStop(local, "HmdShimDriver_Activate");
 
             return status;
@@ -95,21 +193,25 @@ namespace {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "HmdShimDriver_Deactivate", TLArg(m_deviceIndex, "ObjectId"));
 
+            // No more settings changes.
+            GetDeviceRegistry().SetInactive(this);
             m_deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
 
             m_shimmedDevice->Deactivate();
 
+            // Other threads may still be using the recorder.
+            if (m_traceRecorder) {
+                m_traceRecorder->Flush();
+            }
+
             DriverLog("Deactivated device shimmed with HmdShimDriver");
+            LogMemoryCounters();
 
             TraceLoggingWriteStop(local, "HmdShimDriver_Deactivate");
         }
 
-        void EnterStandby() override {
-            m_shimmedDevice->EnterStandby();
-        }
-
-        void* GetComponent(const char* pchComponentNameAndVersion) override {
-            void* component = m_shimmedDevice->GetComponent(pchComponentNameAndVersion);
+        // Called by GetComponent() with the component of the real device driver.
+        void* WrapComponent(const char* pchComponentNameAndVersion, void* component) {
             DriverLog("GetComponent(%s) = %p", pchComponentNameAndVersion, component);
             if (component) {
                 const std::string_view componentNameAndVersion(pchComponentNameAndVersion);
@@ -127,30 +229,21 @@ namespace {
             return component;
         }
 
-        vr::DriverPose_t GetPose() override {
-            return m_shimmedDevice->GetPose();
-        }
-
         void DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize) override {
-            m_shimmedDevice->DebugRequest(pchRequest, pchResponseBuffer, unResponseBufferSize);
-        }
-
-        void GetWindowBounds(int32_t* pnX, int32_t* pnY, uint32_t* pnWidth, uint32_t* pnHeight) override {
-            // Not used by drivers in direct mode.
-            // Forward the call for other drivers.
-            m_shimmedDisplayComponent->GetWindowBounds(pnX, pnY, pnWidth, pnHeight);
-        }
-
-        bool IsDisplayOnDesktop() override {
-            // Should always be false for drivers in direct mode.
-            // Forward the call for other drivers.
-            return m_shimmedDisplayComponent->IsDisplayOnDesktop();
-        }
+            // Handle our own requests, forward the others to the real device driver.
+            const std::string_view request(pchRequest);
+            if (request == "distortion_shim:memory" || request == "distortion_shim:startup") {
+                const std::string response =
+                    request == "distortion_shim:memory" ? FormatMemoryCounters() : FormatStartupTimings();
+                if (unResponseBufferSize) {
+                    const size_t length = std::min(response.size(), (size_t)unResponseBufferSize - 1);
+                    memcpy(pchResponseBuffer, response.data(), length);
+                    pchResponseBuffer[length] = 0;
+                }
+                return;
+            }
 
-        bool IsDisplayRealDisplay() override {
-            // Should always be true for drivers in direct mode.
-            // Forward the call for other drivers.
-            return m_shimmedDisplayComponent->IsDisplayRealDisplay();
+            m_shimmedDevice->DebugRequest(pchRequest, pchResponseBuffer, unResponseBufferSize);
         }
 
         void GetRecommendedRenderTargetSize(uint32_t* pnWidth, uint32_t* pnHeight) override {
@@ -167,6 +260,10 @@ namespace {
                 m_shimmedDisplayComponent->GetRecommendedRenderTargetSize(pnWidth, pnHeight);
             }
 
+            if (m_traceRecorder) {
+                m_traceRecorder->GetRecommendedRenderTargetSize(*pnWidth, *pnHeight);
+            }
+
             TraceLoggingWriteStop(local,
                                   "HmdDriver_GetRecommendedRenderTargetSize",
                                   TLArg(*pnWidth, "RecommendedWidth"),
@@ -185,6 +282,10 @@ namespace {
             // as-is.
             m_shimmedDisplayComponent->GetEyeOutputViewport(eEye, pnX, pnY, pnWidth, pnHeight);
 
+            if (m_traceRecorder) {
+                m_traceRecorder->GetEyeOutputViewport(eEye, *pnX, *pnY, *pnWidth, *pnHeight);
+            }
+
             TraceLoggingWriteStop(local,
                                   "HmdDriver_GetEyeOutputViewport",
                                   TLArg(*pnX, "X"),
@@ -209,6 +310,10 @@ namespace {
                 m_shimmedDisplayComponent->GetProjectionRaw(eEye, pfLeft, pfRight, pfTop, pfBottom);
             }
 
+            if (m_traceRecorder) {
+                m_traceRecorder->GetProjectionRaw(eEye, *pfLeft, *pfRight, *pfTop, *pfBottom);
+            }
+
             TraceLoggingWriteStop(local,
                                   "HmdDriver_GetProjectionRaw",
                                   TLArg(*pfLeft, "Left"),
@@ -227,85 +332,33 @@ namespace {
                                    TLArg(fV, "V"));
 
             vr::DistortionCoordinates_t result{};
-            if (m_isNotDirectModeDriver) {
-                // Forward as-is for drivers not in direct mode (should not be used anyway...).
+            const DistortionModelSnapshot* const model = m_isNotDirectModeDriver ? nullptr : AcquireModel();
+            if (!model) {
+                // Forward as-is for drivers not in direct mode (should not be used anyway...), and until the model is
+                // read upon activation.
                 result = m_shimmedDisplayComponent->ComputeDistortion(eEye, fU, fV);
             } else {
                 // FIXME: This is where you change the distortion function!
                 // Here's an example using Brown-Conrady with some dummy parameters.
 
-                // Transform input coordinates to pixels.
-                uint32_t dummy, width, height;
-                m_shimmedDisplayComponent->GetEyeOutputViewport(eEye, &dummy, &dummy, &width, &height);
-                const float x = fU * width;
-                const float y = fV * height;
-
-                // Brown-Conrady function itself.
-                const auto BrownConrady = [](float x,
-                                             float y,
-                                             DirectX::XMMATRIX invAffine,
-                                             float codX,
-                                             float codY,
-                                             float k1,
-                                             float k2,
-                                             float k3) -> DirectX::XMFLOAT2 {
-                    using namespace DirectX;
-
-                    // Apply radial and tangential distortion.
-                    const XMFLOAT2 delta(x - codX, y - codY);
-                    const float r2 = delta.x * delta.x + delta.y * delta.y;
-                    const float d = 1.0f + r2 * (k1 + r2 * (k2 + r2 * k3));
-                    const XMVECTOR p = XMVectorSet((delta.x * d) + codX, (delta.y * d) + codY, 1.f, 1.f);
-
-                    // Correct projection.
-                    XMVECTOR vp = XMVector3Transform(p, invAffine);
-                    vp /= XMVectorGetW(vp);
-
-                    return XMFLOAT2(XMVectorGetX(vp), XMVectorGetY(vp));
-                };
-
-                // Transform final coordinates based on tangents.
-                float fLeft, fRight, fTop, fBottom;
-                m_shimmedDisplayComponent->GetProjectionRaw(eEye, &fLeft, &fRight, &fBottom, &fTop);
-                fLeft = std::abs(fLeft);
-                fRight = std::abs(fRight);
-                fTop = std::abs(fTop);
-                fBottom = std::abs(fBottom);
-                const float horizontalAperture = (fLeft + fRight);
-                const float verticalAperture = (fTop + fBottom);
-                const auto SetResult = [&](float* result, const DirectX::XMFLOAT2& uv) {
-                    result[0] = (uv.x + fLeft) / horizontalAperture;
-                    result[1] = (uv.y + fTop) / verticalAperture;
-                };
-
-                // Apply the distortion to each channel.
-                SetResult(result.rfRed,
-                          BrownConrady(x,
-                                       y,
-                                       m_invAffine[eEye],
-                                       m_distortionModel[eEye][0].codX,
-                                       m_distortionModel[eEye][0].codY,
-                                       m_distortionModel[eEye][0].k1,
-                                       m_distortionModel[eEye][0].k2,
-                                       m_distortionModel[eEye][0].k3));
-                SetResult(result.rfGreen,
-                          BrownConrady(x,
-                                       y,
-                                       m_invAffine[eEye],
-                                       m_distortionModel[eEye][1].codX,
-                                       m_distortionModel[eEye][1].codY,
-                                       m_distortionModel[eEye][1].k1,
-                                       m_distortionModel[eEye][1].k2,
-                                       m_distortionModel[eEye][1].k3));
-                SetResult(result.rfBlue,
-                          BrownConrady(x,
-                                       y,
-                                       m_invAffine[eEye],
-                                       m_distortionModel[eEye][2].codX,
-                                       m_distortionModel[eEye][2].codY,
-                                       m_distortionModel[eEye][2].k1,
-                                       m_distortionModel[eEye][2].k2,
-                                       m_distortionModel[eEye][2].k3));
+                if (model->bakedTable) {
+                    // The whole pipeline, baked.
+                    model->bakedTable->Sample(eEye, 0, fU, fV, result.rfRed);
+                    model->bakedTable->Sample(eEye, 1, fU, fV, result.rfGreen);
+                    model->bakedTable->Sample(eEye, 2, fU, fV, result.rfBlue);
+                } else {
+                    // Transform input coordinates to pixels.
+                    uint32_t dummy, width, height;
+                    m_shimmedDisplayComponent->GetEyeOutputViewport(eEye, &dummy, &dummy, &width, &height);
+                    const float x[] = {fU * width, fU * width, fU * width};
+                    const float y[] = {fV * height, fV * height, fV * height};
+
+                    result = ApplyBrownConrady(*model, eEye, x, y);
+                }
+            }
+
+            if (m_traceRecorder) {
+                m_traceRecorder->ComputeDistortion(eEye, fU, fV, result);
             }
 
             TraceLoggingWriteStop(local,
@@ -320,69 +373,245 @@ namespace {
             return result;
         }
 
-        bool ComputeInverseDistortion(
-            vr::HmdVector2_t* pResult, vr::EVREye eEye, uint32_t unChannel, float fU, float fV) override {
-            // Typically not supported, but we forward the call anyway.
-            return m_shimmedDisplayComponent->ComputeInverseDistortion(pResult, eEye, unChannel, fU, fV);
+        // The Brown-Conrady model, from the display coordinates of each channel (in pixels) to UVs.
+        vr::DistortionCoordinates_t ApplyBrownConrady(const DistortionModelSnapshot& model,
+                                                      vr::EVREye eEye,
+                                                      const float* x,
+                                                      const float* y) const {
+            // Transform final coordinates based on tangents.
+            float fLeft, fRight, fTop, fBottom;
+            m_shimmedDisplayComponent->GetProjectionRaw(eEye, &fLeft, &fRight, &fBottom, &fTop);
+            fLeft = std::abs(fLeft);
+            fRight = std::abs(fRight);
+            fTop = std::abs(fTop);
+            fBottom = std::abs(fBottom);
+            const float horizontalAperture = (fLeft + fRight);
+            const float verticalAperture = (fTop + fBottom);
+            const auto SetResult = [&](float* result, const DirectX::XMFLOAT2& uv) {
+                result[0] = (uv.x + fLeft) / horizontalAperture;
+                result[1] = (uv.y + fTop) / verticalAperture;
+            };
+
+            // Apply the distortion to each channel.
+            vr::DistortionCoordinates_t result{};
+            float* const channels[] = {result.rfRed, result.rfGreen, result.rfBlue};
+            for (int channel = 0; channel < 3; channel++) {
+                const DistortionModel& c = model.channels[eEye][channel];
+                SetResult(channels[channel],
+                          BrownConrady(x[channel],
+                                       y[channel],
+                                       model.invAffine[eEye],
+                                       c.codX,
+                                       c.codY,
+                                       c.k1,
+                                       c.k2,
+                                       c.k3,
+                                       model.maxRadius2[eEye][channel]));
+            }
+            return result;
         }
 
-        bool ReadDistortionModel() {
+        // The whole pipeline, for baking.
+        vr::DistortionCoordinates_t EvaluatePipeline(const DistortionModelSnapshot& model,
+                                                     vr::EVREye eEye,
+                                                     float fU,
+                                                     float fV) const {
+            uint32_t dummy, width, height;
+            m_shimmedDisplayComponent->GetEyeOutputViewport(eEye, &dummy, &dummy, &width, &height);
+            float x[] = {fU * width, fU * width, fU * width};
+            float y[] = {fV * height, fV * height, fV * height};
+
+            vr::DistortionCoordinates_t result{};
+            float* const channels[] = {result.rfRed, result.rfGreen, result.rfBlue};
+            for (size_t i = 0; i < model.stages.size(); i++) {
+                const bool isLast = i + 1 == model.stages.size();
+                switch (model.stages[i]) {
+                case PipelineStage::IpdShift:
+                    for (int channel = 0; channel < 3; channel++) {
+                        x[channel] += model.ipdShift[eEye];
+                    }
+                    break;
+
+                case PipelineStage::Residual:
+                    for (int channel = 0; channel < 3; channel++) {
+                        float offsetX, offsetY;
+                        model.residual->Sample(eEye, x[channel] / width, y[channel] / height, offsetX, offsetY);
+                        x[channel] += offsetX;
+                        y[channel] += offsetY;
+                    }
+                    break;
+
+                case PipelineStage::BrownConrady:
+                    if (isLast) {
+                        return ApplyBrownConrady(model, eEye, x, y);
+                    }
+
+                    // Only the radial part, as a correction of the display coordinates.
+                    for (int channel = 0; channel < 3; channel++) {
+                        const DistortionModel& c = model.channels[eEye][channel];
+                        const float deltaX = x[channel] - c.codX;
+                        const float deltaY = y[channel] - c.codY;
+                        const float r2 = std::min(deltaX * deltaX + deltaY * deltaY, model.maxRadius2[eEye][channel]);
+                        const float d = 1.0f + r2 * (c.k1 + r2 * (c.k2 + r2 * c.k3));
+                        x[channel] = deltaX * d + c.codX;
+                        y[channel] = deltaY * d + c.codY;
+                    }
+                    break;
+
+                case PipelineStage::Vendor:
+                    for (int channel = 0; channel < 3; channel++) {
+                        model.vendorTable->Sample(
+                            eEye, channel, x[channel] / width, y[channel] / height, channels[channel]);
+                    }
+                    break;
+                }
+            }
+            return result;
+        }
+
+        void StartTraceRecording() {
+            // Keep recording to the same file upon re-activation.
+            if (m_traceRecorder) {
+                return;
+            }
+
+            char path[1024]{};
+            vr::VRSettings()->GetString("driver_distortion_shim", "trace_file", path, sizeof(path));
+            if (!path[0]) {
+                return;
+            }
+
+            m_traceRecorder = TraceRecorder::Create(path);
+            if (!m_traceRecorder) {
+                DriverLog("Failed to create trace file: %s", path);
+                return;
+            }
+            DriverLog("Recording display calls to %s", path);
+
+            // Record the vendor display, so that the replay can emulate it.
+            for (const vr::EVREye eye : {vr::Eye_Left, vr::Eye_Right}) {
+                uint32_t x, y, width, height;
+                m_shimmedDisplayComponent->GetEyeOutputViewport(eye, &x, &y, &width, &height);
+                float left, right, top, bottom;
+                m_shimmedDisplayComponent->GetProjectionRaw(eye, &left, &right, &top, &bottom);
+                m_traceRecorder->Display(eye, x, y, width, height, left, right, top, bottom);
+            }
+            uint32_t width, height;
+            m_shimmedDisplayComponent->GetRecommendedRenderTargetSize(&width, &height);
+            m_traceRecorder->RenderTargetSize(width, height);
+        }
+
+        // Set the hidden area meshes from the hidden_area_file setting, or disable them. Unless forced, only when the
+        // setting changed.
+        void ApplyHiddenArea(bool force) {
+            const std::string path = GetStringSetting("hidden_area_file");
+            if (!force && m_hiddenAreaFile == path) {
+                return;
+            }
+            m_hiddenAreaFile = path;
+
+            HiddenAreaMeshes meshes;
+            if (!path.empty()) {
+                if (meshes.Load(path)) {
+                    DriverLog("Loaded the hidden area meshes from %s", path.c_str());
+                } else {
+                    DriverLog("Failed to load the hidden area meshes: %s", path.c_str());
+                }
+            }
+
+            vr::CVRHiddenAreaHelpers helpers{vr::VRPropertiesRaw()};
+            for (const vr::EVREye eye : {vr::Eye_Left, vr::Eye_Right}) {
+                for (int type = 0; type < vr::k_eHiddenAreaMesh_Max; type++) {
+                    HiddenAreaMesh& mesh = meshes.meshes[eye][type];
+                    helpers.SetHiddenArea(eye,
+                                          (vr::EHiddenAreaMeshType)type,
+                                          mesh.empty() ? nullptr : mesh.data(),
+                                          (uint32_t)mesh.size());
+                }
+            }
+        }
+
+        float GetSetting(const char* key) {
+            const float value = vr::VRSettings()->GetFloat("driver_distortion_shim", key);
+            if (m_traceRecorder) {
+                m_traceRecorder->Setting(key, value);
+            }
+            return value;
+        }
+
+        std::string GetStringSetting(const char* key) {
+            char value[1024]{};
+            vr::VRSettings()->GetString("driver_distortion_shim", key, value, sizeof(value));
+            if (m_traceRecorder) {
+                m_traceRecorder->Setting(key, value);
+            }
+            return value;
+        }
+
+        // The latest model, for the calling thread, or nullptr before the model was first read. Each thread keeps a
+        // reference on the last snapshot it used, so that the hot path only checks the version.
+        const DistortionModelSnapshot* AcquireModel() const {
+            thread_local struct {
+                const HmdShimDriver* owner = nullptr;
+                uint64_t version = 0;
+                std::shared_ptr<const DistortionModelSnapshot> model;
+            } cache;
+
+            if (cache.owner != this || cache.version != m_modelVersion.load(std::memory_order_acquire)) {
+                cache.model = std::atomic_load(&m_model);
+                cache.owner = this;
+                cache.version = cache.model ? cache.model->version : 0;
+            }
+            return cache.model.get();
+        }
+
+        // Only the activation is part of the startup, not the settings changes.
+        bool ReadDistortionModel(bool isActivation) {
+            // Serialize the writers (settings changes and activation).
+            std::unique_lock lock(m_modelMutex);
+
             uint32_t dummy, width, height;
             m_shimmedDisplayComponent->GetEyeOutputViewport(vr::Eye_Left, &dummy, &dummy, &width, &height);
 
             // Retrieve Brown-Conrady parameters for both eyes.
-            decltype(m_distortionModel) newDistortionModel;
-            newDistortionModel[0][0].codX =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_red_cod_x") * width;
-            newDistortionModel[0][0].codY =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_red_cod_y") * height;
-            newDistortionModel[0][0].k1 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_red_k1");
-            newDistortionModel[0][0].k2 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_red_k2");
-            newDistortionModel[0][0].k3 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_red_k3");
-            newDistortionModel[0][1].codX =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_green_cod_x") * width;
-            newDistortionModel[0][1].codY =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_green_cod_y") * height;
-            newDistortionModel[0][1].k1 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_green_k1");
-            newDistortionModel[0][1].k2 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_green_k2");
-            newDistortionModel[0][1].k3 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_green_k3");
-            newDistortionModel[0][2].codX =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_blue_cod_x") * width;
-            newDistortionModel[0][2].codY =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_blue_cod_y") * height;
-            newDistortionModel[0][2].k1 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_blue_k1");
-            newDistortionModel[0][2].k2 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_blue_k2");
-            newDistortionModel[0][2].k3 = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_blue_k3");
-            newDistortionModel[1][0].codX =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_red_cod_x") * width;
-            newDistortionModel[1][0].codY =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_red_cod_y") * height;
-            newDistortionModel[1][0].k1 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_red_k1");
-            newDistortionModel[1][0].k2 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_red_k2");
-            newDistortionModel[1][0].k3 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_red_k3");
-            newDistortionModel[1][1].codX =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_green_cod_x") * width;
-            newDistortionModel[1][1].codY =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_green_cod_y") * height;
-            newDistortionModel[1][1].k1 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_green_k1");
-            newDistortionModel[1][1].k2 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_green_k2");
-            newDistortionModel[1][1].k3 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_green_k3");
-            newDistortionModel[1][2].codX =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_blue_cod_x") * width;
-            newDistortionModel[1][2].codY =
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_blue_cod_y") * height;
-            newDistortionModel[1][2].k1 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_blue_k1");
-            newDistortionModel[1][2].k2 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_blue_k2");
-            newDistortionModel[1][2].k3 = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_blue_k3");
+            DistortionModel newDistortionModel[2][3];
+            newDistortionModel[0][0].codX = GetSetting("left_red_cod_x") * width;
+            newDistortionModel[0][0].codY = GetSetting("left_red_cod_y") * height;
+            newDistortionModel[0][0].k1 = GetSetting("left_red_k1");
+            newDistortionModel[0][0].k2 = GetSetting("left_red_k2");
+            newDistortionModel[0][0].k3 = GetSetting("left_red_k3");
+            newDistortionModel[0][1].codX = GetSetting("left_green_cod_x") * width;
+            newDistortionModel[0][1].codY = GetSetting("left_green_cod_y") * height;
+            newDistortionModel[0][1].k1 = GetSetting("left_green_k1");
+            newDistortionModel[0][1].k2 = GetSetting("left_green_k2");
+            newDistortionModel[0][1].k3 = GetSetting("left_green_k3");
+            newDistortionModel[0][2].codX = GetSetting("left_blue_cod_x") * width;
+            newDistortionModel[0][2].codY = GetSetting("left_blue_cod_y") * height;
+            newDistortionModel[0][2].k1 = GetSetting("left_blue_k1");
+            newDistortionModel[0][2].k2 = GetSetting("left_blue_k2");
+            newDistortionModel[0][2].k3 = GetSetting("left_blue_k3");
+            newDistortionModel[1][0].codX = GetSetting("right_red_cod_x") * width;
+            newDistortionModel[1][0].codY = GetSetting("right_red_cod_y") * height;
+            newDistortionModel[1][0].k1 = GetSetting("right_red_k1");
+            newDistortionModel[1][0].k2 = GetSetting("right_red_k2");
+            newDistortionModel[1][0].k3 = GetSetting("right_red_k3");
+            newDistortionModel[1][1].codX = GetSetting("right_green_cod_x") * width;
+            newDistortionModel[1][1].codY = GetSetting("right_green_cod_y") * height;
+            newDistortionModel[1][1].k1 = GetSetting("right_green_k1");
+            newDistortionModel[1][1].k2 = GetSetting("right_green_k2");
+            newDistortionModel[1][1].k3 = GetSetting("right_green_k3");
+            newDistortionModel[1][2].codX = GetSetting("right_blue_cod_x") * width;
+            newDistortionModel[1][2].codY = GetSetting("right_blue_cod_y") * height;
+            newDistortionModel[1][2].k1 = GetSetting("right_blue_k1");
+            newDistortionModel[1][2].k2 = GetSetting("right_blue_k2");
+            newDistortionModel[1][2].k3 = GetSetting("right_blue_k3");
 
             // Retrieve Affine matrix parameters for left eye.
-            const DirectX::XMFLOAT2 focalLengthLeft(
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_focal_length_x") * width,
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_focal_length_y") * height);
-            const DirectX::XMFLOAT2 principalPointLeft(
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_principal_point_x") * width,
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "left_principal_point_y") * height);
-            const float skewFactorLeft = vr::VRSettings()->GetFloat("driver_distortion_shim", "left_skew_factor");
+            const DirectX::XMFLOAT2 focalLengthLeft(GetSetting("left_focal_length_x") * width,
+                                                    GetSetting("left_focal_length_y") * height);
+            const DirectX::XMFLOAT2 principalPointLeft(GetSetting("left_principal_point_x") * width,
+                                                       GetSetting("left_principal_point_y") * height);
+            const float skewFactorLeft = GetSetting("left_skew_factor");
             const DirectX::XMMATRIX newAffineLeft(
                 // clang-format off
                 focalLengthLeft.x,    0.0f,                 0.0f, 0.0f,
@@ -392,13 +621,11 @@ namespace {
             // clang-format on
 
             // Retrieve Affine matrix parameters for right eye.
-            const DirectX::XMFLOAT2 focalLengthRight(
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_focal_length_x") * width,
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_focal_length_y") * height);
-            const DirectX::XMFLOAT2 principalPointRight(
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_principal_point_x") * width,
-                vr::VRSettings()->GetFloat("driver_distortion_shim", "right_principal_point_y") * height);
-            const float skewFactorRight = vr::VRSettings()->GetFloat("driver_distortion_shim", "right_skew_factor");
+            const DirectX::XMFLOAT2 focalLengthRight(GetSetting("right_focal_length_x") * width,
+                                                     GetSetting("right_focal_length_y") * height);
+            const DirectX::XMFLOAT2 principalPointRight(GetSetting("right_principal_point_x") * width,
+                                                        GetSetting("right_principal_point_y") * height);
+            const float skewFactorRight = GetSetting("right_skew_factor");
             const DirectX::XMMATRIX newAffineRight(
                 // clang-format off
                 focalLengthRight.x,    0.0f,                  0.0f, 0.0f,
@@ -407,70 +634,270 @@ namespace {
                 0.0f,                  0.0f,                  0.0f, 1.0f);
             // clang-format on
 
+            // Retrieve the stages of the pipeline. Without a pipeline, compose on top of the vendor distortion if
+            // requested, otherwise use Brown-Conrady alone.
+            const std::string pipeline = GetStringSetting("pipeline");
+            const bool composeVendorDistortion =
+                vr::VRSettings()->GetBool("driver_distortion_shim", "compose_vendor_distortion");
+            if (m_traceRecorder) {
+                m_traceRecorder->Setting("compose_vendor_distortion", composeVendorDistortion ? 1.f : 0.f);
+            }
+            PipelineStages newStages;
+            if (pipeline.empty()) {
+                newStages.push_back(PipelineStage::BrownConrady);
+                if (composeVendorDistortion) {
+                    newStages.push_back(PipelineStage::Vendor);
+                }
+            } else if (!ParsePipeline(pipeline, newStages)) {
+                DriverLog("Invalid distortion pipeline: %s, using brown_conrady", pipeline.c_str());
+                newStages = {PipelineStage::BrownConrady};
+            }
+            const auto HasStage = [&](PipelineStage stage) {
+                return std::find(newStages.cbegin(), newStages.cend(), stage) != newStages.cend();
+            };
+
+            float newIpdShift[2] = {};
+            if (HasStage(PipelineStage::IpdShift)) {
+                // Each eye moves outwards by half of the shift.
+                const float ipd = vr::VRProperties()->GetFloatProperty(
+                    vr::VRProperties()->TrackedDeviceToPropertyContainer(m_deviceIndex), vr::Prop_UserIpdMeters_Float);
+                const float shift = (ipd - GetSetting("ipd_nominal")) * 1000.f * GetSetting("ipd_shift") / 2;
+                newIpdShift[vr::Eye_Left] = -shift;
+                newIpdShift[vr::Eye_Right] = shift;
+            }
+
+            std::shared_ptr<const ResidualGrid> newResidual;
+            if (HasStage(PipelineStage::Residual)) {
+                const std::string path = GetStringSetting("residual_file");
+                newResidual = ResidualGrid::Load(path);
+                if (!newResidual) {
+                    DriverLog("Failed to load the residual grid: %s, skipping", path.c_str());
+                    newStages.erase(std::find(newStages.cbegin(), newStages.cend(), PipelineStage::Residual));
+                } else if (m_model && m_model->residual && *m_model->residual == *newResidual) {
+                    newResidual = m_model->residual;
+                }
+            }
+
+            const uint32_t newBakedResolution = (uint32_t)std::clamp(
+                vr::VRSettings()->GetInt32("driver_distortion_shim", "baked_table_resolution"), 2, 2048);
+            if (m_traceRecorder) {
+                m_traceRecorder->Setting("baked_table_resolution", (float)newBakedResolution);
+            }
+            const float newQuantizedTableMaxError = std::max(GetSetting("quantized_table_max_error"), 0.f);
+
+            // The vendor table is only sampled the first time.
+            const std::shared_ptr<const VendorDistortionTable> newVendorTable =
+                HasStage(PipelineStage::Vendor) ? AcquireVendorTable() : nullptr;
+
             // Detect changes.
-            const bool changed = memcmp(m_distortionModel, newDistortionModel, sizeof(newDistortionModel)) ||
-                                 memcmp(&m_affine[0], &newAffineLeft, sizeof(newAffineLeft)) ||
-                                 memcmp(&m_affine[1], &newAffineRight, sizeof(newAffineRight));
+            const bool changed = !m_model ||
+                                 memcmp(m_model->channels, newDistortionModel, sizeof(newDistortionModel)) ||
+                                 memcmp(&m_model->affine[0], &newAffineLeft, sizeof(newAffineLeft)) ||
+                                 memcmp(&m_model->affine[1], &newAffineRight, sizeof(newAffineRight)) ||
+                                 m_model->stages != newStages ||
+                                 memcmp(m_model->ipdShift, newIpdShift, sizeof(newIpdShift)) ||
+                                 m_model->residual != newResidual || m_model->vendorTable != newVendorTable ||
+                                 m_model->bakedResolution != newBakedResolution ||
+                                 m_model->quantizedTableMaxError != newQuantizedTableMaxError;
 
             // Commit changes.
-            memcpy(m_distortionModel, newDistortionModel, sizeof(newDistortionModel));
-            m_affine[0] = newAffineLeft;
-            m_affine[1] = newAffineRight;
-            m_invAffine[0] = DirectX::XMMatrixInverse(nullptr, m_affine[0]);
-            m_invAffine[1] = DirectX::XMMatrixInverse(nullptr, m_affine[1]);
+            if (changed) {
+                std::unique_ptr<DistortionModelSnapshot> newModel(new DistortionModelSnapshot());
+                memcpy(newModel->channels, newDistortionModel, sizeof(newDistortionModel));
+                newModel->affine[0] = newAffineLeft;
+                newModel->affine[1] = newAffineRight;
+                newModel->invAffine[0] = DirectX::XMMatrixInverse(nullptr, newAffineLeft);
+                newModel->invAffine[1] = DirectX::XMMatrixInverse(nullptr, newAffineRight);
+                newModel->stages = std::move(newStages);
+                memcpy(newModel->ipdShift, newIpdShift, sizeof(newIpdShift));
+                newModel->residual = std::move(newResidual);
+                newModel->vendorTable = newVendorTable;
+                newModel->bakedResolution = newBakedResolution;
+                newModel->quantizedTableMaxError = newQuantizedTableMaxError;
+                AnalyzeFoldOver(*newModel);
+                BakePipeline(*newModel, isActivation);
+                newModel->version = ++lastModelVersion;
+
+                std::atomic_store(&m_model, std::shared_ptr<const DistortionModelSnapshot>(std::move(newModel)));
+                m_modelVersion.store(m_model->version, std::memory_order_release);
+            }
 
             return changed;
         }
 
-        void ApplySettingsChanges() {
+        void BakePipeline(DistortionModelSnapshot& model, bool isActivation) const {
+            if (model.stages.size() == 1 && model.stages[0] == PipelineStage::BrownConrady) {
+                return;
+            }
+
+            // The vendor distortion alone is already a table. It is kept in floats for baking the other pipelines.
+            if (model.stages.size() == 1 && model.stages[0] == PipelineStage::Vendor) {
+                model.bakedTable = model.vendorTable;
+                QuantizeBakedTable(model);
+                return;
+            }
+
+            // The vendor's ComputeDistortion() is not called (its distortion is a table), and the other display calls
+            // are already made concurrently by ComputeDistortion(), so the pipeline can be evaluated on all the cores.
+            std::optional<ScopedStartupPhase> phase;
+            if (isActivation) {
+                phase.emplace(StartupPhase::BakePipeline);
+            }
+            const auto start = std::chrono::steady_clock::now();
+            model.bakedTable = DistortionTable::Bake(
+                model.bakedResolution,
+                [&](vr::EVREye eye, float u, float v) { return EvaluatePipeline(model, eye, u, v); },
+                std::max(1u, std::thread::hardware_concurrency()));
+
+            std::string stages;
+            for (const PipelineStage stage : model.stages) {
+                stages += (stages.empty() ? "" : ",") + std::string(GetPipelineStageName(stage));
+            }
+            DriverLog("Baked the distortion pipeline %s (%ux%u per eye and channel) in %.1f ms",
+                      stages.c_str(),
+                      model.bakedTable->Resolution(),
+                      model.bakedTable->Resolution(),
+                      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            QuantizeBakedTable(model);
+        }
+
+        void QuantizeBakedTable(DistortionModelSnapshot& model) const {
+            if (model.quantizedTableMaxError <= 0) {
+                return;
+            }
+
+            uint32_t dummy, width[2], height[2];
+            for (const vr::EVREye eye : {vr::Eye_Left, vr::Eye_Right}) {
+                m_shimmedDisplayComponent->GetEyeOutputViewport(eye, &dummy, &dummy, &width[eye], &height[eye]);
+            }
+            double error;
+            std::shared_ptr<const DistortionTable> quantized =
+                DistortionTable::Quantize(*model.bakedTable, width, height, model.quantizedTableMaxError, &error);
+            if (!quantized) {
+                DriverLog("Keeping the distortion table in floats: quantizing it would cost up to %.4f display "
+                          "pixels, over %.4f",
+                          error,
+                          model.quantizedTableMaxError);
+                return;
+            }
+            DriverLog("Quantized the distortion table to %zu KiB (from %zu KiB), error up to %.4f display pixels",
+                      quantized->Bytes() / 1024,
+                      model.bakedTable->Bytes() / 1024,
+                      error);
+            model.bakedTable = std::move(quantized);
+        }
+
+        // The vendor distortion table, from the disk cache or sampled on first use. Requires m_modelMutex.
+        const std::shared_ptr<const VendorDistortionTable>& AcquireVendorTable() {
+            if (!m_vendorTable) {
+                char directory[1024]{};
+                vr::VRSettings()->GetString(
+                    "driver_distortion_shim", "vendor_table_directory", directory, sizeof(directory));
+                const int32_t resolution =
+                    vr::VRSettings()->GetInt32("driver_distortion_shim", "vendor_table_resolution");
+
+                m_vendorTable = VendorDistortionTable::LoadOrCapture(
+                    m_shimmedDisplayComponent, m_serialNumber, directory, (uint32_t)std::clamp(resolution, 2, 1024));
+            }
+            return m_vendorTable;
+        }
+
+        void AnalyzeFoldOver(DistortionModelSnapshot& model) const {
+            static const char* const eyeNames[] = {"left", "right"};
+            static const char* const channelNames[] = {"red", "green", "blue"};
+
+            for (int eye = 0; eye < 2; eye++) {
+                uint32_t dummy, width, height;
+                m_shimmedDisplayComponent->GetEyeOutputViewport((vr::EVREye)eye, &dummy, &dummy, &width, &height);
+
+                for (int channel = 0; channel < 3; channel++) {
+                    const DistortionModel& c = model.channels[eye][channel];
+                    const double radius = FindFoldOverRadius(c.k1, c.k2, c.k3);
+                    model.maxRadius2[eye][channel] =
+                        (float)std::min(radius * radius, (double)std::numeric_limits<float>::max());
+
+                    const double viewportRadius = GetViewportMaxRadius(c.codX, c.codY, width, height);
+                    if (radius < viewportRadius) {
+                        DriverLog("Warning: %s %s distortion folds over at %.1f px from its center, inside of the "
+                                  "viewport (up to %.1f px), clamping",
+                                  eyeNames[eye],
+                                  channelNames[channel],
+                                  radius,
+                                  viewportRadius);
+                    }
+                }
+            }
+        }
+
+        void ApplySettingsChanges() override {
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "HmdDriver_ApplySettingsChanges", TLArg(m_deviceIndex, "ObjectId"));
 
             // Don't do anything if your shim did not hook a display driver.
             if (m_shimmedDisplayComponent && !m_isNotDirectModeDriver) {
-                const bool distortionChanged = ReadDistortionModel();
+                if (m_traceRecorder) {
+                    m_traceRecorder->SettingsChanged();
+                }
+
+                const bool distortionChanged = ReadDistortionModel(false);
                 if (distortionChanged) {
                     // Force SteamVR to recompute the distortion mesh (calling ComputeDistortion() etc...)
                     m_driverHost->VendorSpecificEvent(m_deviceIndex, vr::VREvent_LensDistortionChanged, {}, 0.0);
-
-                    // FIXME: You probably want to recompute the hidden area mesh here too.
-                    // In our example, we disabled it entirely (see Activate()).
                 }
+
+                // The meshes are exported for a lens profile, so reload them along with it.
+                ApplyHiddenArea(distortionChanged);
             }
 
             TraceLoggingWriteStop(local, "HmdDriver_ApplySettingsChanges", );
         }
 
-        vr::ITrackedDeviceServerDriver* const m_shimmedDevice;
         vr::IVRServerDriverHost* const m_driverHost;
+        const std::string m_serialNumber;
         vr::TrackedDeviceIndex_t m_deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
-        vr::IVRDisplayComponent* m_shimmedDisplayComponent = nullptr;
         bool m_isNotDirectModeDriver = false;
 
-        // Affine transform.
-        DirectX::XMMATRIX m_affine[2];
-        DirectX::XMMATRIX m_invAffine[2];
+        // The hidden_area_file setting of the meshes that were set.
+        std::string m_hiddenAreaFile;
 
-        // Distortion parameters for 2 eyes, 3 channels.
-        DistortionModel m_distortionModel[2][3];
+        // Set when the trace_file setting is set.
+        std::unique_ptr<TraceRecorder> m_traceRecorder;
+
+        // The current model, read with std::atomic_load() and replaced with std::atomic_store().
+        std::shared_ptr<const DistortionModelSnapshot> m_model;
+        std::atomic<uint64_t> m_modelVersion{0};
+        std::mutex m_modelMutex;
+
+        // Sampled once, when first composing on top of the vendor distortion.
+        std::shared_ptr<const VendorDistortionTable> m_vendorTable;
     };
 } // namespace
 
 namespace driver_shim {
 
-    std::vector<HmdShimDriver*> drivers;
-
     vr::ITrackedDeviceServerDriver* CreateHmdShimDriver(vr::ITrackedDeviceServerDriver* shimmedDriver,
-                                                        vr::IVRServerDriverHost* driverHost) {
-        auto driver = new HmdShimDriver(shimmedDriver, driverHost);
-        drivers.push_back(driver);
-        return driver;
+                                                        vr::IVRServerDriverHost* driverHost,
+                                                        const char* serialNumber) {
+        const std::shared_ptr<HmdShimDriver> driver(new HmdShimDriver(shimmedDriver, driverHost, serialNumber));
+        GetDeviceRegistry().Add(driver, driver.get());
+        return driver.get();
     }
 
     void ApplySettingsChanges() {
-        for (auto driver : drivers) {
-            driver->ApplySettingsChanges();
+        const auto devices = GetDeviceRegistry().GetActiveDevices();
+        for (const auto& entry : *devices) {
+            entry.device->ApplySettingsChanges();
+        }
+    }
+
+    void ApplySettingsChanges(vr::TrackedDeviceIndex_t deviceIndex) {
+        if (const auto device = GetDeviceRegistry().Find(deviceIndex)) {
+            device->ApplySettingsChanges();
         }
     }
 
+    void DestroyShimDrivers() {
+        GetDeviceRegistry().Clear();
+    }
+
 } // namespace driver_shim
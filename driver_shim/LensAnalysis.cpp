@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "LensAnalysis.h"
+
+namespace {
+
+    // g(s) = c0 + c1 s + c2 s^2 + c3 s^3.
+    double EvaluateCubic(const double c[4], double s) {
+        return c[0] + s * (c[1] + s * (c[2] + s * c[3]));
+    }
+
+    // Real roots of a s^2 + b s + c, without the cancellation of the textbook formula.
+    int SolveQuadratic(double a, double b, double c, double roots[2]) {
+        if (a == 0) {
+            if (b == 0) {
+                return 0;
+            }
+            roots[0] = -c / b;
+            return 1;
+        }
+        const double discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) {
+            return 0;
+        }
+        const double q = -0.5 * (b + std::copysign(std::sqrt(discriminant), b));
+        if (q == 0) {
+            roots[0] = 0;
+            return 1;
+        }
+        roots[0] = q / a;
+        roots[1] = c / q;
+        return 2;
+    }
+
+} // namespace
+
+namespace driver_shim {
+
+    double FindFoldOverRadius(double k1, double k2, double k3) {
+        // Derivative of the mapping as a cubic in s = r^2.
+        double c[4] = {1.0, 3.0 * k1, 5.0 * k2, 7.0 * k3};
+
+        // In pixels, the coefficients span dozens of orders of magnitude (k3 is typically around 1e-20). Rescale s so
+        // that the largest coefficient is 1, which keeps every step below well-conditioned.
+        double scale = std::numeric_limits<double>::infinity();
+        for (int i = 1; i < 4; i++) {
+            if (c[i] != 0) {
+                scale = std::min(scale, std::pow(std::abs(c[i]), -1.0 / i));
+            }
+        }
+        if (std::isinf(scale)) {
+            return std::numeric_limits<double>::infinity();
+        }
+        for (int i = 1; i < 4; i++) {
+            c[i] *= std::pow(scale, i);
+        }
+
+        // Cauchy bound: all the roots are below it.
+        int degree = 3;
+        while (c[degree] == 0) {
+            degree--;
+        }
+        double upper = 0;
+        for (int i = 0; i < degree; i++) {
+            upper = std::max(upper, std::abs(c[i] / c[degree]));
+        }
+        upper += 1;
+
+        // Between consecutive stationary points g(s) is monotonic, so it has at most one root on each interval and a
+        // sign test is enough to bracket it. A double root is a stationary point where g touches 0, which the test
+        // also catches at the end of an interval.
+        double bounds[4] = {0};
+        int boundCount = 1;
+        double stationary[2];
+        const int stationaryCount = SolveQuadratic(3 * c[3], 2 * c[2], c[1], stationary);
+        std::sort(stationary, stationary + stationaryCount);
+        for (int i = 0; i < stationaryCount; i++) {
+            if (stationary[i] > 0 && stationary[i] < upper) {
+                bounds[boundCount++] = stationary[i];
+            }
+        }
+        bounds[boundCount++] = upper;
+
+        for (int i = 0; i + 1 < boundCount; i++) {
+            double low = bounds[i];
+            double high = bounds[i + 1];
+            if (EvaluateCubic(c, high) > 0) {
+                continue;
+            }
+
+            // g(low) > 0 since g(0) = 1 and we stop at the first non-positive value. Bisect down to the resolution of
+            // a double.
+            while (true) {
+                const double middle = 0.5 * (low + high);
+                if (middle <= low || middle >= high) {
+                    break;
+                }
+                (EvaluateCubic(c, middle) > 0 ? low : high) = middle;
+            }
+            return std::sqrt(high * scale);
+        }
+
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double GetViewportMaxRadius(double codX, double codY, double width, double height) {
+        const double dx = std::max(codX, width - codX);
+        const double dy = std::max(codY, height - codY);
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+} // namespace driver_shim
@@ -0,0 +1,38 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace driver_shim {
+
+    // Analysis of the radial part of the Brown-Conrady model, r' = r * (1 + k1 r^2 + k2 r^4 + k3 r^6).
+    //
+    // The mapping is only usable while it is strictly increasing with r: past the first root of its derivative
+    // 1 + 3 k1 r^2 + 5 k2 r^4 + 7 k3 r^6, the image folds over itself, and neither an inverse nor a table over that
+    // domain is meaningful. Returns that radius (in the units of the coefficients, ie: display pixels for the shim),
+    // or infinity if the mapping never folds over.
+    double FindFoldOverRadius(double k1, double k2, double k3);
+
+    // Distance from a center of distortion to the farthest corner of a viewport.
+    double GetViewportMaxRadius(double codX, double codY, double width, double height);
+
+} // namespace driver_shim
@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "MemoryAccounting.h"
+
+namespace {
+    using namespace driver_shim;
+
+    struct TagCounters {
+        std::atomic<size_t> currentBytes{0};
+        std::atomic<size_t> peakBytes{0};
+        std::atomic<uint64_t> allocations{0};
+    };
+
+    TagCounters counters[(size_t)MemoryTag::Count];
+
+    const char* const tagNames[(size_t)MemoryTag::Count] = {"driver_objects", "profiles", "tables", "traces"};
+
+} // namespace
+
+namespace driver_shim {
+
+    const char* GetMemoryTagName(MemoryTag tag) {
+        return tag < MemoryTag::Count ? tagNames[(size_t)tag] : "unknown";
+    }
+
+    MemoryCounters GetMemoryCounters(MemoryTag tag) {
+        const TagCounters& tagCounters = counters[(size_t)tag];
+        return {tagCounters.currentBytes, tagCounters.peakBytes, tagCounters.allocations};
+    }
+
+    void TrackAllocation(MemoryTag tag, size_t size) {
+        TagCounters& tagCounters = counters[(size_t)tag];
+        const size_t current = tagCounters.currentBytes += size;
+        tagCounters.allocations++;
+
+        size_t peak = tagCounters.peakBytes;
+        while (current > peak && !tagCounters.peakBytes.compare_exchange_weak(peak, current)) {
+        }
+    }
+
+    void TrackDeallocation(MemoryTag tag, size_t size) {
+        counters[(size_t)tag].currentBytes -= size;
+    }
+
+    std::string FormatMemoryCounters() {
+        std::string result;
+        for (size_t i = 0; i < (size_t)MemoryTag::Count; i++) {
+            const MemoryCounters tagCounters = GetMemoryCounters((MemoryTag)i);
+            char line[128];
+            snprintf(line,
+                     sizeof(line),
+                     "%s %zu %zu %llu\n",
+                     tagNames[i],
+                     tagCounters.currentBytes,
+                     tagCounters.peakBytes,
+                     (unsigned long long)tagCounters.allocations);
+            result += line;
+        }
+        return result;
+    }
+
+    void LogMemoryCounters() {
+        for (size_t i = 0; i < (size_t)MemoryTag::Count; i++) {
+            const MemoryCounters tagCounters = GetMemoryCounters((MemoryTag)i);
+            DriverLog("Memory %s: %zu bytes (peak %zu bytes, %llu allocations)",
+                      tagNames[i],
+                      tagCounters.currentBytes,
+                      tagCounters.peakBytes,
+                      (unsigned long long)tagCounters.allocations);
+        }
+    }
+
+} // namespace driver_shim
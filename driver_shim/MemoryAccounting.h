@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace driver_shim {
+
+    // Memory accounting for the allocations made by the shim inside vrserver. Each allocation is attributed to a tag,
+    // with current and peak counters per tag.
+    //
+    // Only the objects deriving from TaggedObject and the containers using TaggedAllocator are counted. Not counted:
+    // the strings (eg: the module names, the serial number and the setting values), the shared_ptr control blocks (with
+    // the object itself for std::make_shared()), and the temporaries that do not outlive a call.
+    enum class MemoryTag : uint32_t {
+        DriverObjects, // The provider, shim devices and their bookkeeping.
+        Profiles,      // Lens models and their parameters.
+        Tables,        // Precomputed tables and caches.
+        Traces,        // Trace recording buffers.
+
+        Count
+    };
+
+    struct MemoryCounters {
+        size_t currentBytes;
+        size_t peakBytes;
+        uint64_t allocations;
+    };
+
+    const char* GetMemoryTagName(MemoryTag tag);
+    MemoryCounters GetMemoryCounters(MemoryTag tag);
+
+    void TrackAllocation(MemoryTag tag, size_t size);
+    void TrackDeallocation(MemoryTag tag, size_t size);
+
+    // One line per tag: "<tag> <current bytes> <peak bytes> <allocations>".
+    std::string FormatMemoryCounters();
+    void LogMemoryCounters();
+
+    // Standard allocator attributing its allocations to a tag, eg: for containers.
+    template <typename T, MemoryTag Tag>
+    struct TaggedAllocator {
+        using value_type = T;
+
+        TaggedAllocator() = default;
+        template <typename U>
+        TaggedAllocator(const TaggedAllocator<U, Tag>&) {
+        }
+
+        template <typename U>
+        struct rebind {
+            using other = TaggedAllocator<U, Tag>;
+        };
+
+        T* allocate(size_t count) {
+            TrackAllocation(Tag, count * sizeof(T));
+            return std::allocator<T>().allocate(count);
+        }
+
+        void deallocate(T* pointer, size_t count) {
+            TrackDeallocation(Tag, count * sizeof(T));
+            std::allocator<T>().deallocate(pointer, count);
+        }
+
+        template <typename U>
+        bool operator==(const TaggedAllocator<U, Tag>&) const {
+            return true;
+        }
+        template <typename U>
+        bool operator!=(const TaggedAllocator<U, Tag>&) const {
+            return false;
+        }
+    };
+
+    template <typename T, MemoryTag Tag>
+    using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+
+    // Base class attributing the heap allocations of the derived objects to a tag. Over-aligned objects (eg: holding
+    // XMMATRIX) go through the aligned forms, otherwise the class-specific operators would take precedence over the
+    // global aligned ones.
+    template <MemoryTag Tag>
+    struct TaggedObject {
+        static void* operator new(size_t size) {
+            TrackAllocation(Tag, size);
+            return ::operator new(size);
+        }
+
+        static void* operator new(size_t size, std::align_val_t alignment) {
+            TrackAllocation(Tag, size);
+            return ::operator new(size, alignment);
+        }
+
+        static void operator delete(void* pointer, size_t size) {
+            TrackDeallocation(Tag, size);
+            ::operator delete(pointer);
+        }
+
+        static void operator delete(void* pointer, size_t size, std::align_val_t alignment) {
+            TrackDeallocation(Tag, size);
+            ::operator delete(pointer, alignment);
+        }
+    };
+
+} // namespace driver_shim
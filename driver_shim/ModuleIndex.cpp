@@ -0,0 +1,138 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "ModuleIndex.h"
+
+#ifndef DRIVER_SHIM_PORTABLE
+#include <psapi.h>
+#else
+#include <link.h>
+#endif
+
+namespace {
+    using namespace driver_shim;
+
+    std::string ToLower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return (char)tolower(c); });
+        return value;
+    }
+
+    std::vector<ModuleRange> EnumerateModules() {
+        std::vector<ModuleRange> ranges;
+#ifndef DRIVER_SHIM_PORTABLE
+        const HANDLE process = GetCurrentProcess();
+        std::vector<HMODULE> modules(256);
+        DWORD needed = 0;
+        while (EnumProcessModules(process, modules.data(), (DWORD)(modules.size() * sizeof(HMODULE)), &needed) &&
+               needed > modules.size() * sizeof(HMODULE)) {
+            modules.resize(needed / sizeof(HMODULE));
+        }
+        modules.resize(std::min<size_t>(modules.size(), needed / sizeof(HMODULE)));
+
+        for (const HMODULE module : modules) {
+            MODULEINFO info{};
+            char path[MAX_PATH]{};
+            if (!GetModuleInformation(process, module, &info, sizeof(info)) ||
+                !GetModuleFileNameA(module, path, sizeof(path))) {
+                continue;
+            }
+            ranges.push_back({(uintptr_t)info.lpBaseOfDll,
+                              (uintptr_t)info.lpBaseOfDll + info.SizeOfImage,
+                              std::filesystem::path(path).filename().string(),
+                              false});
+        }
+#else
+        // The loaded segments of each shared object.
+        dl_iterate_phdr(
+            [](struct dl_phdr_info* info, size_t, void* data) {
+                uintptr_t begin = UINTPTR_MAX, end = 0;
+                for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++) {
+                    const ElfW(Phdr)& header = info->dlpi_phdr[i];
+                    if (header.p_type == PT_LOAD) {
+                        begin = std::min(begin, (uintptr_t)(info->dlpi_addr + header.p_vaddr));
+                        end = std::max(end, (uintptr_t)(info->dlpi_addr + header.p_vaddr + header.p_memsz));
+                    }
+                }
+                if (begin < end) {
+                    // The main program has no name.
+                    std::error_code error;
+                    const std::filesystem::path path = info->dlpi_name && *info->dlpi_name
+                                                           ? std::filesystem::path(info->dlpi_name)
+                                                           : std::filesystem::read_symlink("/proc/self/exe", error);
+                    ((std::vector<ModuleRange>*)data)
+                        ->push_back({begin, end, path.filename().string(), false});
+                }
+                return 0;
+            },
+            &ranges);
+#endif
+        return ranges;
+    }
+
+} // namespace
+
+namespace driver_shim {
+
+    ModuleIndex::ModuleIndex(std::vector<ModuleRange> ranges)
+        : m_ranges(std::make_move_iterator(ranges.begin()), std::make_move_iterator(ranges.end())) {
+        std::sort(m_ranges.begin(), m_ranges.end(), [](const ModuleRange& a, const ModuleRange& b) {
+            return a.begin < b.begin;
+        });
+    }
+
+    std::unique_ptr<ModuleIndex> ModuleIndex::FromProcess(const std::vector<std::string>& targetNames) {
+        std::vector<ModuleRange> ranges = EnumerateModules();
+        for (ModuleRange& range : ranges) {
+            range.isTarget = IsTargetModuleName(range.name, targetNames);
+        }
+        return std::make_unique<ModuleIndex>(std::move(ranges));
+    }
+
+    std::vector<std::string> ParseModuleNames(const std::string& description) {
+        std::vector<std::string> names;
+        std::istringstream stream(description);
+        std::string name;
+        while (std::getline(stream, name, ',')) {
+            name.erase(0, name.find_first_not_of(' '));
+            name.erase(name.find_last_not_of(' ') + 1);
+            if (!name.empty()) {
+                names.push_back(name);
+            }
+        }
+        return names;
+    }
+
+    bool IsTargetModuleName(const std::string& moduleName, const std::vector<std::string>& targetNames) {
+        // Strip the extension, and the version of shared objects (eg: driver_oasis.so.1).
+        const auto stem = [](const std::string& name) {
+            const std::string lower = ToLower(name);
+            return lower.substr(0, lower.find('.'));
+        };
+        const std::string moduleStem = stem(moduleName);
+        return !moduleStem.empty() &&
+               std::any_of(targetNames.cbegin(), targetNames.cend(), [&](const std::string& name) {
+                   return stem(name) == moduleStem;
+               });
+    }
+
+} // namespace driver_shim
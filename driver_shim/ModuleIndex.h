@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include "MemoryAccounting.h"
+
+namespace driver_shim {
+
+    // The address range of a loaded module (DLL or shared object), [begin, end).
+    struct ModuleRange {
+        uintptr_t begin;
+        uintptr_t end;
+        std::string name; // The file name, eg: driver_oasis.dll.
+        bool isTarget;
+    };
+
+    // The modules loaded in the process, sorted by address, to find the module of an address with a binary search.
+    class ModuleIndex : public TaggedObject<MemoryTag::DriverObjects> {
+      public:
+        // The ranges may come in any order. They must not overlap.
+        explicit ModuleIndex(std::vector<ModuleRange> ranges);
+
+        // The modules loaded in the process now. A module is a target when its name (without the extension) is one of
+        // the target names, case-insensitive.
+        static std::unique_ptr<ModuleIndex> FromProcess(const std::vector<std::string>& targetNames);
+
+        // The module containing the address, or nullptr.
+        const ModuleRange* Find(uintptr_t address) const {
+            // The last range starting at or before the address.
+            const auto it = std::upper_bound(m_ranges.cbegin(),
+                                             m_ranges.cend(),
+                                             address,
+                                             [](uintptr_t address, const ModuleRange& range) {
+                                                 return address < range.begin;
+                                             });
+            if (it == m_ranges.cbegin() || address >= std::prev(it)->end) {
+                return nullptr;
+            }
+            return &*std::prev(it);
+        }
+
+        const TaggedVector<ModuleRange, MemoryTag::DriverObjects>& Ranges() const {
+            return m_ranges;
+        }
+
+      private:
+        TaggedVector<ModuleRange, MemoryTag::DriverObjects> m_ranges;
+    };
+
+    // Parse a comma-separated list of module names, eg: "driver_oasis, driver_lighthouse".
+    std::vector<std::string> ParseModuleNames(const std::string& description);
+
+    // Whether a module name matches one of the target names: the file name without its extension, case-insensitive.
+    bool IsTargetModuleName(const std::string& moduleName, const std::vector<std::string>& targetNames);
+
+} // namespace driver_shim
@@ -24,42 +24,165 @@
 
 #include "ShimDriverManager.h"
 #include "DetourUtils.h"
+#include "DeviceRegistry.h"
+#include "ModuleIndex.h"
+#include "StartupTimings.h"
 #include "Tracing.h"
 
 namespace {
     using namespace driver_shim;
 
-    DEFINE_DETOUR_FUNCTION(bool,
-                           IVRServerDriverHost_TrackedDeviceAdded,
-                           vr::IVRServerDriverHost* driverHost,
-                           const char* pchDeviceSerialNumber,
-                           vr::ETrackedDeviceClass eDeviceClass,
-                           vr::ITrackedDeviceServerDriver* pDriver) {
+    using TrackedDeviceAddedFunction = bool (*)(vr::IVRServerDriverHost* driverHost,
+                                                const char* pchDeviceSerialNumber,
+                                                vr::ETrackedDeviceClass eDeviceClass,
+                                                vr::ITrackedDeviceServerDriver* pDriver);
+
+    // The flavors of IVRServerDriverHost that drivers may be built against, and the vtable slot of TrackedDeviceAdded()
+    // in each of them. To support another flavor, add it here.
+    const struct {
+        const char* version;
+        unsigned int trackedDeviceAddedSlot;
+    } serverDriverHostVersions[] = {
+        {"IVRServerDriverHost_006", 0},
+        {"IVRServerDriverHost_005", 0},
+        {"IVRServerDriverHost_004", 0},
+    };
+    constexpr size_t ServerDriverHostVersionCount = std::size(serverDriverHostVersions);
+
+    TrackedDeviceAddedFunction original_TrackedDeviceAdded[ServerDriverHostVersionCount];
+
+    // Also shim the controllers and trackers of the target driver (the shim_controllers_and_trackers setting).
+    bool shimControllersAndTrackers = false;
+
+    // Common to all flavors.
+    bool TrackedDeviceAdded(TrackedDeviceAddedFunction original,
+                            void* returnAddress,
+                            vr::IVRServerDriverHost* driverHost,
+                            const char* pchDeviceSerialNumber,
+                            vr::ETrackedDeviceClass eDeviceClass,
+                            vr::ITrackedDeviceServerDriver* pDriver) {
         TraceLocalActivity(local);
         TraceLoggingWriteStart(local,
                                "IVRServerDriverHost_TrackedDeviceAdded",
                                TLArg(pchDeviceSerialNumber, "DeviceSerialNumber"),
                                TLArg((int)eDeviceClass, "DeviceClass"));
+        // Only the HMD is part of the startup, not the controllers and trackers added afterwards.
+        std::optional<ScopedStartupPhase> phase;
+        if (eDeviceClass == vr::TrackedDeviceClass_HMD) {
+            phase.emplace(StartupPhase::TrackedDeviceAdded);
+        }
 
         vr::ITrackedDeviceServerDriver* shimmedDriver = pDriver;
 
-        // Only shim the desired device class and if they are registered by the target driver.
-        if (IsTargetDriver(_ReturnAddress())) {
+        // Only shim the desired device class and if they are registered by the target driver. When the runtime
+        // implements an older flavor on top of a newer one, the call goes through two hooks: the device is then already
+        // shimmed.
+        if (GetDeviceRegistry().IsShimDriver(pDriver)) {
+            TraceLoggingWriteTagged(local, "IVRServerDriverHost_TrackedDeviceAdded", TLArg(true, "IsShimmed"));
+        } else if (IsTargetDriver(returnAddress)) {
             TraceLoggingWriteTagged(local, "IVRServerDriverHost_TrackedDeviceAdded", TLArg(true, "IsTargetDriver"));
             if (eDeviceClass == vr::TrackedDeviceClass_HMD) {
                 DriverLog("Shimming new TrackedDeviceClass_HMD with HmdShimDriver");
-                shimmedDriver = CreateHmdShimDriver(pDriver, driverHost);
+                ScopedStartupPhase createPhase(StartupPhase::CreateShimDevice);
+                shimmedDriver = CreateHmdShimDriver(pDriver, driverHost, pchDeviceSerialNumber);
+            } else if (shimControllersAndTrackers && (eDeviceClass == vr::TrackedDeviceClass_Controller ||
+                                                      eDeviceClass == vr::TrackedDeviceClass_GenericTracker)) {
+                DriverLog("Shimming new device of class %d with TrackedDeviceShimDriver", (int)eDeviceClass);
+                shimmedDriver = CreateTrackedDeviceShimDriver(pDriver, eDeviceClass);
             }
         }
 
-        const auto status = original_IVRServerDriverHost_TrackedDeviceAdded(
-            driverHost, pchDeviceSerialNumber, eDeviceClass, shimmedDriver);
+        const auto status = original(driverHost, pchDeviceSerialNumber, eDeviceClass, shimmedDriver);
+
+        // The HMD is activated by now, the startup of the shim is complete.
+        if (phase && shimmedDriver != pDriver) {
+            phase.reset();
+            LogStartupTimings();
+        }
 
         TraceLoggingWriteStop(local, "IVRServerDriverHost_TrackedDeviceAdded", TLArg(status, "Status"));
 
         return status;
     }
 
+    // One hook per flavor, only to know which original to call and who the caller is.
+    template <size_t Index>
+    bool hooked_TrackedDeviceAdded(vr::IVRServerDriverHost* driverHost,
+                                   const char* pchDeviceSerialNumber,
+                                   vr::ETrackedDeviceClass eDeviceClass,
+                                   vr::ITrackedDeviceServerDriver* pDriver) {
+        return TrackedDeviceAdded(original_TrackedDeviceAdded[Index],
+                                  _ReturnAddress(),
+                                  driverHost,
+                                  pchDeviceSerialNumber,
+                                  eDeviceClass,
+                                  pDriver);
+    }
+
+    template <size_t... Indices>
+    constexpr std::array<TrackedDeviceAddedFunction, sizeof...(Indices)>
+    MakeTrackedDeviceAddedHooks(std::index_sequence<Indices...>) {
+        return {hooked_TrackedDeviceAdded<Indices>...};
+    }
+    constexpr auto trackedDeviceAddedHooks =
+        MakeTrackedDeviceAddedHooks(std::make_index_sequence<ServerDriverHostVersionCount>());
+
+    // The driver modules to shim (the target_drivers setting). Empty to shim all of them.
+    std::vector<std::string> targetModuleNames;
+
+    // Built on first use, and rebuilt after a module was loaded or unloaded, or when an address is not in any module.
+    // Read with std::atomic_load() and replaced with std::atomic_store().
+    std::shared_ptr<const ModuleIndex> moduleIndex;
+    std::atomic<bool> isModuleIndexStale{true};
+    std::mutex moduleIndexMutex;
+
+    std::shared_ptr<const ModuleIndex> RefreshModuleIndex(const std::shared_ptr<const ModuleIndex>& current) {
+        std::unique_lock lock(moduleIndexMutex);
+
+        // Another thread may have refreshed it already.
+        std::shared_ptr<const ModuleIndex> index = std::atomic_load(&moduleIndex);
+        if (index != current) {
+            return index;
+        }
+
+        isModuleIndexStale = false;
+        index = ModuleIndex::FromProcess(targetModuleNames);
+        std::atomic_store(&moduleIndex, index);
+        return index;
+    }
+
+#ifndef DRIVER_SHIM_PORTABLE
+    // LdrRegisterDllNotification() is exported by ntdll.dll, without a header.
+    using LdrDllNotificationFunction = VOID(CALLBACK*)(ULONG notificationReason,
+                                                       const void* notificationData,
+                                                       PVOID context);
+    using LdrRegisterDllNotificationFunction = LONG(NTAPI*)(ULONG flags,
+                                                            LdrDllNotificationFunction notificationFunction,
+                                                            PVOID context,
+                                                            PVOID* cookie);
+
+    VOID CALLBACK OnDllNotification(ULONG notificationReason, const void* notificationData, PVOID context) {
+        // Called under the loader lock: only flag the index.
+        isModuleIndexStale = true;
+    }
+
+    void RegisterModuleNotifications() {
+        static PVOID cookie = nullptr;
+        if (cookie) {
+            return;
+        }
+        const auto ldrRegisterDllNotification = (LdrRegisterDllNotificationFunction)GetProcAddress(
+            GetModuleHandleA("ntdll.dll"), "LdrRegisterDllNotification");
+        if (!ldrRegisterDllNotification || ldrRegisterDllNotification(0, OnDllNotification, nullptr, &cookie) != 0) {
+            DriverLog("Failed to register for module notifications");
+        }
+    }
+#else
+    // Without notifications, the index is only rebuilt upon lookup misses.
+    void RegisterModuleNotifications() {
+    }
+#endif
+
 } // namespace
 
 namespace driver_shim {
@@ -67,32 +190,70 @@ namespace driver_shim {
     void InstallShimDriverHook() {
         TraceLocalActivity(local);
         TraceLoggingWriteStart(local, "InstallShimDriverHook");
+        ScopedStartupPhase phase(StartupPhase::InstallHook);
+
+        char targetDrivers[1024]{};
+        vr::VRSettings()->GetString("driver_distortion_shim", "target_drivers", targetDrivers, sizeof(targetDrivers));
+        {
+            std::unique_lock lock(moduleIndexMutex);
+            targetModuleNames = ParseModuleNames(targetDrivers);
+            isModuleIndexStale = true;
+        }
+        if (!targetModuleNames.empty()) {
+            DriverLog("Only shimming the devices of: %s", targetDrivers);
+            RegisterModuleNotifications();
+        }
+        shimControllersAndTrackers =
+            vr::VRSettings()->GetBool("driver_distortion_shim", "shim_controllers_and_trackers");
 
-        DriverLog("Installing IVRServerDriverHost::TrackedDeviceAdded hook");
+        // Hook every flavor the runtime implements. Flavors sharing their implementation are only hooked once.
+        std::vector<void*> targets;
+        for (size_t i = 0; i < ServerDriverHostVersionCount; i++) {
+            const auto& version = serverDriverHostVersions[i];
+            vr::EVRInitError eError;
+            vr::IVRServerDriverHost* const driverHost =
+                (vr::IVRServerDriverHost*)vr::VRDriverContext()->GetGenericInterface(version.version, &eError);
+            if (!driverHost) {
+                continue;
+            }
 
-        // TODO: Consider hooking all flavors. This is the most common one.
-        vr::EVRInitError eError;
-        DetourMethodAttach(vr::VRDriverContext()->GetGenericInterface("IVRServerDriverHost_006", &eError),
-                           0 /* TrackedDeviceAdded() */,
-                           hooked_IVRServerDriverHost_TrackedDeviceAdded,
-                           original_IVRServerDriverHost_TrackedDeviceAdded);
+            void* const target = GetMethodAddress(driverHost, version.trackedDeviceAddedSlot);
+            const bool isHooked = std::find(targets.cbegin(), targets.cend(), target) != targets.cend() ||
+                                  std::any_of(trackedDeviceAddedHooks.cbegin(),
+                                              trackedDeviceAddedHooks.cend(),
+                                              [&](TrackedDeviceAddedFunction hook) { return (void*)hook == target; });
+            if (isHooked) {
+                DriverLog("%s::TrackedDeviceAdded is already hooked", version.version);
+                continue;
+            }
+            targets.push_back(target);
+
+            DriverLog("Installing %s::TrackedDeviceAdded hook", version.version);
+            DetourMethodAttach(driverHost,
+                               version.trackedDeviceAddedSlot,
+                               trackedDeviceAddedHooks[i],
+                               original_TrackedDeviceAdded[i]);
+        }
 
         TraceLoggingWriteStop(local, "InstallShimDriverHook");
     }
 
     bool IsTargetDriver(void* returnAddress) {
-        // FIXME: Use this to restrict to a specific driver.
-#if 0
-        HMODULE callerModule;
-        if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-                               (LPCSTR)returnAddress,
-                               &callerModule)) {
-            return callerModule == GetModuleHandleA("driver_oasis.dll");
+        if (targetModuleNames.empty()) {
+            return true;
         }
-        return false;
-#else
-        return true;
-#endif
+
+        std::shared_ptr<const ModuleIndex> index = std::atomic_load(&moduleIndex);
+        if (!index || isModuleIndexStale) {
+            index = RefreshModuleIndex(index);
+        }
+        const ModuleRange* module = index->Find((uintptr_t)returnAddress);
+        if (!module) {
+            // The caller may have been loaded since, and we may not be notified of it.
+            index = RefreshModuleIndex(index);
+            module = index->Find((uintptr_t)returnAddress);
+        }
+        return module && module->isTarget;
     }
 
 } // namespace driver_shim
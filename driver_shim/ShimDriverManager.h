@@ -21,10 +21,14 @@
 // SOFTWARE.
 
 #pragma once
-#include <intrin.h>
 #include <openvr_driver.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
 #pragma intrinsic(_ReturnAddress)
+#else
+#define _ReturnAddress() __builtin_return_address(0)
+#endif
 
 namespace driver_shim {
 
@@ -32,7 +36,18 @@ namespace driver_shim {
     bool IsTargetDriver(void* returnAddress);
 
     vr::ITrackedDeviceServerDriver* CreateHmdShimDriver(vr::ITrackedDeviceServerDriver* shimmedDriver,
-                                                        vr::IVRServerDriverHost* driverHost);
+                                                        vr::IVRServerDriverHost* driverHost,
+                                                        const char* serialNumber);
+
+    // For controllers and trackers (the shim_controllers_and_trackers setting).
+    vr::ITrackedDeviceServerDriver* CreateTrackedDeviceShimDriver(vr::ITrackedDeviceServerDriver* shimmedDriver,
+                                                                  vr::ETrackedDeviceClass deviceClass);
+
+    // For all the active shim devices, or only one.
     void ApplySettingsChanges();
+    void ApplySettingsChanges(vr::TrackedDeviceIndex_t deviceIndex);
+
+    // Once vrserver no longer calls the shim devices.
+    void DestroyShimDrivers();
 
 } // namespace driver_shim
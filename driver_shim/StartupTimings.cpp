@@ -0,0 +1,121 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "StartupTimings.h"
+#include "Tracing.h"
+
+namespace {
+    using namespace driver_shim;
+
+    struct PhaseInfo {
+        const char* name;
+        double budgetMs;
+    };
+
+    const PhaseInfo phases[(size_t)StartupPhase::Count] = {
+        {"HmdDriverFactory", 1.0},
+        {"DriverInit", 5.0},
+        {"InstallHook", 2.0},
+        {"TrackedDeviceAdded", 0.0},
+        {"CreateShimDevice", 1.0},
+        {"Activate", 0.0},
+        {"VendorActivate", 0.0},
+        {"VendorTable", 0.0},
+        {"ReadSettings", 5.0},
+        {"BakePipeline", 0.0},
+        {"HiddenArea", 2.0},
+    };
+
+    struct PhaseTiming {
+        std::atomic<int64_t> durationNs{0};
+        std::atomic<uint64_t> count{0};
+    };
+
+    PhaseTiming timings[(size_t)StartupPhase::Count];
+
+} // namespace
+
+namespace driver_shim {
+
+    ScopedStartupPhase::ScopedStartupPhase(StartupPhase phase)
+        : m_phase(phase), m_start(std::chrono::steady_clock::now()) {
+    }
+
+    ScopedStartupPhase::~ScopedStartupPhase() {
+        const int64_t durationNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        PhaseTiming& timing = timings[(size_t)m_phase];
+        timing.durationNs = durationNs;
+        timing.count++;
+
+        const PhaseInfo& info = phases[(size_t)m_phase];
+        TraceLoggingWrite(TraceProvider,
+                          "StartupPhase",
+                          TLArg(info.name, "Phase"),
+                          TLArg(durationNs / 1e6, "DurationMs"),
+                          TLArg(info.budgetMs, "BudgetMs"));
+    }
+
+    StartupPhaseTiming GetStartupPhaseTiming(StartupPhase phase) {
+        const PhaseInfo& info = phases[(size_t)phase];
+        const PhaseTiming& timing = timings[(size_t)phase];
+        return {info.name, timing.durationNs / 1e6, info.budgetMs, timing.count};
+    }
+
+    std::string FormatStartupTimings() {
+        std::string result;
+        for (size_t i = 0; i < (size_t)StartupPhase::Count; i++) {
+            const StartupPhaseTiming timing = GetStartupPhaseTiming((StartupPhase)i);
+            char line[128];
+            snprintf(line,
+                     sizeof(line),
+                     "%s %.6f %.3f %llu%s\n",
+                     timing.name,
+                     timing.durationMs,
+                     timing.budgetMs,
+                     (unsigned long long)timing.count,
+                     timing.IsOverBudget() ? " over_budget" : "");
+            result += line;
+        }
+        return result;
+    }
+
+    void LogStartupTimings() {
+        for (size_t i = 0; i < (size_t)StartupPhase::Count; i++) {
+            const StartupPhaseTiming timing = GetStartupPhaseTiming((StartupPhase)i);
+            if (!timing.count) {
+                continue;
+            }
+            if (timing.IsOverBudget()) {
+                DriverLog("Startup %s: %.3f ms, OVER BUDGET of %.3f ms",
+                          timing.name,
+                          timing.durationMs,
+                          timing.budgetMs);
+            } else {
+                DriverLog("Startup %s: %.3f ms", timing.name, timing.durationMs);
+            }
+        }
+    }
+
+} // namespace driver_shim
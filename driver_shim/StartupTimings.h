@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace driver_shim {
+
+    // The phases of the startup path, from vrserver loading the shim to the HMD being activated. Some phases contain
+    // others, eg: TrackedDeviceAdded contains the whole activation.
+    enum class StartupPhase : uint32_t {
+        HmdDriverFactory,
+        DriverInit,
+        InstallHook,
+        TrackedDeviceAdded,
+        CreateShimDevice,
+        Activate,
+        VendorActivate,
+        VendorTable,
+        ReadSettings,
+        BakePipeline,
+        HiddenArea,
+
+        Count
+    };
+
+    // Measure a startup phase, from construction to destruction. The duration of the last occurrence is kept, and
+    // written to the traces. Only construct it on the startup path: the same code running later (eg: a rebake upon a
+    // settings change) would replace the startup timing.
+    class ScopedStartupPhase {
+      public:
+        explicit ScopedStartupPhase(StartupPhase phase);
+        ~ScopedStartupPhase();
+
+      private:
+        const StartupPhase m_phase;
+        const std::chrono::steady_clock::time_point m_start;
+    };
+
+    struct StartupPhaseTiming {
+        const char* name;
+        double durationMs;
+
+        // Only for the phases under our control (ie: not including the runtime or the vendor driver). Zero otherwise.
+        double budgetMs;
+
+        uint64_t count;
+
+        bool IsOverBudget() const {
+            return budgetMs > 0.0 && durationMs > budgetMs;
+        }
+    };
+
+    StartupPhaseTiming GetStartupPhaseTiming(StartupPhase phase);
+
+    // One line per phase: "<phase> <duration ms> <budget ms> <count> [over_budget]".
+    std::string FormatStartupTimings();
+    void LogStartupTimings();
+
+} // namespace driver_shim
@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "TraceRecorder.h"
+
+namespace {
+
+    // Hand the buffer to the writer thread once this much is buffered.
+    constexpr size_t FlushThreshold = 1024 * 1024;
+
+} // namespace
+
+namespace driver_shim {
+
+    std::unique_ptr<TraceRecorder> TraceRecorder::Create(const std::string& path) {
+        std::unique_ptr<TraceRecorder> recorder(new TraceRecorder());
+        recorder->m_file.open(path, std::ios::binary | std::ios::trunc);
+        if (!recorder->m_file) {
+            return nullptr;
+        }
+        recorder->m_buffer.reserve(FlushThreshold + 256);
+        recorder->m_pending.reserve(FlushThreshold + 256);
+        recorder->Append(&trace::Magic, sizeof(trace::Magic));
+        recorder->Append(&trace::Version, sizeof(trace::Version));
+        recorder->m_writer = std::thread(&TraceRecorder::WriterThread, recorder.get());
+        return recorder;
+    }
+
+    TraceRecorder::~TraceRecorder() {
+        Flush();
+        {
+            std::unique_lock lock(m_mutex);
+            m_isStopping = true;
+        }
+        m_wakeWriter.notify_one();
+        m_writer.join();
+    }
+
+    void TraceRecorder::Display(vr::EVREye eye,
+                                uint32_t x,
+                                uint32_t y,
+                                uint32_t width,
+                                uint32_t height,
+                                float left,
+                                float right,
+                                float top,
+                                float bottom) {
+        Write(trace::Opcode::Display, (uint8_t)eye, x, y, width, height, left, right, top, bottom);
+    }
+
+    void TraceRecorder::RenderTargetSize(uint32_t width, uint32_t height) {
+        Write(trace::Opcode::RenderTargetSize, width, height);
+    }
+
+    void TraceRecorder::Setting(const char* key, float value) {
+        const size_t length = std::min(strlen(key), (size_t)UINT8_MAX);
+
+        std::unique_lock lock(m_mutex);
+        const uint8_t header[] = {(uint8_t)trace::Opcode::Setting, (uint8_t)length};
+        Append(header, sizeof(header));
+        Append(key, length);
+        Append(&value, sizeof(value));
+    }
+
+    void TraceRecorder::Setting(const char* key, const char* value) {
+        const size_t keyLength = std::min(strlen(key), (size_t)UINT8_MAX);
+        const uint16_t valueLength = (uint16_t)std::min(strlen(value), (size_t)UINT16_MAX);
+
+        std::unique_lock lock(m_mutex);
+        const uint8_t header[] = {(uint8_t)trace::Opcode::StringSetting, (uint8_t)keyLength};
+        Append(header, sizeof(header));
+        Append(key, keyLength);
+        Append(&valueLength, sizeof(valueLength));
+        Append(value, valueLength);
+    }
+
+    void TraceRecorder::SettingsChanged() {
+        Write(trace::Opcode::SettingsChanged);
+    }
+
+    void TraceRecorder::GetRecommendedRenderTargetSize(uint32_t width, uint32_t height) {
+        Write(trace::Opcode::GetRecommendedRenderTargetSize, width, height);
+    }
+
+    void TraceRecorder::GetEyeOutputViewport(vr::EVREye eye, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        Write(trace::Opcode::GetEyeOutputViewport, (uint8_t)eye, x, y, width, height);
+    }
+
+    void TraceRecorder::GetProjectionRaw(vr::EVREye eye, float left, float right, float top, float bottom) {
+        Write(trace::Opcode::GetProjectionRaw, (uint8_t)eye, left, right, top, bottom);
+    }
+
+    void TraceRecorder::ComputeDistortion(vr::EVREye eye, float u, float v, const vr::DistortionCoordinates_t& result) {
+        Write(trace::Opcode::ComputeDistortion,
+              (uint8_t)eye,
+              u,
+              v,
+              result.rfRed[0],
+              result.rfRed[1],
+              result.rfGreen[0],
+              result.rfGreen[1],
+              result.rfBlue[0],
+              result.rfBlue[1]);
+    }
+
+    void TraceRecorder::Flush() {
+        std::unique_lock lock(m_mutex);
+        m_pending.insert(m_pending.end(), m_buffer.cbegin(), m_buffer.cend());
+        m_buffer.clear();
+        m_wakeWriter.notify_one();
+
+        // The writer thread is idle once it returns, and it cannot resume while we hold the lock.
+        m_written.wait(lock, [&] { return m_pending.empty() && !m_isWriting; });
+        m_file.flush();
+    }
+
+    template <typename... Args>
+    void TraceRecorder::Write(trace::Opcode opcode, const Args&... fields) {
+        std::unique_lock lock(m_mutex);
+        Append(&opcode, sizeof(opcode));
+        (Append(&fields, sizeof(fields)), ...);
+
+        // When the writer thread is behind, keep appending rather than waiting for it.
+        if (m_buffer.size() >= FlushThreshold && m_pending.empty()) {
+            std::swap(m_buffer, m_pending);
+            m_wakeWriter.notify_one();
+        }
+    }
+
+    void TraceRecorder::Append(const void* data, size_t size) {
+        const uint8_t* const bytes = (const uint8_t*)data;
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    void TraceRecorder::WriterThread() {
+        // The buffers are swapped around, so that they keep their capacity.
+        Buffer writing;
+
+        std::unique_lock lock(m_mutex);
+        while (true) {
+            m_wakeWriter.wait(lock, [&] { return !m_pending.empty() || m_isStopping; });
+            if (m_pending.empty()) {
+                return;
+            }
+            std::swap(writing, m_pending);
+            m_isWriting = true;
+
+            lock.unlock();
+            m_file.write((const char*)writing.data(), writing.size());
+            writing.clear();
+            lock.lock();
+
+            m_isWriting = false;
+            m_written.notify_all();
+        }
+    }
+
+} // namespace driver_shim
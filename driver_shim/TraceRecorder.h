@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <openvr_driver.h>
+
+#include "MemoryAccounting.h"
+
+namespace driver_shim {
+
+    // Binary trace of the display component calls received by the shim, so that real sessions can be replayed
+    // offline (see the shim_host replay command).
+    //
+    // The file starts with the magic and version (uint32_t each), followed by records. Each record is one opcode byte
+    // followed by its fields, packed in little-endian.
+    namespace trace {
+
+        constexpr uint32_t Magic = 0x52545344; // "DSTR"
+        constexpr uint32_t Version = 2;
+
+        enum class Opcode : uint8_t {
+            // The vendor display at activation: eye (uint8_t), viewport x, y, width, height (uint32_t), projection
+            // left, right, top, bottom (float).
+            Display = 1,
+
+            // The vendor render target size at activation: width, height (uint32_t).
+            RenderTargetSize = 2,
+
+            // A distortion setting read by the shim: key length (uint8_t), key, value (float).
+            Setting = 3,
+
+            // The shim received VREvent_AnyDriverSettingsChanged. The settings that were read follow.
+            SettingsChanged = 4,
+
+            // Calls, with their results: width, height (uint32_t).
+            GetRecommendedRenderTargetSize = 5,
+
+            // eye (uint8_t), x, y, width, height (uint32_t).
+            GetEyeOutputViewport = 6,
+
+            // eye (uint8_t), left, right, top, bottom (float).
+            GetProjectionRaw = 7,
+
+            // eye (uint8_t), u, v (float), red, green, blue UVs (6 float).
+            ComputeDistortion = 8,
+
+            // A string setting read by the shim (since version 2): key length (uint8_t), key, value length (uint16_t),
+            // value.
+            StringSetting = 9,
+        };
+
+    } // namespace trace
+
+    // Appends records to a trace file. Calls may come from several threads; records are buffered, and the full
+    // buffers are written by a writer thread, so that the calling threads (eg: the compositor in ComputeDistortion())
+    // never wait on the file.
+    class TraceRecorder : public TaggedObject<MemoryTag::Traces> {
+      public:
+        // Returns nullptr if the file cannot be created.
+        static std::unique_ptr<TraceRecorder> Create(const std::string& path);
+
+        ~TraceRecorder();
+
+        void Display(vr::EVREye eye,
+                     uint32_t x,
+                     uint32_t y,
+                     uint32_t width,
+                     uint32_t height,
+                     float left,
+                     float right,
+                     float top,
+                     float bottom);
+        void RenderTargetSize(uint32_t width, uint32_t height);
+        void Setting(const char* key, float value);
+        void Setting(const char* key, const char* value);
+        void SettingsChanged();
+        void GetRecommendedRenderTargetSize(uint32_t width, uint32_t height);
+        void GetEyeOutputViewport(vr::EVREye eye, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+        void GetProjectionRaw(vr::EVREye eye, float left, float right, float top, float bottom);
+        void ComputeDistortion(vr::EVREye eye, float u, float v, const vr::DistortionCoordinates_t& result);
+
+        // Write all the records so far to the file, and wait for it.
+        void Flush();
+
+      private:
+        using Buffer = TaggedVector<uint8_t, MemoryTag::Traces>;
+
+        TraceRecorder() = default;
+
+        template <typename... Args>
+        void Write(trace::Opcode opcode, const Args&... fields);
+        void Append(const void* data, size_t size);
+        void WriterThread();
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeWriter;
+        std::condition_variable m_written;
+
+        // Only accessed by the writer thread, or under m_mutex while the writer thread is idle.
+        std::ofstream m_file;
+
+        // The records being appended, and the full buffer waiting for the writer thread.
+        Buffer m_buffer;
+        Buffer m_pending;
+        bool m_isWriting = false;
+        bool m_isStopping = false;
+
+        std::thread m_writer;
+    };
+
+} // namespace driver_shim
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#ifndef DRIVER_SHIM_PORTABLE
+
 TRACELOGGING_DECLARE_PROVIDER(TraceProvider);
 
 #define IsTraceEnabled() TraceLoggingProviderEnabled(TraceProvider, 0, 0)
@@ -30,3 +32,21 @@ TRACELOGGING_DECLARE_PROVIDER(TraceProvider);
 
 #define TLArg(var, ...) TraceLoggingValue(var, ##__VA_ARGS__)
 #define TLPArg(var, ...) TraceLoggingPointer(var, ##__VA_ARGS__)
+
+#else
+
+// TraceLogging is only available on Windows. The trace points compile to nothing and their arguments are never
+// evaluated.
+#define IsTraceEnabled() false
+
+#define TraceLocalActivity(activity) [[maybe_unused]] int activity = 0;
+
+#define TraceLoggingWrite(provider, ...) ((void)0)
+#define TraceLoggingWriteStart(activity, ...) ((void)(activity))
+#define TraceLoggingWriteStop(activity, ...) ((void)(activity))
+#define TraceLoggingWriteTagged(activity, ...) ((void)(activity))
+
+#define TLArg(var, ...)
+#define TLPArg(var, ...)
+
+#endif
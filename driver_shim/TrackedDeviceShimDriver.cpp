@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "ShimDriverManager.h"
+#include "DeviceRegistry.h"
+#include "ForwardingDriver.h"
+#include "MemoryAccounting.h"
+#include "Tracing.h"
+
+namespace {
+    using namespace driver_shim;
+
+    // The TrackedDeviceShimDriver driver wraps a controller or a tracker. The methods that are not overridden here are
+    // forwarded as-is.
+    struct TrackedDeviceShimDriver : public ForwardingDeviceDriver<TrackedDeviceShimDriver>,
+                                     ShimDevice,
+                                     TaggedObject<MemoryTag::DriverObjects> {
+        TrackedDeviceShimDriver(vr::ITrackedDeviceServerDriver* shimmedDevice, vr::ETrackedDeviceClass deviceClass)
+            : ForwardingDeviceDriver(shimmedDevice), m_deviceClass(deviceClass) {
+        }
+
+        vr::EVRInitError Activate(uint32_t unObjectId) override {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "TrackedDeviceShimDriver_Activate",
+                                   TLArg(unObjectId, "ObjectId"),
+                                   TLArg((int)m_deviceClass, "DeviceClass"));
+
+            const auto status = m_shimmedDevice->Activate(unObjectId);
+
+            // Receive the settings changes from now on.
+            if (status == vr::VRInitError_None) {
+                GetDeviceRegistry().SetActive(this, unObjectId);
+            }
+
+            TraceLoggingWriteStop(local, "TrackedDeviceShimDriver_Activate", TLArg((int)status, "Status"));
+
+            return status;
+        }
+
+        void Deactivate() override {
+            GetDeviceRegistry().SetInactive(this);
+            m_shimmedDevice->Deactivate();
+        }
+
+        void ApplySettingsChanges() override {
+            // No setting applies to controllers and trackers yet.
+        }
+
+        const vr::ETrackedDeviceClass m_deviceClass;
+    };
+
+} // namespace
+
+namespace driver_shim {
+
+    vr::ITrackedDeviceServerDriver* CreateTrackedDeviceShimDriver(vr::ITrackedDeviceServerDriver* shimmedDriver,
+                                                                  vr::ETrackedDeviceClass deviceClass) {
+        const std::shared_ptr<TrackedDeviceShimDriver> driver(new TrackedDeviceShimDriver(shimmedDriver, deviceClass));
+        GetDeviceRegistry().Add(driver, driver.get());
+        return driver.get();
+    }
+
+} // namespace driver_shim
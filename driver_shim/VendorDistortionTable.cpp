@@ -0,0 +1,156 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "VendorDistortionTable.h"
+
+namespace {
+
+    // Keep the serial number usable as a file name.
+    std::string SanitizeFileName(const std::string& name) {
+        std::string result = name.empty() ? "unknown" : name;
+        for (char& c : result) {
+            if (!isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') {
+                c = '_';
+            }
+        }
+        return result;
+    }
+
+} // namespace
+
+namespace driver_shim {
+
+    VendorDistortionTable::DisplayDescription
+    VendorDistortionTable::DisplayDescription::FromDisplay(vr::IVRDisplayComponent* display, uint32_t resolution) {
+        DisplayDescription description{};
+        description.resolution = resolution;
+        for (const vr::EVREye eye : {vr::Eye_Left, vr::Eye_Right}) {
+            uint32_t x, y;
+            display->GetEyeOutputViewport(eye, &x, &y, &description.width[eye], &description.height[eye]);
+            display->GetProjectionRaw(eye,
+                                      &description.projection[eye][0],
+                                      &description.projection[eye][1],
+                                      &description.projection[eye][2],
+                                      &description.projection[eye][3]);
+        }
+        return description;
+    }
+
+    bool VendorDistortionTable::DisplayDescription::operator==(const DisplayDescription& other) const {
+        return !memcmp(this, &other, sizeof(*this));
+    }
+
+    std::unique_ptr<VendorDistortionTable> VendorDistortionTable::LoadOrCapture(vr::IVRDisplayComponent* display,
+                                                                                const std::string& serialNumber,
+                                                                                const std::string& cacheDirectory,
+                                                                                uint32_t resolution) {
+        const std::string path = GetCachePath(cacheDirectory, serialNumber);
+        std::unique_ptr<VendorDistortionTable> table = Load(path, display, resolution);
+        if (table) {
+            DriverLog("Loaded the vendor distortion of %s from %s", serialNumber.c_str(), path.c_str());
+            return table;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        table = Capture(display, resolution);
+        DriverLog("Sampled the vendor distortion of %s (%ux%u per eye and channel) in %.1f ms",
+                  serialNumber.c_str(),
+                  table->Resolution(),
+                  table->Resolution(),
+                  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        if (!table->Save(path)) {
+            DriverLog("Failed to write the vendor distortion cache: %s", path.c_str());
+        }
+        return table;
+    }
+
+    std::unique_ptr<VendorDistortionTable> VendorDistortionTable::Capture(vr::IVRDisplayComponent* display,
+                                                                          uint32_t resolution) {
+        std::unique_ptr<VendorDistortionTable> table(new VendorDistortionTable());
+        table->m_display = DisplayDescription::FromDisplay(display, std::max(resolution, 2u));
+        table->Fill(table->m_display.resolution,
+                    [display](vr::EVREye eye, float u, float v) { return display->ComputeDistortion(eye, u, v); },
+                    1);
+        return table;
+    }
+
+    std::unique_ptr<VendorDistortionTable>
+    VendorDistortionTable::Load(const std::string& path, vr::IVRDisplayComponent* display, uint32_t resolution) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return nullptr;
+        }
+
+        uint32_t magic = 0, version = 0;
+        DisplayDescription description{};
+        file.read((char*)&magic, sizeof(magic));
+        file.read((char*)&version, sizeof(version));
+        file.read((char*)&description, sizeof(description));
+        if (!file || magic != Magic || version != Version ||
+            !(description == DisplayDescription::FromDisplay(display, std::max(resolution, 2u)))) {
+            return nullptr;
+        }
+
+        std::unique_ptr<VendorDistortionTable> table(new VendorDistortionTable());
+        table->m_display = description;
+        table->m_resolution = description.resolution;
+        table->m_samples.resize((size_t)2 * 3 * description.resolution * description.resolution * 2);
+        file.read((char*)table->m_samples.data(), table->m_samples.size() * sizeof(float));
+        if (!file) {
+            return nullptr;
+        }
+        return table;
+    }
+
+    bool VendorDistortionTable::Save(const std::string& path) const {
+        // Write aside and rename, so that a concurrent reader never sees a partial file.
+        const std::string temporaryPath = path + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write((const char*)&Magic, sizeof(Magic));
+            file.write((const char*)&Version, sizeof(Version));
+            file.write((const char*)&m_display, sizeof(m_display));
+            file.write((const char*)m_samples.data(), m_samples.size() * sizeof(float));
+            if (!file) {
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        return !error;
+    }
+
+    std::string VendorDistortionTable::GetCachePath(const std::string& cacheDirectory,
+                                                    const std::string& serialNumber) {
+        std::error_code error;
+        const std::filesystem::path directory =
+            cacheDirectory.empty() ? std::filesystem::temp_directory_path(error) / "distortion_shim"
+                                   : std::filesystem::path(cacheDirectory);
+        return (directory / (SanitizeFileName(serialNumber) + ".vendortable")).string();
+    }
+
+} // namespace driver_shim
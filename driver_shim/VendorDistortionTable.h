@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <openvr_driver.h>
+
+#include "DistortionTable.h"
+
+namespace driver_shim {
+
+    // The distortion of the wrapped display component, sampled so that the vendor's ComputeDistortion() is only called
+    // once per device. The table is cached on disk, keyed by the serial number of the device, and it is sampled again
+    // when the display no longer matches.
+    //
+    // The cache file starts with the magic, version, resolution, and the width and height of each eye (uint32_t each),
+    // followed by the projection of each eye (left, right, top, bottom floats), then the samples (see
+    // DistortionTable).
+    class VendorDistortionTable : public DistortionTable {
+      public:
+        static constexpr uint32_t Magic = 0x54565344; // "DSVT"
+        static constexpr uint32_t Version = 1;
+
+        // The cached table for the device if it matches the display, otherwise a new table, written to the cache.
+        // An empty directory selects the temporary directory of the system.
+        static std::unique_ptr<VendorDistortionTable> LoadOrCapture(vr::IVRDisplayComponent* display,
+                                                                    const std::string& serialNumber,
+                                                                    const std::string& cacheDirectory,
+                                                                    uint32_t resolution);
+
+        // Sample the display component, ie: resolution^2 calls to ComputeDistortion() for each eye.
+        static std::unique_ptr<VendorDistortionTable> Capture(vr::IVRDisplayComponent* display, uint32_t resolution);
+
+        // Returns nullptr if the file is missing, invalid, or for another display or resolution.
+        static std::unique_ptr<VendorDistortionTable> Load(const std::string& path,
+                                                           vr::IVRDisplayComponent* display,
+                                                           uint32_t resolution);
+
+        bool Save(const std::string& path) const;
+
+        // The path of the cache file for a device.
+        static std::string GetCachePath(const std::string& cacheDirectory, const std::string& serialNumber);
+
+      private:
+        // What the table was sampled from.
+        struct DisplayDescription {
+            uint32_t resolution;
+            uint32_t width[2];
+            uint32_t height[2];
+            float projection[2][4];
+
+            static DisplayDescription FromDisplay(vr::IVRDisplayComponent* display, uint32_t resolution);
+            bool operator==(const DisplayDescription& other) const;
+        };
+
+        VendorDistortionTable() = default;
+
+        DisplayDescription m_display{};
+    };
+
+} // namespace driver_shim
@@ -24,6 +24,8 @@
 
 #include "Tracing.h"
 
+#ifndef DRIVER_SHIM_PORTABLE
+
 // {15d4b714-f01f-4f5b-9a76-de69f386adea}
 TRACELOGGING_DEFINE_PROVIDER(TraceProvider,
                              "OpenVRDriver",
@@ -44,3 +46,5 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
     }
     return TRUE;
 }
+
+#endif
@@ -22,19 +22,47 @@
 
 #pragma once
 
+// The portable flavor builds the driver sources without Windows-only dependencies (Detours, TraceLogging), for
+// example to run them on Linux against the fake runtime from shim_host.
+#ifndef _WIN32
+#define DRIVER_SHIM_PORTABLE
+#endif
+
+#ifndef DRIVER_SHIM_PORTABLE
 #define WIN32_LEAN_AND_MEAN // Exclude rarely-used stuff from Windows headers
 #include <windows.h>
 #include <TraceLoggingActivity.h>
 #include <TraceLoggingProvider.h>
 #include <wrl.h>
 using Microsoft::WRL::ComPtr;
+#endif
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include <openvr_driver.h>
 #include <driverlog.h>
 
+#ifndef DRIVER_SHIM_PORTABLE
 #include <detours.h>
+#endif
 
 #include <DirectXMath.h>
+#include <DirectXPackedVector.h>
@@ -0,0 +1,302 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Accuracy.h"
+#include "Commands.h"
+#include "ShimHost.h"
+
+#include <random>
+
+namespace {
+    using namespace shim_host;
+
+    const struct {
+        const char* name;
+        const char* description;
+        DistortionFunction (*make)(ShimHost& host);
+
+        // Only checked when requested with --candidate.
+        bool optIn;
+    } candidates[] = {
+        {"shim",
+         "HmdShimDriver::ComputeDistortion()",
+         [](ShimHost& host) -> DistortionFunction {
+             host.ChangeSettings([](FakeSettings& settings) {
+                 settings.SetString("driver_distortion_shim", "pipeline", "");
+             });
+             vr::IVRDisplayComponent* const display = host.Display();
+             return [display](vr::EVREye eye, float u, float v) { return display->ComputeDistortion(eye, u, v); };
+         },
+         false},
+        {"baked",
+         "HmdShimDriver::ComputeDistortion() from the baked pipeline",
+         [](ShimHost& host) -> DistortionFunction {
+             // A pipeline that does not change the model, but that is baked.
+             host.ChangeSettings([](FakeSettings& settings) {
+                 settings.SetString("driver_distortion_shim", "pipeline", "ipd_shift,brown_conrady");
+                 settings.SetFloat("driver_distortion_shim", "ipd_shift", 0.f);
+                 settings.SetFloat("driver_distortion_shim", "quantized_table_max_error", 0.f);
+             });
+             vr::IVRDisplayComponent* const display = host.Display();
+             return [display](vr::EVREye eye, float u, float v) { return display->ComputeDistortion(eye, u, v); };
+         },
+         // The table cannot follow the clamping of the model where it folds over, so profiles that fold over within
+         // the viewport exceed the budget there.
+         true},
+        {"quantized",
+         "HmdShimDriver::ComputeDistortion() from the baked pipeline, quantized",
+         [](ShimHost& host) -> DistortionFunction {
+             host.ChangeSettings([](FakeSettings& settings) {
+                 settings.SetString("driver_distortion_shim", "pipeline", "ipd_shift,brown_conrady");
+                 settings.SetFloat("driver_distortion_shim", "ipd_shift", 0.f);
+                 settings.SetFloat("driver_distortion_shim", "quantized_table_max_error", 0.05f);
+             });
+             vr::IVRDisplayComponent* const display = host.Display();
+             return [display](vr::EVREye eye, float u, float v) { return display->ComputeDistortion(eye, u, v); };
+         },
+         // Like the baked table, within 0.05 display pixels of it.
+         true},
+    };
+
+    void AddPoint(std::vector<AccuracyPoint>& points, double u, double v) {
+        points.push_back({(float)std::clamp(u, 0.0, 1.0), (float)std::clamp(v, 0.0, 1.0)});
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    std::vector<AccuracyPoint> DensePoints(uint32_t n) {
+        n = std::max(2u, n);
+        std::vector<AccuracyPoint> points;
+        points.reserve((size_t)n * n);
+        for (uint32_t y = 0; y < n; y++) {
+            for (uint32_t x = 0; x < n; x++) {
+                points.push_back({(float)x / (n - 1), (float)y / (n - 1)});
+            }
+        }
+        return points;
+    }
+
+    std::vector<AccuracyPoint> AdversarialPoints(const ReferenceDistortion& reference) {
+        std::vector<AccuracyPoint> points;
+
+        // Exact edges and corners, and their closest neighbors.
+        const double specials[] = {0.0,
+                                   std::nextafter(0.f, 1.f),
+                                   1e-7,
+                                   1e-4,
+                                   1.0 / 3.0,
+                                   0.5,
+                                   std::nextafter(0.5f, 1.f),
+                                   2.0 / 3.0,
+                                   1.0 - 1e-4,
+                                   std::nextafter(1.f, 0.f),
+                                   1.0};
+        for (const double u : specials) {
+            for (const double v : specials) {
+                AddPoint(points, u, v);
+            }
+        }
+
+        // Around each center of distortion, where r is tiny.
+        for (int eye = 0; eye < 2; eye++) {
+            const auto& e = reference.GetEye((vr::EVREye)eye);
+            const double width = reference.Geometry().eyeWidth[eye];
+            const double height = reference.Geometry().eyeHeight[eye];
+            for (const auto& channel : e.channels) {
+                for (const double offset : {0.0, 1e-6, 1e-3, 0.5}) {
+                    const double u = channel.codX / width;
+                    const double v = channel.codY / height;
+                    AddPoint(points, u + offset / width, v);
+                    AddPoint(points, u, v - offset / height);
+                    AddPoint(points, u - offset / width, v + offset / height);
+                }
+            }
+        }
+
+        // Across the circle where a channel folds over, when it crosses the viewport.
+        for (int eye = 0; eye < 2; eye++) {
+            const auto& e = reference.GetEye((vr::EVREye)eye);
+            const double width = reference.Geometry().eyeWidth[eye];
+            const double height = reference.Geometry().eyeHeight[eye];
+            for (const auto& channel : e.channels) {
+                if (std::isinf(channel.maxRadius2)) {
+                    continue;
+                }
+                const double radius = std::sqrt(channel.maxRadius2);
+                const double pi = std::acos(-1.0);
+                const int angleSteps = 256;
+                for (int i = 0; i < angleSteps; i++) {
+                    const double angle = 2 * pi * i / angleSteps;
+                    for (const double offset : {-1.0, -1e-3, 0.0, 1e-3, 1.0}) {
+                        const double u = (channel.codX + (radius + offset) * std::cos(angle)) / width;
+                        const double v = (channel.codY + (radius + offset) * std::sin(angle)) / height;
+                        if (u >= 0 && u <= 1 && v >= 0 && v <= 1) {
+                            AddPoint(points, u, v);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Along the borders, where the radius (and the polynomial terms) are the largest.
+        const int borderSteps = 1024;
+        for (int i = 0; i <= borderSteps; i++) {
+            const double t = (double)i / borderSteps;
+            AddPoint(points, t, 0.0);
+            AddPoint(points, t, 1.0);
+            AddPoint(points, 0.0, t);
+            AddPoint(points, 1.0, t);
+        }
+
+        // Fixed seed so that the runs are reproducible.
+        std::mt19937 generator(0x5eed);
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+        for (int i = 0; i < 16384; i++) {
+            const double u = distribution(generator);
+            AddPoint(points, u, distribution(generator));
+        }
+
+        return points;
+    }
+
+    double AccuracyReport::MaxError() const {
+        double maxError = 0.0;
+        for (const auto& eye : stats) {
+            for (const auto& channel : eye) {
+                maxError = std::max(maxError, channel.maxError);
+            }
+        }
+        return maxError;
+    }
+
+    AccuracyReport MeasureAccuracy(const ReferenceDistortion& reference,
+                                   const DistortionFunction& candidate,
+                                   const std::vector<AccuracyPoint>& points) {
+        AccuracyReport report;
+        for (int eye = 0; eye < 2; eye++) {
+            const double width = reference.Geometry().eyeWidth[eye];
+            const double height = reference.Geometry().eyeHeight[eye];
+            for (const AccuracyPoint& point : points) {
+                const ReferenceDistortion::Result expected = reference.Evaluate((vr::EVREye)eye, point.u, point.v);
+                const vr::DistortionCoordinates_t actual = candidate((vr::EVREye)eye, point.u, point.v);
+                const float* const channels[] = {actual.rfRed, actual.rfGreen, actual.rfBlue};
+                for (int channel = 0; channel < 3; channel++) {
+                    const double errorX = (channels[channel][0] - expected.uv[channel][0]) * width;
+                    const double errorY = (channels[channel][1] - expected.uv[channel][1]) * height;
+                    const double error = std::sqrt(errorX * errorX + errorY * errorY);
+
+                    AccuracyStats& stats = report.stats[eye][channel];
+                    // NaN must count as a failure.
+                    if (!(error <= stats.maxError)) {
+                        stats.maxError = std::isnan(error) ? INFINITY : error;
+                        stats.worst = point;
+                    }
+                    stats.sumSquares += error * error;
+                    stats.count++;
+                }
+            }
+        }
+        return report;
+    }
+
+    void PrintAccuracyReport(FILE* out, const std::string& title, const AccuracyReport& report) {
+        fprintf(out, "%s\n", title.c_str());
+        for (int eye = 0; eye < 2; eye++) {
+            for (int channel = 0; channel < 3; channel++) {
+                const AccuracyStats& stats = report.stats[eye][channel];
+                fprintf(out,
+                        "  %-5s %-5s  max %10.6f px  rms %10.6f px  worst at (%.6f, %.6f)\n",
+                        EyeNames[eye],
+                        ChannelNames[channel],
+                        stats.maxError,
+                        stats.Rms(),
+                        stats.worst.u,
+                        stats.worst.v);
+            }
+        }
+    }
+
+    int RunAccuracy(const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+
+        const double budget = args.GetDouble("budget", 0.1);
+        const std::vector<AccuracyPoint> densePoints = DensePoints((uint32_t)args.GetInt("dense", 257));
+        const DisplayGeometry geometry = DisplayGeometry::FromDisplay(&host.Vendor());
+
+        // Either the profile from the settings file, or the standard variants derived from it.
+        const LensProfile baseProfile = LensProfile::FromSettings(&host.Runtime().settings);
+        std::vector<std::pair<std::string, LensProfile>> profiles;
+        if (args.Has("settings-only")) {
+            profiles.emplace_back("settings", baseProfile);
+        } else {
+            profiles = LensProfile::Variants(baseProfile, geometry.eyeWidth[vr::Eye_Left]);
+        }
+
+        std::string defaultCandidates;
+        for (const auto& candidate : candidates) {
+            if (!candidate.optIn) {
+                defaultCandidates += defaultCandidates.empty() ? candidate.name : std::string(",") + candidate.name;
+            }
+        }
+        const auto selectedCandidates = args.GetList("candidate", defaultCandidates);
+
+        bool passed = true;
+        for (const auto& profile : profiles) {
+            host.ChangeSettings([&](FakeSettings& settings) { profile.second.ToSettings(&settings); });
+            const ReferenceDistortion reference(LensProfile::FromSettings(&host.Runtime().settings), geometry);
+            const std::vector<AccuracyPoint> adversarialPoints = AdversarialPoints(reference);
+
+            for (const auto& name : selectedCandidates) {
+                const auto it = std::find_if(std::begin(candidates), std::end(candidates), [&](const auto& candidate) {
+                    return name == candidate.name;
+                });
+                if (it == std::end(candidates)) {
+                    fprintf(stderr, "Unknown candidate: %s\n", name.c_str());
+                    return 1;
+                }
+
+                const DistortionFunction function = it->make(host);
+                for (const auto& pointSet : {std::make_pair("dense", &densePoints),
+                                             std::make_pair("adversarial", &adversarialPoints)}) {
+                    const AccuracyReport report = MeasureAccuracy(reference, function, *pointSet.second);
+                    const bool withinBudget = report.MaxError() <= budget;
+                    passed = passed && withinBudget;
+                    PrintAccuracyReport(stdout,
+                                        name + " (" + it->description + "), profile " + profile.first + ", " +
+                                            pointSet.first + " points: " + (withinBudget ? "PASS" : "FAIL"),
+                                        report);
+                }
+            }
+        }
+
+        printf("%s (budget %.4f display pixels)\n", passed ? "PASSED" : "FAILED", budget);
+        return passed ? 0 : 1;
+    }
+
+} // namespace shim_host
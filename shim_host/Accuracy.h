@@ -0,0 +1,69 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "ReferenceDistortion.h"
+
+namespace shim_host {
+
+    using DistortionFunction = std::function<vr::DistortionCoordinates_t(vr::EVREye eye, float u, float v)>;
+
+    struct AccuracyPoint {
+        float u;
+        float v;
+    };
+
+    // A regular n x n grid covering [0, 1], edges included.
+    std::vector<AccuracyPoint> DensePoints(uint32_t n);
+
+    // Points where fast paths tend to break: exact edges and corners, values next to 0 and 1, around each center of
+    // distortion, along the borders, plus a fixed-seed random set.
+    std::vector<AccuracyPoint> AdversarialPoints(const ReferenceDistortion& reference);
+
+    struct AccuracyStats {
+        double maxError = 0.0;
+        double sumSquares = 0.0;
+        uint64_t count = 0;
+        AccuracyPoint worst{};
+
+        double Rms() const {
+            return count ? std::sqrt(sumSquares / count) : 0.0;
+        }
+    };
+
+    // Errors in display pixels, per eye and channel.
+    struct AccuracyReport {
+        AccuracyStats stats[2][3];
+
+        double MaxError() const;
+    };
+
+    // Compare a candidate against the reference. The error of each output UV is scaled by the eye viewport, giving
+    // the distance in display pixels.
+    AccuracyReport MeasureAccuracy(const ReferenceDistortion& reference,
+                                   const DistortionFunction& candidate,
+                                   const std::vector<AccuracyPoint>& points);
+
+    void PrintAccuracyReport(FILE* out, const std::string& title, const AccuracyReport& report);
+
+} // namespace shim_host
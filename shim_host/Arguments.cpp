@@ -0,0 +1,81 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Arguments.h"
+
+namespace shim_host {
+
+    Arguments::Arguments(int argc, const char* const* argv) {
+        for (int i = 0; i < argc; i++) {
+            const std::string_view arg(argv[i]);
+            if (arg.size() > 2 && arg.substr(0, 2) == "--") {
+                const std::string name(arg.substr(2));
+                if (i + 1 < argc && strncmp(argv[i + 1], "--", 2)) {
+                    m_named[name] = argv[++i];
+                } else {
+                    m_named[name] = "true";
+                }
+            } else {
+                m_positional.emplace_back(arg);
+            }
+        }
+    }
+
+    bool Arguments::Has(const std::string& name) const {
+        return m_named.count(name) != 0;
+    }
+
+    std::string Arguments::Get(const std::string& name, const std::string& defaultValue) const {
+        auto it = m_named.find(name);
+        return it != m_named.end() ? it->second : defaultValue;
+    }
+
+    int64_t Arguments::GetInt(const std::string& name, int64_t defaultValue) const {
+        auto it = m_named.find(name);
+        return it != m_named.end() ? strtoll(it->second.c_str(), nullptr, 0) : defaultValue;
+    }
+
+    double Arguments::GetDouble(const std::string& name, double defaultValue) const {
+        auto it = m_named.find(name);
+        return it != m_named.end() ? strtod(it->second.c_str(), nullptr) : defaultValue;
+    }
+
+    std::vector<std::string> Arguments::GetList(const std::string& name, const std::string& defaultValue) const {
+        const std::string value = Get(name, defaultValue);
+        std::vector<std::string> list;
+        size_t start = 0;
+        while (start < value.size()) {
+            size_t end = value.find(',', start);
+            if (end == std::string::npos) {
+                end = value.size();
+            }
+            if (end > start) {
+                list.push_back(value.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        return list;
+    }
+
+} // namespace shim_host
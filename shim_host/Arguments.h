@@ -0,0 +1,49 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace shim_host {
+
+    // Command line arguments, in the form: <command> [positional...] [--name value] [--flag].
+    class Arguments {
+      public:
+        Arguments(int argc, const char* const* argv);
+
+        bool Has(const std::string& name) const;
+        std::string Get(const std::string& name, const std::string& defaultValue = "") const;
+        int64_t GetInt(const std::string& name, int64_t defaultValue) const;
+        double GetDouble(const std::string& name, double defaultValue) const;
+
+        // Comma-separated list, eg: --sizes 16,32,64.
+        std::vector<std::string> GetList(const std::string& name, const std::string& defaultValue = "") const;
+
+        const std::vector<std::string>& Positional() const {
+            return m_positional;
+        }
+
+      private:
+        std::map<std::string, std::string> m_named;
+        std::vector<std::string> m_positional;
+    };
+
+} // namespace shim_host
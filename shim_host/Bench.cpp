@@ -0,0 +1,81 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "Commands.h"
+#include "History.h"
+
+namespace {
+    using namespace shim_host;
+
+    const struct {
+        const char* name;
+        void (*run)(BenchmarkRunner& runner, const Arguments& args);
+    } suites[] = {
+        // First, to measure the first load of the shim.
+        {"startup", RunStartupBenchmarks},
+        {"distortion", RunDistortionBenchmarks},
+        {"settings", RunSettingsBenchmarks},
+        {"compositor", RunCompositorBenchmarks},
+        {"memory", RunMemoryBenchmarks},
+        {"forwarding", RunForwardingBenchmarks},
+    };
+
+} // namespace
+
+namespace shim_host {
+
+    int RunBench(const Arguments& args) {
+        BenchmarkRunner runner(BenchmarkRunner::OptionsFromArguments(args));
+
+        std::string allSuites;
+        for (const auto& suite : suites) {
+            allSuites += allSuites.empty() ? suite.name : std::string(",") + suite.name;
+        }
+        for (const auto& name : args.GetList("suite", allSuites)) {
+            const auto it = std::find_if(
+                std::begin(suites), std::end(suites), [&](const auto& suite) { return name == suite.name; });
+            if (it == std::end(suites)) {
+                fprintf(stderr, "Unknown benchmark suite: %s\n", name.c_str());
+                return 1;
+            }
+            it->run(runner, args);
+        }
+
+        const std::string jsonPath = args.Get("json");
+        if (!jsonPath.empty() && !runner.WriteJson(jsonPath)) {
+            fprintf(stderr, "Failed to write %s\n", jsonPath.c_str());
+            return 1;
+        }
+
+        const std::string historyPath = args.Get("history");
+        if (!historyPath.empty() && !AppendHistory(historyPath, args.Get("label", "run"), runner.Results())) {
+            fprintf(stderr, "Failed to append to %s\n", historyPath.c_str());
+            return 1;
+        }
+
+        return 0;
+    }
+
+} // namespace shim_host
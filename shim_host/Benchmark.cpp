@@ -0,0 +1,413 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+    using namespace shim_host;
+
+    double ThreadCpuTimeNs() {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+        const uint64_t total = ((uint64_t)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime) +
+                               ((uint64_t)user.dwHighDateTime << 32 | user.dwLowDateTime);
+        return total * 100.0;
+#else
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+#endif
+    }
+
+    std::string JsonEscape(const std::string& value) {
+        std::string escaped;
+        for (const char c : value) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    std::string HostName() {
+#ifdef _WIN32
+        const char* name = getenv("COMPUTERNAME");
+        return name ? name : "";
+#else
+        char name[256] = {};
+        gethostname(name, sizeof(name) - 1);
+        return name;
+#endif
+    }
+
+    // Hardware cache counters for the calling thread. Only available on Linux (perf_event_open), and only when the
+    // kernel lets us (see /proc/sys/kernel/perf_event_paranoid).
+    struct BenchmarkRunner::PerfCounters {
+        struct Counter {
+            const char* name;
+            int fd;
+        };
+        std::vector<Counter> counters;
+
+        PerfCounters() {
+#ifdef __linux__
+            const struct {
+                const char* name;
+                uint32_t type;
+                uint64_t config;
+            } events[] = {
+                {"cache_references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+                {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+                {"l1d_read_misses",
+                 PERF_TYPE_HW_CACHE,
+                 PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            };
+            for (const auto& event : events) {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = event.type;
+                attr.config = event.config;
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                const int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+                if (fd >= 0) {
+                    counters.push_back({event.name, fd});
+                }
+            }
+#endif
+        }
+
+        ~PerfCounters() {
+#ifdef __linux__
+            for (const auto& counter : counters) {
+                close(counter.fd);
+            }
+#endif
+        }
+
+        void Start() {
+#ifdef __linux__
+            for (const auto& counter : counters) {
+                ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        std::vector<uint64_t> Stop() {
+            std::vector<uint64_t> values;
+#ifdef __linux__
+            for (const auto& counter : counters) {
+                ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+                uint64_t value = 0;
+                if (read(counter.fd, &value, sizeof(value)) != sizeof(value)) {
+                    value = 0;
+                }
+                values.push_back(value);
+            }
+#endif
+            return values;
+        }
+    };
+
+    BenchmarkRunner::Options BenchmarkRunner::OptionsFromArguments(const Arguments& args) {
+        Options options;
+        options.filter = args.Get("filter");
+        options.repetitions = std::max(1, (int)args.GetInt("repetitions", options.repetitions));
+        options.minTimeSeconds = args.GetDouble("min-time", options.minTimeSeconds);
+        options.hardwareCounters = !args.Has("no-counters");
+        return options;
+    }
+
+    BenchmarkRunner::BenchmarkRunner(const Options& options) : m_options(options) {
+        if (m_options.hardwareCounters) {
+            m_perfCounters = std::make_unique<PerfCounters>();
+        }
+    }
+
+    BenchmarkRunner::~BenchmarkRunner() = default;
+
+    bool BenchmarkRunner::Matches(const std::string& name) const {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+    }
+
+    void BenchmarkRunner::Run(const std::string& name,
+                              double itemsPerIteration,
+                              const std::function<void(uint64_t iterations)>& body) {
+        if (!Matches(name)) {
+            return;
+        }
+
+        // Calibrate the number of iterations, like google-benchmark: grow until the minimum time is reached.
+        uint64_t iterations = 1;
+        while (true) {
+            const auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= m_options.minTimeSeconds || iterations >= (1ull << 40)) {
+                break;
+            }
+            const double multiplier = elapsed > 0 ? std::min(10.0, 1.4 * m_options.minTimeSeconds / elapsed) : 10.0;
+            iterations = std::max(iterations + 1, (uint64_t)(iterations * multiplier));
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.itemsPerIteration = itemsPerIteration;
+        for (int repetition = 0; repetition < m_options.repetitions; repetition++) {
+            if (m_perfCounters) {
+                m_perfCounters->Start();
+            }
+            const double cpuStart = ThreadCpuTimeNs();
+            const auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            const auto end = std::chrono::steady_clock::now();
+            const double cpuEnd = ThreadCpuTimeNs();
+
+            result.realTimeNs.push_back(std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+            result.cpuTimeNs.push_back((cpuEnd - cpuStart) / iterations);
+            if (m_perfCounters) {
+                const auto values = m_perfCounters->Stop();
+                for (size_t i = 0; i < values.size(); i++) {
+                    result.counters[std::string(m_perfCounters->counters[i].name) + "_per_item"].push_back(
+                        values[i] / (iterations * itemsPerIteration));
+                }
+            }
+        }
+
+        PrintResults(stdout, result);
+        m_results.push_back(std::move(result));
+    }
+
+    void BenchmarkRunner::Record(BenchmarkResult result) {
+        if (!Matches(result.name)) {
+            return;
+        }
+        PrintResults(stdout, result);
+        m_results.push_back(std::move(result));
+    }
+
+    void BenchmarkRunner::PrintResults(FILE* out, const BenchmarkResult& result) const {
+        const double realTime = Median(result.realTimeNs);
+        fprintf(out,
+                "%-48s %12.0f ns %10.2f ns/item %12.3f Mitems/s",
+                result.name.c_str(),
+                realTime,
+                realTime / result.itemsPerIteration,
+                result.itemsPerIteration / realTime * 1e3);
+        for (const auto& [name, values] : result.counters) {
+            fprintf(out, "  %s=%.3f", name.c_str(), Median(values));
+        }
+        fprintf(out, "\n");
+        fflush(out);
+    }
+
+    bool BenchmarkRunner::WriteJson(const std::string& path) const {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file) {
+            return false;
+        }
+
+        const std::time_t now = std::time(nullptr);
+        char date[64];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        fprintf(file, "{\n  \"context\": {\n");
+        fprintf(file, "    \"date\": \"%s\",\n", date);
+        fprintf(file, "    \"host_name\": \"%s\",\n", JsonEscape(HostName()).c_str());
+        fprintf(file, "    \"executable\": \"shim_host\",\n");
+        fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#ifdef NDEBUG
+        fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+        fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+        fprintf(file, "  },\n  \"benchmarks\": [");
+
+        bool first = true;
+        const auto WriteEntry = [&](const BenchmarkResult& result,
+                                    const char* runType,
+                                    const std::string& suffix,
+                                    int repetitionIndex,
+                                    const std::function<double(const std::vector<double>&)>& select) {
+            const double realTime = select(result.realTimeNs);
+            fprintf(file, "%s\n    {\n", first ? "" : ",");
+            first = false;
+            fprintf(file, "      \"name\": \"%s%s\",\n", JsonEscape(result.name).c_str(), suffix.c_str());
+            fprintf(file, "      \"run_name\": \"%s\",\n", JsonEscape(result.name).c_str());
+            fprintf(file, "      \"run_type\": \"%s\",\n", runType);
+            fprintf(file, "      \"repetitions\": %zu,\n", result.realTimeNs.size());
+            if (repetitionIndex >= 0) {
+                fprintf(file, "      \"repetition_index\": %d,\n", repetitionIndex);
+            } else {
+                fprintf(file, "      \"aggregate_name\": \"%s\",\n", suffix.c_str() + 1);
+            }
+            fprintf(file, "      \"iterations\": %llu,\n", (unsigned long long)result.iterations);
+            fprintf(file, "      \"real_time\": %.6f,\n", realTime);
+            fprintf(file, "      \"cpu_time\": %.6f,\n", select(result.cpuTimeNs));
+            fprintf(file, "      \"time_unit\": \"ns\",\n");
+            for (const auto& [name, values] : result.counters) {
+                fprintf(file, "      \"%s\": %.6f,\n", name.c_str(), select(values));
+            }
+            fprintf(file, "      \"ns_per_item\": %.6f,\n", realTime / result.itemsPerIteration);
+            fprintf(file, "      \"items_per_second\": %.6f\n", result.itemsPerIteration / realTime * 1e9);
+            fprintf(file, "    }");
+        };
+
+        for (const auto& result : m_results) {
+            for (size_t i = 0; i < result.realTimeNs.size(); i++) {
+                WriteEntry(result, "iteration", "", (int)i, [&](const std::vector<double>& values) {
+                    return i < values.size() ? values[i] : 0.0;
+                });
+            }
+            WriteEntry(result, "aggregate", "_mean", -1, Mean);
+            WriteEntry(result, "aggregate", "_median", -1, Median);
+            WriteEntry(result, "aggregate", "_stddev", -1, StandardDeviation);
+        }
+        fprintf(file, "\n  ]\n}\n");
+        fclose(file);
+
+        return true;
+    }
+
+    double Median(std::vector<double> values) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+    }
+
+    double Mean(const std::vector<double>& values) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        double sum = 0.0;
+        for (const double value : values) {
+            sum += value;
+        }
+        return sum / values.size();
+    }
+
+    double StandardDeviation(const std::vector<double>& values) {
+        if (values.size() < 2) {
+            return 0.0;
+        }
+        const double mean = Mean(values);
+        double sum = 0.0;
+        for (const double value : values) {
+            sum += (value - mean) * (value - mean);
+        }
+        return std::sqrt(sum / (values.size() - 1));
+    }
+
+    MannWhitneyResult MannWhitneyU(const std::vector<double>& a, const std::vector<double>& b) {
+        const size_t n1 = a.size();
+        const size_t n2 = b.size();
+        if (!n1 || !n2) {
+            return {0.0, 1.0};
+        }
+
+        // Rank the pooled samples. Ties get the average of their ranks.
+        std::vector<std::pair<double, bool>> pooled;
+        for (const double value : a) {
+            pooled.emplace_back(value, true);
+        }
+        for (const double value : b) {
+            pooled.emplace_back(value, false);
+        }
+        std::sort(pooled.begin(), pooled.end());
+        double rankSumA = 0.0;
+        double tieCorrection = 0.0;
+        for (size_t i = 0; i < pooled.size();) {
+            size_t j = i;
+            while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+                j++;
+            }
+            const double rank = (i + 1 + j) / 2.0;
+            const double ties = (double)(j - i);
+            tieCorrection += ties * ties * ties - ties;
+            for (; i < j; i++) {
+                rankSumA += pooled[i].second ? rank : 0.0;
+            }
+        }
+        const double u = rankSumA - n1 * (n1 + 1) / 2.0;
+
+        if (tieCorrection == 0.0 && n1 + n2 <= 50) {
+            // Exact distribution: the number of orderings giving each value of U are the coefficients of the Gaussian
+            // binomial [n1 + n2, n1], ie: the product of (1 - q^(n2 + i)) / (1 - q^i) for i in 1..n1. The counts stay
+            // below 2^53 for up to 50 samples.
+            std::vector<double> counts(n1 * n2 + n1 + 1, 0.0);
+            counts[0] = 1.0;
+            for (size_t i = 1; i <= n1; i++) {
+                for (size_t d = counts.size() - 1; d >= n2 + i; d--) {
+                    counts[d] -= counts[d - (n2 + i)];
+                }
+                for (size_t d = i; d < counts.size(); d++) {
+                    counts[d] += counts[d - i];
+                }
+            }
+            double total = 0.0, below = 0.0, above = 0.0;
+            for (size_t d = 0; d <= n1 * n2; d++) {
+                total += counts[d];
+                below += d <= u ? counts[d] : 0.0;
+                above += d >= u ? counts[d] : 0.0;
+            }
+            return {u, std::min(1.0, 2.0 * std::min(below, above) / total)};
+        }
+
+        // Normal approximation, with tie and continuity corrections.
+        const double n = (double)(n1 + n2);
+        const double variance = n1 * n2 / 12.0 * ((n + 1.0) - tieCorrection / (n * (n - 1.0)));
+        if (variance <= 0.0) {
+            return {u, 1.0};
+        }
+        const double z = std::max(0.0, std::abs(u - n1 * n2 / 2.0) - 0.5) / std::sqrt(variance);
+        return {u, std::erfc(z / std::sqrt(2.0))};
+    }
+
+} // namespace shim_host
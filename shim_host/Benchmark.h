@@ -0,0 +1,107 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Arguments.h"
+
+namespace shim_host {
+
+    struct BenchmarkResult {
+        std::string name;
+        uint64_t iterations = 0;
+        double itemsPerIteration = 1.0;
+
+        // Per-repetition timings, in nanoseconds per iteration.
+        std::vector<double> realTimeNs;
+        std::vector<double> cpuTimeNs;
+
+        // Per-repetition counters, normalized per item (eg: cache misses per vertex).
+        std::map<std::string, std::vector<double>> counters;
+    };
+
+    // A minimal google-benchmark style runner: the number of iterations is calibrated to run for a minimum time, then
+    // the measurement is repeated to obtain a distribution.
+    class BenchmarkRunner {
+      public:
+        struct Options {
+            std::string filter;
+            int repetitions = 5;
+            double minTimeSeconds = 0.2;
+            bool hardwareCounters = true;
+        };
+
+        // Common options: --filter <substring>, --repetitions <n>, --min-time <seconds>, --no-counters.
+        static Options OptionsFromArguments(const Arguments& args);
+
+        explicit BenchmarkRunner(const Options& options);
+        ~BenchmarkRunner();
+
+        bool Matches(const std::string& name) const;
+
+        // Measure body(iterations). Each iteration processes itemsPerIteration items (eg: vertices).
+        void Run(const std::string& name,
+                 double itemsPerIteration,
+                 const std::function<void(uint64_t iterations)>& body);
+
+        // Record an externally measured result (eg: a one-shot cold start).
+        void Record(BenchmarkResult result);
+
+        const std::vector<BenchmarkResult>& Results() const {
+            return m_results;
+        }
+
+        // Output in the google-benchmark JSON format, for trend tracking tools.
+        bool WriteJson(const std::string& path) const;
+
+      private:
+        void PrintResults(FILE* out, const BenchmarkResult& result) const;
+
+        const Options m_options;
+        std::vector<BenchmarkResult> m_results;
+        struct PerfCounters;
+        std::unique_ptr<PerfCounters> m_perfCounters;
+    };
+
+    // Prevent the compiler from discarding a computed value.
+    template <typename T>
+    inline void DoNotOptimize(const T& value) {
+        static volatile uint8_t sink;
+        sink = *(const volatile uint8_t*)&value;
+    }
+
+    double Median(std::vector<double> values);
+    double Mean(const std::vector<double>& values);
+    double StandardDeviation(const std::vector<double>& values);
+
+    struct MannWhitneyResult {
+        double u;
+        double pValue;
+    };
+
+    // Two-sided Mann-Whitney U test: how likely are both samples drawn from the same distribution. Exact for small
+    // samples without ties, normal approximation otherwise.
+    MannWhitneyResult MannWhitneyU(const std::vector<double>& a, const std::vector<double>& b);
+
+    std::string HostName();
+
+} // namespace shim_host
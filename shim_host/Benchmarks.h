@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Arguments.h"
+#include "Benchmark.h"
+
+namespace shim_host {
+
+    // Duration of each startup phase of the shim, from HmdDriverFactory() to the HMD activation.
+    void RunStartupBenchmarks(BenchmarkRunner& runner, const Arguments& args);
+
+    // ComputeDistortion() throughput across mesh resolutions and lens model variants.
+    void RunDistortionBenchmarks(BenchmarkRunner& runner, const Arguments& args);
+
+    // Cost of the settings change events, and latency of the mesh rebuild they trigger.
+    void RunSettingsBenchmarks(BenchmarkRunner& runner, const Arguments& args);
+
+    // Full mesh generation as done by the compositor, per mesh resolution and number of sampling threads.
+    void RunCompositorBenchmarks(BenchmarkRunner& runner, const Arguments& args);
+
+    // Memory accounted by the shim per eye, at each mesh resolution.
+    void RunMemoryBenchmarks(BenchmarkRunner& runner, const Arguments& args);
+
+    // Cost of the methods that the shim devices forward as-is, against calling the vendor device directly.
+    void RunForwardingBenchmarks(BenchmarkRunner& runner, const Arguments& args);
+
+} // namespace shim_host
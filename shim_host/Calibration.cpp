@@ -0,0 +1,505 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Calibration.h"
+
+namespace {
+    using namespace shim_host;
+
+    // fx, fy, cx, cy, s, then codX, codY, k1, k2, k3 for each channel.
+    constexpr int ParameterCount = 20;
+    constexpr int ChannelParameters = 5;
+
+    enum Parameter {
+        FocalLengthX,
+        FocalLengthY,
+        PrincipalPointX,
+        PrincipalPointY,
+        SkewFactor,
+        FirstChannel,
+    };
+
+    // The coefficients are fitted for radii normalized by half the viewport width, otherwise k3 would be around 1e-20
+    // and the normal equations hopelessly conditioned.
+    struct Parameters {
+        double values[ParameterCount];
+        double radius;
+
+        Parameters(const EyeModel& model, double radius) : radius(radius) {
+            values[FocalLengthX] = model.focalLengthX;
+            values[FocalLengthY] = model.focalLengthY;
+            values[PrincipalPointX] = model.principalPointX;
+            values[PrincipalPointY] = model.principalPointY;
+            values[SkewFactor] = model.skewFactor;
+            for (int channel = 0; channel < 3; channel++) {
+                const EyeModel::Channel& c = model.channels[channel];
+                double* const p = &values[FirstChannel + channel * ChannelParameters];
+                p[0] = c.codX;
+                p[1] = c.codY;
+                p[2] = c.k1 * std::pow(radius, 2);
+                p[3] = c.k2 * std::pow(radius, 4);
+                p[4] = c.k3 * std::pow(radius, 6);
+            }
+        }
+
+        EyeModel ToModel() const {
+            EyeModel model;
+            model.focalLengthX = values[FocalLengthX];
+            model.focalLengthY = values[FocalLengthY];
+            model.principalPointX = values[PrincipalPointX];
+            model.principalPointY = values[PrincipalPointY];
+            model.skewFactor = values[SkewFactor];
+            for (int channel = 0; channel < 3; channel++) {
+                EyeModel::Channel& c = model.channels[channel];
+                const double* const p = &values[FirstChannel + channel * ChannelParameters];
+                c.codX = p[0];
+                c.codY = p[1];
+                c.k1 = p[2] / std::pow(radius, 2);
+                c.k2 = p[3] / std::pow(radius, 4);
+                c.k3 = p[4] / std::pow(radius, 6);
+            }
+            return model;
+        }
+    };
+
+    // J^T J and J^T e, for the points handled by one thread.
+    struct NormalEquations {
+        double jtj[ParameterCount][ParameterCount] = {};
+        double jte[ParameterCount] = {};
+        double cost = 0.0;
+
+        double sumSquares[3] = {};
+        double maxError[3] = {};
+        size_t count[3] = {};
+
+        void Add(const NormalEquations& other) {
+            for (int i = 0; i < ParameterCount; i++) {
+                for (int j = 0; j < ParameterCount; j++) {
+                    jtj[i][j] += other.jtj[i][j];
+                }
+                jte[i] += other.jte[i];
+            }
+            cost += other.cost;
+            for (int channel = 0; channel < 3; channel++) {
+                sumSquares[channel] += other.sumSquares[channel];
+                maxError[channel] = std::max(maxError[channel], other.maxError[channel]);
+                count[channel] += other.count[channel];
+            }
+        }
+    };
+
+    void Accumulate(const Correspondence* begin,
+                    const Correspondence* end,
+                    const Parameters& parameters,
+                    bool withJacobian,
+                    NormalEquations& result) {
+        const double* const p = parameters.values;
+        const double invRadius2 = 1.0 / (parameters.radius * parameters.radius);
+
+        for (const Correspondence* point = begin; point != end; point++) {
+            const int base = FirstChannel + point->channel * ChannelParameters;
+            const double codX = p[base + 0];
+            const double codY = p[base + 1];
+            const double k1 = p[base + 2];
+            const double k2 = p[base + 3];
+            const double k3 = p[base + 4];
+
+            const double dx = point->x - codX;
+            const double dy = point->y - codY;
+            const double q = (dx * dx + dy * dy) * invRadius2;
+            const double d = 1.0 + q * (k1 + q * (k2 + q * k3));
+            const double tangentX = point->tangentX;
+            const double tangentY = point->tangentY;
+
+            const double errorX =
+                dx * d + codX - (p[FocalLengthX] * tangentX + p[SkewFactor] * tangentY + p[PrincipalPointX]);
+            const double errorY = dy * d + codY - (p[FocalLengthY] * tangentY + p[PrincipalPointY]);
+            const double squaredError = errorX * errorX + errorY * errorY;
+            const double weight = point->weight;
+            result.cost += weight * squaredError;
+            result.sumSquares[point->channel] += squaredError;
+            result.maxError[point->channel] = std::max(result.maxError[point->channel], squaredError);
+            result.count[point->channel]++;
+
+            if (!withJacobian) {
+                continue;
+            }
+
+            // d(d)/d(q), and d(q)/d(cod) = -2 * delta / radius^2.
+            const double dd = k1 + q * (2.0 * k2 + q * 3.0 * k3);
+            const double dqX = -2.0 * dx * invRadius2;
+            const double dqY = -2.0 * dy * invRadius2;
+
+            const int indicesX[8] = {
+                base, base + 1, base + 2, base + 3, base + 4, FocalLengthX, SkewFactor, PrincipalPointX};
+            const double jacobianX[8] = {
+                1.0 - d + dx * dd * dqX, dx * dd * dqY, dx * q, dx * q * q, dx * q * q * q, -tangentX, -tangentY, -1.0};
+            const int indicesY[7] = {base, base + 1, base + 2, base + 3, base + 4, FocalLengthY, PrincipalPointY};
+            const double jacobianY[7] = {
+                dy * dd * dqX, 1.0 - d + dy * dd * dqY, dy * q, dy * q * q, dy * q * q * q, -tangentY, -1.0};
+
+            for (int i = 0; i < 8; i++) {
+                for (int j = 0; j < 8; j++) {
+                    result.jtj[indicesX[i]][indicesX[j]] += weight * jacobianX[i] * jacobianX[j];
+                }
+                result.jte[indicesX[i]] += weight * jacobianX[i] * errorX;
+            }
+            for (int i = 0; i < 7; i++) {
+                for (int j = 0; j < 7; j++) {
+                    result.jtj[indicesY[i]][indicesY[j]] += weight * jacobianY[i] * jacobianY[j];
+                }
+                result.jte[indicesY[i]] += weight * jacobianY[i] * errorY;
+            }
+        }
+    }
+
+    // Split the points evenly between the threads, the calling thread taking the first share.
+    NormalEquations Evaluate(const std::vector<Correspondence>& points,
+                             const Parameters& parameters,
+                             bool withJacobian,
+                             uint32_t threadCount) {
+        threadCount = std::max(1u, std::min<uint32_t>(threadCount, (uint32_t)(points.size() / 4096) + 1));
+        std::vector<NormalEquations> partials(threadCount);
+        const auto Run = [&](uint32_t index) {
+            const size_t begin = points.size() * index / threadCount;
+            const size_t end = points.size() * (index + 1) / threadCount;
+            Accumulate(points.data() + begin, points.data() + end, parameters, withJacobian, partials[index]);
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; i++) {
+            threads.emplace_back(Run, i);
+        }
+        Run(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (uint32_t i = 1; i < threadCount; i++) {
+            partials[0].Add(partials[i]);
+        }
+        return partials[0];
+    }
+
+    // Solve A x = b in place for a symmetric positive definite A.
+    bool SolveCholesky(double a[ParameterCount][ParameterCount], double b[ParameterCount]) {
+        for (int j = 0; j < ParameterCount; j++) {
+            double diagonal = a[j][j];
+            for (int k = 0; k < j; k++) {
+                diagonal -= a[j][k] * a[j][k];
+            }
+            if (!(diagonal > 0)) {
+                return false;
+            }
+            a[j][j] = std::sqrt(diagonal);
+            for (int i = j + 1; i < ParameterCount; i++) {
+                double value = a[i][j];
+                for (int k = 0; k < j; k++) {
+                    value -= a[i][k] * a[j][k];
+                }
+                a[i][j] = value / a[j][j];
+            }
+        }
+        for (int i = 0; i < ParameterCount; i++) {
+            for (int k = 0; k < i; k++) {
+                b[i] -= a[i][k] * b[k];
+            }
+            b[i] /= a[i][i];
+        }
+        for (int i = ParameterCount - 1; i >= 0; i--) {
+            for (int k = i + 1; k < ParameterCount; k++) {
+                b[i] -= a[k][i] * b[k];
+            }
+            b[i] /= a[i][i];
+        }
+        return true;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    bool LoadCorrespondences(const std::string& path, CorrespondenceSet& set) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        std::string content;
+        char buffer[65536];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            content.append(buffer, read);
+        }
+        fclose(file);
+
+        set = {};
+        const char* cur = content.c_str();
+        while (*cur) {
+            const char* const lineEnd = strchr(cur, '\n');
+            const char* const next = lineEnd ? lineEnd + 1 : cur + strlen(cur);
+            while (*cur == ' ' || *cur == '\t') {
+                cur++;
+            }
+
+            // Skip the comments and the blank lines.
+            if (*cur == '#' || *cur == '\r' || *cur == '\n' || !*cur) {
+                cur = next;
+                continue;
+            }
+
+            if (!strncmp(cur, "size", 4)) {
+                char* end;
+                set.eyeWidth = (uint32_t)strtoul(cur + 4, &end, 10);
+                set.eyeHeight = (uint32_t)strtoul(end, &end, 10);
+            } else {
+                char* end;
+                Correspondence point;
+                point.eye = (uint8_t)strtoul(cur, &end, 10);
+                point.channel = (uint8_t)strtoul(end, &end, 10);
+                point.x = strtof(end, &end);
+                point.y = strtof(end, &end);
+                point.tangentX = strtof(end, &end);
+                const char* const last = end;
+                point.tangentY = strtof(last, &end);
+                if (end == last || end > next || point.eye > 1 || point.channel > 2) {
+                    return false;
+                }
+                const char* const weight = end;
+                const float value = strtof(weight, &end);
+                if (end != weight && end <= next) {
+                    point.weight = value;
+                }
+                set.points.push_back(point);
+            }
+            cur = next;
+        }
+
+        return set.eyeWidth && set.eyeHeight;
+    }
+
+    bool SaveCorrespondences(const std::string& path, const CorrespondenceSet& set) {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        fprintf(file, "# eye channel x y tangent_x tangent_y [weight]\n");
+        fprintf(file, "size %u %u\n", set.eyeWidth, set.eyeHeight);
+        for (const Correspondence& point : set.points) {
+            fprintf(file,
+                    "%u %u %.9g %.9g %.9g %.9g",
+                    point.eye,
+                    point.channel,
+                    point.x,
+                    point.y,
+                    point.tangentX,
+                    point.tangentY);
+            if (point.weight != 1.f) {
+                fprintf(file, " %.9g", point.weight);
+            }
+            fputc('\n', file);
+        }
+        const bool success = !ferror(file);
+        fclose(file);
+        return success;
+    }
+
+    void EyeModel::Residual(const Correspondence& point, double& errorX, double& errorY) const {
+        const Channel& c = channels[point.channel];
+        const double dx = point.x - c.codX;
+        const double dy = point.y - c.codY;
+        const double r2 = dx * dx + dy * dy;
+        const double d = 1.0 + r2 * (c.k1 + r2 * (c.k2 + r2 * c.k3));
+        errorX = dx * d + c.codX - (focalLengthX * point.tangentX + skewFactor * point.tangentY + principalPointX);
+        errorY = dy * d + c.codY - (focalLengthY * point.tangentY + principalPointY);
+    }
+
+    EyeModel EyeModel::FromProfile(const LensProfile& profile, int eye, uint32_t width, uint32_t height) {
+        const LensProfile::Eye& e = profile.eyes[eye];
+        EyeModel model;
+        model.focalLengthX = (double)e.focalLengthX * width;
+        model.focalLengthY = (double)e.focalLengthY * height;
+        model.principalPointX = (double)e.principalPointX * width;
+        model.principalPointY = (double)e.principalPointY * height;
+        model.skewFactor = e.skewFactor;
+        for (int channel = 0; channel < 3; channel++) {
+            const LensProfile::Channel& c = e.channels[channel];
+            model.channels[channel] = {(double)c.codX * width, (double)c.codY * height, c.k1, c.k2, c.k3};
+        }
+        return model;
+    }
+
+    void EyeModel::ToProfile(LensProfile& profile, int eye, uint32_t width, uint32_t height) const {
+        LensProfile::Eye& e = profile.eyes[eye];
+        e.focalLengthX = (float)(focalLengthX / width);
+        e.focalLengthY = (float)(focalLengthY / height);
+        e.principalPointX = (float)(principalPointX / width);
+        e.principalPointY = (float)(principalPointY / height);
+        e.skewFactor = (float)skewFactor;
+        for (int channel = 0; channel < 3; channel++) {
+            const Channel& c = channels[channel];
+            e.channels[channel] = {
+                (float)(c.codX / width), (float)(c.codY / height), (float)c.k1, (float)c.k2, (float)c.k3};
+        }
+    }
+
+    EyeModel EstimateAffine(const std::vector<Correspondence>& points, uint32_t width, uint32_t height) {
+        // x = fx tx + s ty + cx and y = fy ty + cy, solved through their normal equations.
+        double ax[3][3] = {}, bx[3] = {};
+        double ay[2][2] = {}, by[2] = {};
+        for (const Correspondence& point : points) {
+            const double rowX[3] = {point.tangentX, point.tangentY, 1.0};
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    ax[i][j] += rowX[i] * rowX[j];
+                }
+                bx[i] += rowX[i] * point.x;
+            }
+            const double rowY[2] = {point.tangentY, 1.0};
+            for (int i = 0; i < 2; i++) {
+                for (int j = 0; j < 2; j++) {
+                    ay[i][j] += rowY[i] * rowY[j];
+                }
+                by[i] += rowY[i] * point.y;
+            }
+        }
+
+        EyeModel model;
+        const double determinantX = ax[0][0] * (ax[1][1] * ax[2][2] - ax[1][2] * ax[2][1]) -
+                                    ax[0][1] * (ax[1][0] * ax[2][2] - ax[1][2] * ax[2][0]) +
+                                    ax[0][2] * (ax[1][0] * ax[2][1] - ax[1][1] * ax[2][0]);
+        const double determinantY = ay[0][0] * ay[1][1] - ay[0][1] * ay[1][0];
+        if (determinantX != 0 && determinantY != 0) {
+            // Cramer's rule.
+            const auto Replace = [&](int column) {
+                double m[3][3];
+                memcpy(m, ax, sizeof(m));
+                for (int i = 0; i < 3; i++) {
+                    m[i][column] = bx[i];
+                }
+                return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                       m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                       m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+            };
+            model.focalLengthX = Replace(0) / determinantX;
+            model.skewFactor = Replace(1) / determinantX;
+            model.principalPointX = Replace(2) / determinantX;
+            model.focalLengthY = (by[0] * ay[1][1] - ay[0][1] * by[1]) / determinantY;
+            model.principalPointY = (ay[0][0] * by[1] - by[0] * ay[1][0]) / determinantY;
+        }
+        for (auto& channel : model.channels) {
+            channel.codX = width / 2.0;
+            channel.codY = height / 2.0;
+        }
+        return model;
+    }
+
+    FitReport FitEyeModel(const std::vector<Correspondence>& points,
+                          EyeModel& model,
+                          uint32_t width,
+                          const FitOptions& options) {
+        FitReport report;
+        report.pointCount = points.size();
+
+        // The coefficients past the requested number of terms are held at 0.
+        bool fixed[ParameterCount] = {};
+        for (int channel = 0; channel < 3; channel++) {
+            EyeModel::Channel& c = model.channels[channel];
+            double* const k[3] = {&c.k1, &c.k2, &c.k3};
+            for (int term = std::max(options.radialTerms, 0); term < 3; term++) {
+                *k[term] = 0;
+                fixed[FirstChannel + channel * ChannelParameters + 2 + term] = true;
+            }
+        }
+
+        Parameters parameters(model, width / 2.0);
+        NormalEquations current = Evaluate(points, parameters, true, options.threadCount);
+        report.initialRms = std::sqrt(current.cost / std::max<size_t>(1, points.size()));
+
+        double lambda = 1e-3;
+        while (report.iterations < options.maxIterations && current.cost > 0) {
+            report.iterations++;
+
+            // Marquardt's scaling of the damping by the diagonal. Parameters without any point (eg: a channel that
+            // was not measured) are left untouched.
+            double a[ParameterCount][ParameterCount];
+            double step[ParameterCount];
+            for (int i = 0; i < ParameterCount; i++) {
+                for (int j = 0; j < ParameterCount; j++) {
+                    a[i][j] = current.jtj[i][j];
+                }
+                a[i][i] = current.jtj[i][i] > 0 ? current.jtj[i][i] * (1.0 + lambda) : 1.0;
+                step[i] = -current.jte[i];
+            }
+            for (int i = 0; i < ParameterCount; i++) {
+                if (fixed[i]) {
+                    for (int j = 0; j < ParameterCount; j++) {
+                        a[i][j] = a[j][i] = 0;
+                    }
+                    a[i][i] = 1.0;
+                    step[i] = 0;
+                }
+            }
+            if (!SolveCholesky(a, step)) {
+                lambda *= 10;
+                continue;
+            }
+
+            Parameters candidate = parameters;
+            for (int i = 0; i < ParameterCount; i++) {
+                candidate.values[i] += step[i];
+            }
+            const NormalEquations trial = Evaluate(points, candidate, false, options.threadCount);
+            if (trial.cost < current.cost) {
+                const double decrease = (current.cost - trial.cost) / current.cost;
+                const double meanDecrease = (current.cost - trial.cost) / points.size();
+                parameters = candidate;
+                lambda = std::max(lambda / 10, 1e-12);
+                current = Evaluate(points, parameters, true, options.threadCount);
+                // Also stop once the improvement is far below the precision of the measurements (float pixels).
+                if (decrease < options.tolerance || meanDecrease < 1e-12) {
+                    report.converged = true;
+                    break;
+                }
+            } else {
+                lambda *= 10;
+                if (lambda > 1e16) {
+                    // No step improves the cost anymore: we are at the minimum, up to the precision of the data.
+                    report.converged = true;
+                    break;
+                }
+            }
+        }
+        if (current.cost == 0) {
+            report.converged = true;
+        }
+
+        model = parameters.ToModel();
+        for (int channel = 0; channel < 3; channel++) {
+            report.rms[channel] = std::sqrt(current.sumSquares[channel] / std::max<size_t>(1, current.count[channel]));
+            report.maxError[channel] = std::sqrt(current.maxError[channel]);
+        }
+        return report;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,154 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "LensProfile.h"
+
+namespace shim_host {
+
+    // A measured correspondence for one color channel: a display pixel, and the direction it is seen from through
+    // the lens, as tangents (the space of GetProjectionRaw()).
+    struct Correspondence {
+        uint8_t eye;
+        uint8_t channel;
+        float x, y;
+        float tangentX, tangentY;
+
+        // Relative weight of the correspondence in the least squares.
+        float weight = 1.f;
+    };
+
+    struct CorrespondenceSet {
+        // Dimensions of the eye viewport, which the lens profile is normalized by.
+        uint32_t eyeWidth = 0;
+        uint32_t eyeHeight = 0;
+
+        std::vector<Correspondence> points;
+    };
+
+    // Text format: a "size <eye width> <eye height>" line, then one "<eye> <channel> <x> <y> <tangent x> <tangent y>"
+    // line per correspondence, with the eye and channel as indices, and optionally the weight. Lines starting with #
+    // are ignored.
+    bool LoadCorrespondences(const std::string& path, CorrespondenceSet& set);
+    bool SaveCorrespondences(const std::string& path, const CorrespondenceSet& set);
+
+    // The lens model of one eye as applied by HmdShimDriver, in display pixels: Brown-Conrady for each channel, then
+    // the inverse of the affine transform [fx 0; s fy; cx cy] to tangent space.
+    struct EyeModel {
+        double focalLengthX = 0, focalLengthY = 0;
+        double principalPointX = 0, principalPointY = 0;
+        double skewFactor = 0;
+
+        struct Channel {
+            double codX = 0, codY = 0;
+            double k1 = 0, k2 = 0, k3 = 0;
+        };
+        Channel channels[3];
+
+        // Distance in display pixels between the distorted pixel and the projection of the measured tangents.
+        void Residual(const Correspondence& point, double& errorX, double& errorY) const;
+
+        static EyeModel FromProfile(const LensProfile& profile, int eye, uint32_t width, uint32_t height);
+        void ToProfile(LensProfile& profile, int eye, uint32_t width, uint32_t height) const;
+    };
+
+    struct FitOptions {
+        uint32_t threadCount = 1;
+        uint32_t maxIterations = 100;
+
+        // Relative decrease of the cost under which the fit has converged.
+        double tolerance = 1e-10;
+
+        // The radial coefficients fitted: k1 only, k1 and k2, or k1 to k3. The others are held at 0.
+        int radialTerms = 3;
+    };
+
+    struct FitReport {
+        size_t pointCount = 0;
+        uint32_t iterations = 0;
+        bool converged = false;
+        double initialRms = 0.0;
+
+        // In display pixels, for each channel, without the weights.
+        double rms[3] = {};
+        double maxError[3] = {};
+    };
+
+    // Closed-form least squares estimate of the affine transform, assuming no radial distortion and the centers of
+    // distortion in the middle of the viewport. A starting point for FitEyeModel().
+    EyeModel EstimateAffine(const std::vector<Correspondence>& points, uint32_t width, uint32_t height);
+
+    // Levenberg-Marquardt over the 20 parameters of one eye (the affine transform and the 3 channels), with analytic
+    // Jacobians. The normal equations are accumulated over the points from several threads. The points must all
+    // belong to the same eye.
+    FitReport FitEyeModel(const std::vector<Correspondence>& points,
+                          EyeModel& model,
+                          uint32_t width,
+                          const FitOptions& options);
+
+    struct RobustOptions {
+        // Residual in display pixels beyond which a correspondence is an outlier.
+        double threshold = 2.0;
+
+        // The minimal solver cannot move the centers of distortion, so its inliers are selected with a threshold this
+        // many times larger. FitEyeModelRobust() then halves it after each refinement.
+        double coarseScale = 16.0;
+
+        // Probability of drawing at least one outlier-free sample, which sets the number of hypotheses.
+        double confidence = 0.999;
+        uint32_t maxHypotheses = 4096;
+
+        uint32_t threadCount = 1;
+        uint32_t seed = 1;
+    };
+
+    struct RobustReport {
+        // For each channel.
+        size_t pointCount[3] = {};
+        size_t inlierCount[3] = {};
+        uint32_t hypotheses[3] = {};
+    };
+
+    // MSAC ahead of FitEyeModel(), for data with outliers (eg: misdetected features). With the centers of
+    // distortion fixed in the middle of the viewport, the model of each channel is linear in k1..k3 and the affine
+    // transform, which gives a minimal solver over 4 correspondences. The hypotheses are scored in parallel. Returns
+    // an initial model consistent with the inliers, and flags the inliers among the points (all from the same eye).
+    EyeModel EstimateRobust(const std::vector<Correspondence>& points,
+                            uint32_t width,
+                            uint32_t height,
+                            const RobustOptions& options,
+                            std::vector<bool>& inliers,
+                            RobustReport& report);
+
+    // EstimateRobust(), then alternate FitEyeModel() over the inliers and the re-classification of all the points,
+    // until the inliers are stable at the final threshold.
+    FitReport FitEyeModelRobust(const std::vector<Correspondence>& points,
+                                EyeModel& model,
+                                uint32_t width,
+                                uint32_t height,
+                                const FitOptions& options,
+                                const RobustOptions& robustOptions,
+                                std::vector<bool>& inliers,
+                                RobustReport& report);
+
+} // namespace shim_host
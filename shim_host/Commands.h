@@ -0,0 +1,115 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Arguments.h"
+
+namespace shim_host {
+
+    // Dump the distortion mesh returned by the shim, as the compositor would sample it.
+    int RunMesh(const Arguments& args);
+
+    // Evaluate the distortion of the shim (or its inverse for one channel) over packed float (u, v) pairs, from a
+    // memory-mapped file or stdin, over all the cores: <input|->, <output|->, --eye left|right,
+    // --inverse red|green|blue, --block <points>, --threads <n>.
+    int RunEvaluate(const Arguments& args);
+
+    // Apply the distortion mesh of the shim to a rendered eye image (or a test image), like the compositor, on the CPU:
+    // <output>, --input <path>, --eye left|right, --variant <name>, --resolution <n>, --threads <n>, --repetitions <n>.
+    int RunWarp(const Arguments& args);
+
+    // Render the warped grid, the chromatic separation, the pixel density and the valid region of each eye for the
+    // model of the shim: <output prefix>, --variant <name>, --eye left|right|both, --scale <n>, --grid <n>,
+    // --format png|ppm, --threads <n>.
+    int RunVisualize(const Arguments& args);
+
+    // Run the benchmark suites: --suite <names>, --filter <substring>, --repetitions <n>, --min-time <seconds>,
+    // --json <path>, --history <path>, --label <label>.
+    int RunBench(const Arguments& args);
+
+    // Compare the latest run of a history file against a baseline run: <history file>, --baseline <label>,
+    // --candidate <label>, --alpha <p>, --threshold <fraction>.
+    int RunCompare(const Arguments& args);
+
+    // Compare distortion paths against the double-precision reference: --candidate <names>, --budget <pixels>,
+    // --dense <n>, --settings-only.
+    int RunAccuracy(const Arguments& args);
+
+    // Report the radius where each channel of the lens model folds over, against the extent of the viewport:
+    // --settings-only.
+    int RunFoldOver(const Arguments& args);
+
+    // Write synthetic calibration correspondences for the lens profile of the settings, or one of its variants:
+    // <output>, --variant <name>, --points <n>, --noise <pixels>, --outliers <fraction>, --seed <n>.
+    int RunSynthesize(const Arguments& args);
+
+    // Fit the lens profile of the shim to measured correspondences: <correspondences>, --output <vrsettings>,
+    // --threads <n>, --iterations <n>, and to reject outliers first: --robust, --threshold <pixels>,
+    // --confidence <p>, --hypotheses <n>, --seed <n>.
+    int RunFit(const Arguments& args);
+
+    // Fit the lens profile of the shim to a dense sampling of another distortion, with the fewest radial terms that
+    // stay within the budget: --source vendor|shim|mesh:<path>, --samples <n>, --center-weight <w>, --budget <pixels>,
+    // --terms <n>, --all, --output <vrsettings>, --error-map <prefix>, --threads <n>, --iterations <n>.
+    int RunRefit(const Arguments& args);
+
+    // Render a simulated capture of a calibration pattern shown on the display, through the lens: <output>,
+    // --pattern dots|checkerboard, --spacing <pixels>, --eye left|right, --variant <name>, --capture-width <px>,
+    // --capture-height <px>, --camera-focal <px>, --supersampling <n>, --gray.
+    int RunCapture(const Arguments& args);
+
+    // Detect the features of a calibration pattern in a PGM/PPM capture, and write the correspondences for fit:
+    // <capture>, --output <path>, --append, --pattern dots|checkerboard, --spacing <pixels>, --origin <x,y>,
+    // --eye left|right, --camera-focal <px>, --camera-center <x,y>, --anchor <x,y>, --threads <n>, and the detector
+    // tuning: --window <px>, --contrast <level>, --sigma <px>, --suppression <px>, --refinement <px>,
+    // --response <ratio>.
+    int RunDetect(const Arguments& args);
+
+    // Re-issue the calls recorded in a trace file (the trace_file setting) against an emulation of the recorded
+    // display, and measure them: <trace file>, --tolerance <uv>, --repetitions <n>, --json <path>.
+    int RunReplay(const Arguments& args);
+
+    // Compose the shim on top of the vendor distortion, with an identity correction: compare against the vendor, then
+    // check that a second activation only reads the cache: --cache <directory>, --resolution <n>, --fresh,
+    // --dense <n>, --delay <microseconds>, --pipeline <stages> (ending with vendor, without residual).
+    int RunCompose(const Arguments& args);
+
+    // Derive the hidden area meshes (the hidden_area_file setting) from the image of the edges of the display through
+    // the model of the shim, simplified outwards: <output>, --variant <name>, --samples <n>, --tolerance <pixels>,
+    // --margin <pixels>, --sweep <tolerances>, --verify, --threads <n>.
+    int RunHiddenArea(const Arguments& args);
+
+    // Check the module index matching the target_drivers setting: lookups against a linear scan over random ranges,
+    // the module of this process, then the shim with and without this module as a target, and the HMD registered
+    // through each flavor of IVRServerDriverHost: --ranges <n>, --lookups <n>, --seed <n>.
+    int RunModules(const Arguments& args);
+
+    // Check that the file loaders of the shim accept valid files and reject corrupt ones: the residual grid and the
+    // hidden area meshes.
+    int RunLoaders(const Arguments& args);
+
+    // Concurrent distortion callers against settings changes, model switches and Deactivate()/Activate() cycles:
+    // --threads <n>, --duration <seconds>, --seed <n>.
+    int RunStress(const Arguments& args);
+
+} // namespace shim_host
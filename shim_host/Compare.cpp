@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+#include "History.h"
+
+namespace {
+    using namespace shim_host;
+
+    // The most recent run with the given label, or the most recent run if the label is empty.
+    const HistoryRun* FindRun(const std::vector<HistoryRun>& runs, const std::string& label) {
+        for (auto it = runs.rbegin(); it != runs.rend(); ++it) {
+            if (label.empty() || it->label == label) {
+                return &*it;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string FormatTime(int64_t timestamp) {
+        const std::time_t time = (std::time_t)timestamp;
+        char date[64];
+        std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&time));
+        return date;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunCompare(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host compare <history file> [--baseline <label>] [--candidate <label>] [--alpha <p>] "
+                    "[--threshold <fraction>]\n");
+            return 1;
+        }
+        const auto runs = LoadHistory(args.Positional()[0]);
+        if (!runs) {
+            return 1;
+        }
+
+        // Without a run labeled as the baseline, compare against the oldest run.
+        const HistoryRun* baseline = FindRun(*runs, args.Get("baseline", "baseline"));
+        if (!baseline && !args.Has("baseline") && !runs->empty()) {
+            baseline = &runs->front();
+        }
+        const HistoryRun* const candidate = FindRun(*runs, args.Get("candidate"));
+        if (!baseline || !candidate || baseline == candidate) {
+            fprintf(stderr, "The history needs a baseline run and a more recent candidate run\n");
+            return 1;
+        }
+
+        // A difference is only reported when it is both significant and large enough to matter.
+        const double alpha = args.GetDouble("alpha", 0.05);
+        const double threshold = args.GetDouble("threshold", 0.05);
+
+        printf("Baseline:  %s (%s, %s)\n",
+               baseline->label.c_str(),
+               FormatTime(baseline->timestamp).c_str(),
+               baseline->hostName.c_str());
+        printf("Candidate: %s (%s, %s)\n\n",
+               candidate->label.c_str(),
+               FormatTime(candidate->timestamp).c_str(),
+               candidate->hostName.c_str());
+        printf("%-48s %15s %15s %9s %9s  %s\n", "Benchmark", "Baseline", "Candidate", "Change", "p-value", "Verdict");
+
+        int regressions = 0;
+        for (const auto& [name, candidateValues] : candidate->nsPerItem) {
+            const auto it = baseline->nsPerItem.find(name);
+            if (it == baseline->nsPerItem.end() || it->second.empty() || candidateValues.empty()) {
+                continue;
+            }
+
+            const double baselineMedian = Median(it->second);
+            const double candidateMedian = Median(candidateValues);
+            const double change = candidateMedian / baselineMedian - 1.0;
+            const MannWhitneyResult test = MannWhitneyU(it->second, candidateValues);
+
+            const char* verdict = "";
+            if (test.pValue < alpha && change > threshold) {
+                verdict = "REGRESSION";
+                regressions++;
+            } else if (test.pValue < alpha && change < -threshold) {
+                verdict = "improvement";
+            }
+            printf("%-48s %12.2f ns %12.2f ns %+8.1f%% %9.4f  %s\n",
+                   name.c_str(),
+                   baselineMedian,
+                   candidateMedian,
+                   change * 100.0,
+                   test.pValue,
+                   verdict);
+        }
+
+        if (regressions) {
+            printf("\n%d regression(s) (p < %g, slowdown > %.0f%%)\n", regressions, alpha, threshold * 100.0);
+            return 1;
+        }
+        return 0;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "Commands.h"
+#include "LensProfile.h"
+#include "ShimHost.h"
+#include "VendorDistortionTable.h"
+
+namespace {
+    using namespace shim_host;
+
+    struct Activation {
+        uint64_t vendorCalls = 0;
+        double milliseconds = 0.0;
+    };
+
+    // Boot the fake vrserver, counting the calls to the vendor's ComputeDistortion() until the device is active.
+    bool Start(ShimHost& host, Activation& activation) {
+        const uint64_t calls = host.Vendor().computeDistortionCalls.load();
+        const auto start = std::chrono::steady_clock::now();
+        if (!host.Start()) {
+            return false;
+        }
+        activation.milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        activation.vendorCalls = host.Vendor().computeDistortionCalls.load() - calls;
+        return true;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunCompose(const Arguments& args) {
+        ShimHost::Options options = ShimHost::OptionsFromArguments(args);
+        options.display.computeDistortionDelay = std::chrono::microseconds(args.GetInt("delay", 0));
+        const std::string directory = args.Get("cache");
+        const int64_t resolution = args.GetInt("resolution", 0);
+        const std::string pipeline = args.Get("pipeline");
+
+        // Compose on top of the vendor distortion, with an identity correction, so that the shim should match the
+        // vendor up to the interpolation of the tables.
+        options.overrideSettings = [&](FakeSettings& settings) {
+            settings.SetBool("driver_distortion_shim", "compose_vendor_distortion", true);
+            settings.SetString("driver_distortion_shim", "pipeline", pipeline.c_str());
+            settings.SetFloat("driver_distortion_shim", "ipd_shift", 0.f);
+            settings.SetString("driver_distortion_shim", "vendor_table_directory", directory.c_str());
+            if (resolution > 0) {
+                settings.SetInt32("driver_distortion_shim", "vendor_table_resolution", (int32_t)resolution);
+            }
+            for (const char* eye : EyeNames) {
+                for (const char* channel : ChannelNames) {
+                    for (const char* term : {"k1", "k2", "k3"}) {
+                        settings.SetFloat("driver_distortion_shim",
+                                          (std::string(eye) + "_" + channel + "_" + term).c_str(),
+                                          0.f);
+                    }
+                }
+            }
+        };
+
+        const std::string cachePath =
+            driver_shim::VendorDistortionTable::GetCachePath(directory, options.display.serialNumber);
+        if (args.Has("fresh")) {
+            std::error_code error;
+            std::filesystem::remove(cachePath, error);
+        }
+
+        // The first boot samples the vendor distortion, unless the cache already has it.
+        Activation first;
+        {
+            ShimHost host(options);
+            if (!Start(host, first)) {
+                return 1;
+            }
+            printf("First activation: %.1f ms, %llu calls to the vendor's ComputeDistortion()\n",
+                   first.milliseconds,
+                   (unsigned long long)first.vendorCalls);
+
+            // Compare against the vendor on a grid that does not line up with the table.
+            const uint32_t dense = (uint32_t)std::max<int64_t>(2, args.GetInt("dense", 257));
+            uint32_t renderWidth, renderHeight;
+            host.Vendor().GetRecommendedRenderTargetSize(&renderWidth, &renderHeight);
+            for (const vr::EVREye eye : {vr::Eye_Left, vr::Eye_Right}) {
+                double maxError[3] = {};
+                for (uint32_t row = 0; row < dense; row++) {
+                    const float v = (float)row / (dense - 1);
+                    for (uint32_t column = 0; column < dense; column++) {
+                        const float u = (float)column / (dense - 1);
+                        const vr::DistortionCoordinates_t shim = host.Display()->ComputeDistortion(eye, u, v);
+                        const vr::DistortionCoordinates_t vendor = host.Vendor().ComputeDistortion(eye, u, v);
+                        const float* const shimChannels[] = {shim.rfRed, shim.rfGreen, shim.rfBlue};
+                        const float* const vendorChannels[] = {vendor.rfRed, vendor.rfGreen, vendor.rfBlue};
+                        for (int channel = 0; channel < 3; channel++) {
+                            const double dx = (shimChannels[channel][0] - vendorChannels[channel][0]) * renderWidth;
+                            const double dy = (shimChannels[channel][1] - vendorChannels[channel][1]) * renderHeight;
+                            maxError[channel] = std::max(maxError[channel], std::sqrt(dx * dx + dy * dy));
+                        }
+                    }
+                }
+                printf("%s eye: max error against the vendor %.4f %.4f %.4f px (red, green, blue)\n",
+                       EyeNames[eye],
+                       maxError[0],
+                       maxError[1],
+                       maxError[2]);
+            }
+        }
+
+        // The second boot must only read the cache.
+        Activation second;
+        {
+            ShimHost host(options);
+            if (!Start(host, second)) {
+                return 1;
+            }
+        }
+        printf("Second activation: %.1f ms, %llu calls to the vendor's ComputeDistortion()\n",
+               second.milliseconds,
+               (unsigned long long)second.vendorCalls);
+        printf("Cache: %s\n", cachePath.c_str());
+
+        return second.vendorCalls == 0 ? 0 : 1;
+    }
+
+} // namespace shim_host
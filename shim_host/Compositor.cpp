@@ -0,0 +1,257 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Compositor.h"
+#include "Parallel.h"
+
+namespace {
+
+    // The output is processed in square tiles, so that the texels sampled by a tile stay in the cache.
+    constexpr uint32_t TileSize = 64;
+
+    // The mesh vertices, with the coordinates of the 3 channels in an array: red u/v, green u/v, blue u/v.
+    struct MeshVertex {
+        float uv[6];
+    };
+
+} // namespace
+
+namespace shim_host {
+
+    SimulatedCompositor::SimulatedCompositor(ShimHost& host, uint32_t threadCount) : m_host(host) {
+        m_host.Runtime().serverDriverHost.onVendorEvent = [this](uint32_t, vr::EVREventType eventType) {
+            if (eventType == vr::VREvent_LensDistortionChanged) {
+                m_lensDistortionChanged = true;
+            }
+        };
+
+        for (uint32_t i = 1; i < std::max(1u, threadCount); i++) {
+            m_workers.emplace_back([this] { WorkerThread(); });
+        }
+    }
+
+    SimulatedCompositor::~SimulatedCompositor() {
+        {
+            std::unique_lock lock(m_mutex);
+            m_exiting = true;
+        }
+        m_wakeUp.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+        m_host.Runtime().serverDriverHost.onVendorEvent = nullptr;
+    }
+
+    void SimulatedCompositor::BuildMesh() {
+        m_lensDistortionChanged = false;
+
+        const vr::PropertyContainerHandle_t container =
+            m_host.Runtime().properties.TrackedDeviceToPropertyContainer(m_host.Vendor().deviceIndex);
+        m_resolution =
+            std::max(2, vr::VRProperties()->GetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32));
+        for (auto& mesh : m_mesh) {
+            mesh.resize((size_t)m_resolution * m_resolution);
+        }
+
+        m_nextRow = 0;
+        {
+            std::unique_lock lock(m_mutex);
+            m_generation++;
+            m_busyWorkers = (uint32_t)m_workers.size();
+        }
+        m_wakeUp.notify_all();
+
+        SampleRows();
+
+        std::unique_lock lock(m_mutex);
+        m_done.wait(lock, [&] { return m_busyWorkers == 0; });
+    }
+
+    bool SimulatedCompositor::Update() {
+        if (!m_lensDistortionChanged) {
+            return false;
+        }
+        BuildMesh();
+        return true;
+    }
+
+    void SimulatedCompositor::WorkerThread() {
+        uint64_t generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_wakeUp.wait(lock, [&] { return m_exiting || m_generation != generation; });
+                if (m_exiting) {
+                    return;
+                }
+                generation = m_generation;
+            }
+
+            SampleRows();
+
+            std::unique_lock lock(m_mutex);
+            if (--m_busyWorkers == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+
+    void SimulatedCompositor::SampleRows() {
+        vr::IVRDisplayComponent* const display = m_host.Display();
+        const uint32_t n = (uint32_t)m_resolution;
+        while (true) {
+            const uint32_t row = m_nextRow++;
+            if (row >= 2 * n) {
+                break;
+            }
+
+            const vr::EVREye eye = row < n ? vr::Eye_Left : vr::Eye_Right;
+            const uint32_t y = row % n;
+            const float v = (float)y / (n - 1);
+            vr::DistortionCoordinates_t* const vertices = &m_mesh[eye][(size_t)y * n];
+            for (uint32_t x = 0; x < n; x++) {
+                vertices[x] = display->ComputeDistortion(eye, (float)x / (n - 1), v);
+            }
+        }
+    }
+
+    void WarpImage(const Image& source,
+                   const std::vector<vr::DistortionCoordinates_t>& mesh,
+                   int32_t resolution,
+                   uint32_t width,
+                   uint32_t height,
+                   Image& output,
+                   uint32_t threadCount) {
+        const uint32_t n = (uint32_t)resolution;
+        std::vector<MeshVertex> vertices(mesh.size());
+        for (size_t i = 0; i < mesh.size(); i++) {
+            const vr::DistortionCoordinates_t& c = mesh[i];
+            vertices[i] = {{c.rfRed[0], c.rfRed[1], c.rfGreen[0], c.rfGreen[1], c.rfBlue[0], c.rfBlue[1]}};
+        }
+
+        output.Resize(width, height, 3);
+        const uint32_t tilesX = (width + TileSize - 1) / TileSize;
+        const uint32_t tilesY = (height + TileSize - 1) / TileSize;
+        const float sourceWidth = (float)source.width;
+        const float sourceHeight = (float)source.height;
+        const int32_t maxX = (int32_t)source.width - 1;
+        const int32_t maxY = (int32_t)source.height - 1;
+        const int32_t channels = (int32_t)source.channels;
+        const int32_t stride = (int32_t)(source.width * source.channels);
+        const float scaleX = (float)(n - 1) / width;
+        const float scaleY = (float)(n - 1) / height;
+
+        // The mesh cell and the weight of each column, shared by all the rows.
+        std::vector<uint32_t> cellX(width);
+        std::vector<float> cellWeightX(width);
+        for (uint32_t x = 0; x < width; x++) {
+            // Like the rasterizer, sample at the pixel centers.
+            const float meshX = (x + 0.5f) * scaleX;
+            cellX[x] = std::min((uint32_t)meshX, n - 2);
+            cellWeightX[x] = meshX - cellX[x];
+        }
+
+        ParallelFor(threadCount, (size_t)tilesX * tilesY, [&](size_t begin, size_t end) {
+            // The mesh interpolated at the height of the current row, then the texel coordinates of each channel.
+            std::vector<MeshVertex> rowVertices(n);
+            float texelX[3][TileSize];
+            float texelY[3][TileSize];
+            int32_t offset[TileSize];
+            int32_t stepX[TileSize];
+            int32_t stepY[TileSize];
+            float weightX[TileSize];
+            float weightY[TileSize];
+            float visible[TileSize];
+
+            for (size_t tile = begin; tile < end; tile++) {
+                const uint32_t x0 = (uint32_t)(tile % tilesX) * TileSize;
+                const uint32_t y0 = (uint32_t)(tile / tilesX) * TileSize;
+                const uint32_t spanWidth = std::min(TileSize, width - x0);
+                const uint32_t y1 = std::min(y0 + TileSize, height);
+                const uint32_t firstCell = cellX[x0];
+                const uint32_t lastCell = cellX[x0 + spanWidth - 1] + 1;
+
+                for (uint32_t y = y0; y < y1; y++) {
+                    const float meshY = (y + 0.5f) * scaleY;
+                    const uint32_t j = std::min((uint32_t)meshY, n - 2);
+                    const float ty = meshY - j;
+                    const MeshVertex* const row0 = &vertices[(size_t)j * n];
+                    const MeshVertex* const row1 = row0 + n;
+                    for (uint32_t i = firstCell; i <= lastCell; i++) {
+                        for (uint32_t a = 0; a < 6; a++) {
+                            rowVertices[i].uv[a] = row0[i].uv[a] + ty * (row1[i].uv[a] - row0[i].uv[a]);
+                        }
+                    }
+
+                    for (uint32_t k = 0; k < spanWidth; k++) {
+                        const MeshVertex& left = rowVertices[cellX[x0 + k]];
+                        const MeshVertex& right = rowVertices[cellX[x0 + k] + 1];
+                        const float tx = cellWeightX[x0 + k];
+                        for (uint32_t channel = 0; channel < 3; channel++) {
+                            const float u = left.uv[2 * channel] + tx * (right.uv[2 * channel] - left.uv[2 * channel]);
+                            const float v =
+                                left.uv[2 * channel + 1] + tx * (right.uv[2 * channel + 1] - left.uv[2 * channel + 1]);
+                            texelX[channel][k] = u * sourceWidth - 0.5f;
+                            texelY[channel][k] = v * sourceHeight - 0.5f;
+                        }
+                    }
+
+                    // First the addresses and the weights of the texels, without branches so that the loop
+                    // vectorizes, then the gather. The edges of the image are clamped like a texture sampler would,
+                    // and the coordinates past the edges get a weight of 0.
+                    uint8_t* const out = output.Pixel(x0, y);
+                    for (uint32_t channel = 0; channel < 3; channel++) {
+                        for (uint32_t k = 0; k < spanWidth; k++) {
+                            const float sx = texelX[channel][k];
+                            const float sy = texelY[channel][k];
+                            const bool inside =
+                                sx >= -0.5f && sy >= -0.5f && sx <= sourceWidth - 0.5f && sy <= sourceHeight - 0.5f;
+                            const float cx = std::min(std::max(sx, 0.f), (float)maxX);
+                            const float cy = std::min(std::max(sy, 0.f), (float)maxY);
+                            const int32_t ix = (int32_t)cx;
+                            const int32_t iy = (int32_t)cy;
+                            offset[k] = iy * stride + ix * channels;
+                            stepX[k] = ix < maxX ? channels : 0;
+                            stepY[k] = iy < maxY ? stride : 0;
+                            weightX[k] = cx - ix;
+                            weightY[k] = cy - iy;
+                            visible[k] = inside ? 1.f : 0.f;
+                        }
+
+                        const uint8_t* const texels = source.pixels.data() + (source.channels == 3 ? channel : 0);
+                        for (uint32_t k = 0; k < spanWidth; k++) {
+                            const uint8_t* const top = texels + offset[k];
+                            const uint8_t* const bottom = top + stepY[k];
+                            const float upper = top[0] + weightX[k] * (top[stepX[k]] - top[0]);
+                            const float lower = bottom[0] + weightX[k] * (bottom[stepX[k]] - bottom[0]);
+                            out[k * 3 + channel] =
+                                (uint8_t)(visible[k] * (upper + weightY[k] * (lower - upper)) + 0.5f);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+} // namespace shim_host
@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Image.h"
+#include "ShimHost.h"
+
+namespace shim_host {
+
+    // Imitates how the SteamVR compositor pulls the distortion mesh from the display component: both eyes, row-major,
+    // at the resolution from Prop_DistortionMeshResolution_Int32, optionally from several threads. The mesh is
+    // rebuilt when the driver signals VREvent_LensDistortionChanged.
+    class SimulatedCompositor {
+      public:
+        // The calling thread counts as one of the threads.
+        SimulatedCompositor(ShimHost& host, uint32_t threadCount);
+        ~SimulatedCompositor();
+
+        // Sample the full mesh of both eyes.
+        void BuildMesh();
+
+        // Rebuild the mesh if the driver signaled a lens distortion change since the last build.
+        bool Update();
+
+        int32_t Resolution() const {
+            return m_resolution;
+        }
+
+        const std::vector<vr::DistortionCoordinates_t>& Mesh(vr::EVREye eye) const {
+            return m_mesh[eye];
+        }
+
+      private:
+        void WorkerThread();
+        void SampleRows();
+
+        ShimHost& m_host;
+        int32_t m_resolution = 0;
+        std::vector<vr::DistortionCoordinates_t> m_mesh[2];
+        std::atomic<bool> m_lensDistortionChanged{false};
+
+        // The rows of both eyes are handed out to the threads one at a time.
+        std::atomic<uint32_t> m_nextRow{0};
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::condition_variable m_done;
+        uint64_t m_generation = 0;
+        uint32_t m_busyWorkers = 0;
+        bool m_exiting = false;
+    };
+
+    // The distortion pass of the compositor, on the CPU: each pixel of an eye's output viewport (width x height)
+    // samples the rendered eye image at the coordinates interpolated from the distortion mesh, bilinearly and
+    // separately for each channel. Coordinates outside of the rendered image are black. The output is RGB.
+    void WarpImage(const Image& source,
+                   const std::vector<vr::DistortionCoordinates_t>& mesh,
+                   int32_t resolution,
+                   uint32_t width,
+                   uint32_t height,
+                   Image& output,
+                   uint32_t threadCount);
+
+} // namespace shim_host
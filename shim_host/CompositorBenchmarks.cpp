@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "Compositor.h"
+#include "LensProfile.h"
+#include "ShimHost.h"
+
+namespace shim_host {
+
+    void RunCompositorBenchmarks(BenchmarkRunner& runner, const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return;
+        }
+
+        const LensProfile base = LensProfile::FromSettings(&host.Runtime().settings);
+        const auto variants = LensProfile::Variants(base, host.Vendor().Script().eyeWidth);
+        const LensProfile& profileA = variants[1].second;
+        const LensProfile& profileB = variants.back().second;
+        host.ChangeSettings([&](FakeSettings& settings) { profileA.ToSettings(&settings); });
+
+        // The device's own resolution, then larger meshes.
+        const vr::PropertyContainerHandle_t container =
+            host.Runtime().properties.TrackedDeviceToPropertyContainer(host.Vendor().deviceIndex);
+        const int32_t deviceResolution =
+            vr::VRProperties()->GetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32);
+        const auto resolutions = args.GetList("resolutions", std::to_string(deviceResolution) + ",64,128");
+
+        for (const auto& resolution : resolutions) {
+            const int32_t n = std::max(2, atoi(resolution.c_str()));
+            vr::VRProperties()->SetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32, n);
+
+            for (const auto& threads : args.GetList("threads", "1,2,4")) {
+                const uint32_t threadCount = (uint32_t)std::max(1, atoi(threads.c_str()));
+                const std::string suffix = std::to_string(n) + "/threads:" + std::to_string(threadCount);
+                SimulatedCompositor compositor(host, threadCount);
+
+                // Full mesh generation, as done when the compositor starts.
+                runner.Run("CompositorMesh/" + suffix, 2.0 * n * n, [&](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++) {
+                        compositor.BuildMesh();
+                    }
+                });
+
+                // The settings change, the event, then the mesh rebuild.
+                runner.Run("CompositorRebuild/" + suffix, 2.0 * n * n, [&](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++) {
+                        const LensProfile& profile = (i & 1) ? profileA : profileB;
+                        host.ChangeSettings([&](FakeSettings& settings) { profile.ToSettings(&settings); });
+                        compositor.Update();
+                    }
+                });
+            }
+        }
+
+        vr::VRProperties()->SetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32, deviceResolution);
+
+        // The distortion pass on the CPU, from an eye image at the recommended render target size into the viewport.
+        Image source;
+        uint32_t renderWidth, renderHeight;
+        host.Display()->GetRecommendedRenderTargetSize(&renderWidth, &renderHeight);
+        source.Resize(renderWidth, renderHeight, 3);
+        std::fill(source.pixels.begin(), source.pixels.end(), (uint8_t)128);
+        uint32_t x, y, width, height;
+        host.Display()->GetEyeOutputViewport(vr::Eye_Left, &x, &y, &width, &height);
+        for (const auto& threads : args.GetList("threads", "1,2,4")) {
+            const uint32_t threadCount = (uint32_t)std::max(1, atoi(threads.c_str()));
+            SimulatedCompositor compositor(host, threadCount);
+            compositor.BuildMesh();
+            Image output;
+            runner.Run("CompositorWarp/threads:" + std::to_string(threadCount),
+                       (double)width * height,
+                       [&](uint64_t iterations) {
+                           for (uint64_t i = 0; i < iterations; i++) {
+                               WarpImage(source,
+                                         compositor.Mesh(vr::Eye_Left),
+                                         compositor.Resolution(),
+                                         width,
+                                         height,
+                                         output,
+                                         threadCount);
+                           }
+                       });
+        }
+    }
+
+} // namespace shim_host
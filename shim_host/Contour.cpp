@@ -0,0 +1,373 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "Contour.h"
+
+namespace {
+    using namespace shim_host;
+
+    // Distance under which a vertex is on an edge of the rectangle, in the units of the contour.
+    constexpr double EdgeEpsilon = 1e-6;
+
+    double Cross(const Point2d& a, const Point2d& b, const Point2d& c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+
+    bool IsSame(const Point2d& a, const Point2d& b) {
+        return a.x == b.x && a.y == b.y;
+    }
+
+    // Inside or on the edges of a counter-clockwise triangle.
+    bool IsInTriangle(const Point2d& p, const Point2d& a, const Point2d& b, const Point2d& c) {
+        return Cross(a, b, p) >= 0 && Cross(b, c, p) >= 0 && Cross(c, a, p) >= 0;
+    }
+
+    // Bit mask of the edges of the rectangle the point is on: bottom (y = 0), right, top, left.
+    uint32_t GetRectangleEdges(const Point2d& p, double width, double height) {
+        return (std::abs(p.y) < EdgeEpsilon ? 1 : 0) | (std::abs(p.x - width) < EdgeEpsilon ? 2 : 0) |
+               (std::abs(p.y - height) < EdgeEpsilon ? 4 : 0) | (std::abs(p.x) < EdgeEpsilon ? 8 : 0);
+    }
+
+    // Position along the edges of the rectangle, counter-clockwise from (0, 0): [0, 1) on the bottom edge, [1, 2) on
+    // the right edge, etc...
+    double GetPerimeterPosition(const Point2d& p, double width, double height) {
+        const uint32_t edges = GetRectangleEdges(p, width, height);
+        if (edges & 1) {
+            return p.x / width;
+        } else if (edges & 2) {
+            return 1 + p.y / height;
+        } else if (edges & 4) {
+            return 2 + (1 - p.x / width);
+        } else {
+            return 3 + (1 - p.y / height);
+        }
+    }
+
+    Point2d GetRectangleCorner(int index, double width, double height) {
+        switch ((index % 4 + 4) % 4) {
+        case 0:
+            return {0, 0};
+        case 1:
+            return {width, 0};
+        case 2:
+            return {width, height};
+        default:
+            return {0, height};
+        }
+    }
+
+    // Line through a point along a normal: {normal, offset} with normal . p = offset.
+    struct Line {
+        Point2d normal;
+        double offset;
+    };
+
+} // namespace
+
+namespace shim_host {
+
+    double SignedArea(const Contour& contour) {
+        double area = 0;
+        for (size_t i = 0; i < contour.size(); i++) {
+            const Point2d& a = contour[i];
+            const Point2d& b = contour[(i + 1) % contour.size()];
+            area += a.x * b.y - b.x * a.y;
+        }
+        return area / 2;
+    }
+
+    Contour SimplifyOutwards(const Contour& contour, double tolerance, double margin) {
+        const size_t count = contour.size();
+        if (count < 4) {
+            return contour;
+        }
+
+        std::vector<size_t> previous(count), next(count);
+        std::vector<uint32_t> stamps(count, 0);
+        for (size_t i = 0; i < count; i++) {
+            previous[i] = (i + count - 1) % count;
+            next[i] = (i + 1) % count;
+        }
+
+        // Whether the vertices between a and b (exclusive) are within the tolerance of the segment [a, b].
+        const auto IsWithinTolerance = [&](size_t a, size_t b) {
+            const Point2d& start = contour[a];
+            const Point2d& end = contour[b];
+            const double dx = end.x - start.x;
+            const double dy = end.y - start.y;
+            const double length2 = dx * dx + dy * dy;
+            for (size_t i = (a + 1) % count; i != b; i = (i + 1) % count) {
+                const double projection = (contour[i].x - start.x) * dx + (contour[i].y - start.y) * dy;
+                const double t = length2 > 0 ? std::clamp(projection / length2, 0.0, 1.0) : 0.0;
+                const double ex = contour[i].x - (start.x + t * dx);
+                const double ey = contour[i].y - (start.y + t * dy);
+                if (ex * ex + ey * ey > tolerance * tolerance) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Min-heap of the effective areas, with stale entries skipped through their stamp.
+        using Entry = std::tuple<double, size_t, uint32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        const auto Push = [&](size_t i) {
+            stamps[i]++;
+            queue.emplace(std::abs(Cross(contour[previous[i]], contour[i], contour[next[i]])) / 2, i, stamps[i]);
+        };
+        for (size_t i = 0; i < count; i++) {
+            Push(i);
+        }
+
+        size_t remaining = count;
+        while (!queue.empty() && remaining > 3) {
+            const auto [area, i, stamp] = queue.top();
+            queue.pop();
+            if (stamp != stamps[i] || !IsWithinTolerance(previous[i], next[i])) {
+                continue;
+            }
+
+            next[previous[i]] = next[i];
+            previous[next[i]] = previous[i];
+            stamps[i] = UINT32_MAX;
+            remaining--;
+            Push(previous[i]);
+            Push(next[i]);
+        }
+
+        // The remaining vertices, in order.
+        std::vector<size_t> kept;
+        size_t first = 0;
+        while (stamps[first] == UINT32_MAX) {
+            first++;
+        }
+        for (size_t i = first; kept.empty() || i != first; i = next[i]) {
+            kept.push_back(i);
+        }
+
+        // Move each simplified edge outwards, past the vertices it replaced.
+        std::vector<Line> lines(kept.size());
+        for (size_t k = 0; k < kept.size(); k++) {
+            const size_t a = kept[k];
+            const size_t b = kept[(k + 1) % kept.size()];
+            const double dx = contour[b].x - contour[a].x;
+            const double dy = contour[b].y - contour[a].y;
+            const double length = std::max(std::sqrt(dx * dx + dy * dy), 1e-12);
+            const Point2d normal{dy / length, -dx / length};
+            const double offset = normal.x * contour[a].x + normal.y * contour[a].y;
+            double excess = 0;
+            for (size_t i = (a + 1) % count; i != b; i = (i + 1) % count) {
+                excess = std::max(excess, normal.x * contour[i].x + normal.y * contour[i].y - offset);
+            }
+            lines[k] = {normal, offset + excess + margin};
+        }
+
+        // The new vertices are at the intersections of consecutive lines.
+        Contour result(kept.size());
+        for (size_t k = 0; k < kept.size(); k++) {
+            const Line& l1 = lines[(k + kept.size() - 1) % kept.size()];
+            const Line& l2 = lines[k];
+            const double determinant = l1.normal.x * l2.normal.y - l1.normal.y * l2.normal.x;
+            if (std::abs(determinant) > 0.05) {
+                result[k] = {(l1.offset * l2.normal.y - l2.offset * l1.normal.y) / determinant,
+                             (l1.normal.x * l2.offset - l2.normal.x * l1.offset) / determinant};
+            } else {
+                // Nearly parallel: move the vertex along the mean normal.
+                const Point2d& p = contour[kept[k]];
+                double nx = l1.normal.x + l2.normal.x;
+                double ny = l1.normal.y + l2.normal.y;
+                const double length = std::max(std::sqrt(nx * nx + ny * ny), 1e-12);
+                const double distance = std::max(l1.offset - (l1.normal.x * p.x + l1.normal.y * p.y),
+                                                 l2.offset - (l2.normal.x * p.x + l2.normal.y * p.y));
+                result[k] = {p.x + nx / length * distance, p.y + ny / length * distance};
+            }
+        }
+        return result;
+    }
+
+    Contour ClipToRectangle(const Contour& contour, double width, double height) {
+        // Clip against each edge in turn: inside when the coordinate is on the correct side of the bound.
+        const struct {
+            bool isX;
+            double bound;
+            bool keepGreater;
+        } edges[] = {{false, 0, true}, {true, width, false}, {false, height, false}, {true, 0, true}};
+
+        Contour result = contour;
+        for (const auto& edge : edges) {
+            const auto Coordinate = [&](const Point2d& p) { return edge.isX ? p.x : p.y; };
+            const auto IsInside = [&](const Point2d& p) {
+                return edge.keepGreater ? Coordinate(p) >= edge.bound : Coordinate(p) <= edge.bound;
+            };
+
+            Contour input;
+            std::swap(input, result);
+            for (size_t i = 0; i < input.size(); i++) {
+                const Point2d& current = input[i];
+                const Point2d& following = input[(i + 1) % input.size()];
+                if (IsInside(current)) {
+                    result.push_back(current);
+                }
+                if (IsInside(current) != IsInside(following)) {
+                    const double t = (edge.bound - Coordinate(current)) / (Coordinate(following) - Coordinate(current));
+                    Point2d intersection{current.x + t * (following.x - current.x),
+                                         current.y + t * (following.y - current.y)};
+                    (edge.isX ? intersection.x : intersection.y) = edge.bound;
+                    result.push_back(intersection);
+                }
+            }
+        }
+
+        // Drop the repeated vertices.
+        Contour unique;
+        for (const Point2d& p : result) {
+            if (unique.empty() || !IsSame(unique.back(), p)) {
+                unique.push_back(p);
+            }
+        }
+        while (unique.size() > 1 && IsSame(unique.front(), unique.back())) {
+            unique.pop_back();
+        }
+        return unique;
+    }
+
+    std::vector<Contour> ComplementInRectangle(const Contour& contour, double width, double height) {
+        const Contour rectangle{{0, 0}, {width, 0}, {width, height}, {0, height}};
+        if (contour.size() < 3) {
+            return {rectangle};
+        }
+
+        std::vector<size_t> contacts;
+        for (size_t i = 0; i < contour.size(); i++) {
+            if (GetRectangleEdges(contour[i], width, height)) {
+                contacts.push_back(i);
+            }
+        }
+
+        std::vector<Contour> pockets;
+        if (contacts.empty()) {
+            // Bridge the rightmost vertex of the contour to the right edge, then walk the rectangle counter-clockwise
+            // and the contour clockwise.
+            const size_t rightmost =
+                std::max_element(contour.cbegin(), contour.cend(), [](const Point2d& a, const Point2d& b) {
+                    return a.x < b.x;
+                }) - contour.cbegin();
+            const Point2d bridge{width, contour[rightmost].y};
+            Contour pocket{bridge, {width, height}, {0, height}, {0, 0}, {width, 0}, bridge};
+            for (size_t k = 0; k <= contour.size(); k++) {
+                pocket.push_back(contour[(rightmost + contour.size() - k % contour.size()) % contour.size()]);
+            }
+            pockets.push_back(std::move(pocket));
+            return pockets;
+        }
+
+        // Each pocket is a run of the contour between two contacts, closed by the rectangle, walking it clockwise.
+        for (size_t c = 0; c < contacts.size(); c++) {
+            const size_t a = contacts[c];
+            const size_t b = contacts[(c + 1) % contacts.size()];
+            const size_t length = (b + contour.size() - a) % contour.size();
+            if (length == 1 &&
+                (GetRectangleEdges(contour[a], width, height) & GetRectangleEdges(contour[b], width, height))) {
+                continue;
+            }
+
+            Contour pocket;
+            for (size_t k = 0; k <= (length ? length : contour.size()); k++) {
+                pocket.push_back(contour[(a + k) % contour.size()]);
+            }
+            const double start = GetPerimeterPosition(contour[b], width, height);
+            double span = start - GetPerimeterPosition(contour[a], width, height);
+            if (span <= EdgeEpsilon) {
+                span += 4;
+            }
+            for (double corner = std::ceil(start - EdgeEpsilon) - 1; start - corner < span - EdgeEpsilon; corner--) {
+                pocket.push_back(GetRectangleCorner((int)corner, width, height));
+            }
+            pockets.push_back(std::move(pocket));
+        }
+        return pockets;
+    }
+
+    std::vector<uint32_t> Triangulate(const Contour& contour) {
+        std::vector<uint32_t> triangles;
+        const size_t count = contour.size();
+        if (count < 3) {
+            return triangles;
+        }
+
+        // Walk the contour counter-clockwise.
+        std::vector<uint32_t> previous(count), next(count);
+        const bool isClockwise = SignedArea(contour) < 0;
+        for (uint32_t i = 0; i < count; i++) {
+            previous[i] = (uint32_t)((i + count - 1) % count);
+            next[i] = (uint32_t)((i + 1) % count);
+            if (isClockwise) {
+                std::swap(previous[i], next[i]);
+            }
+        }
+
+        // An ear is convex, and no reflex vertex is inside of it.
+        const auto IsEar = [&](uint32_t i) {
+            const Point2d& a = contour[previous[i]];
+            const Point2d& b = contour[i];
+            const Point2d& c = contour[next[i]];
+            if (Cross(a, b, c) <= 0) {
+                return false;
+            }
+            for (uint32_t j = next[next[i]]; j != previous[i]; j = next[j]) {
+                const Point2d& p = contour[j];
+                if (Cross(contour[previous[j]], p, contour[next[j]]) <= 0 && !IsSame(p, a) && !IsSame(p, b) &&
+                    !IsSame(p, c) && IsInTriangle(p, a, b, c)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        uint32_t current = 0;
+        size_t remaining = count;
+        size_t attempts = 0;
+        while (remaining > 3) {
+            const bool isDegenerate = Cross(contour[previous[current]], contour[current], contour[next[current]]) == 0;
+            if (isDegenerate || IsEar(current) || attempts > remaining) {
+                // Degenerate vertices are dropped. When no ear is left (eg: from rounding), clip anyway.
+                if (!isDegenerate) {
+                    triangles.insert(triangles.end(), {previous[current], current, next[current]});
+                }
+                next[previous[current]] = next[current];
+                previous[next[current]] = previous[current];
+                current = previous[current];
+                remaining--;
+                attempts = 0;
+            } else {
+                current = next[current];
+                attempts++;
+            }
+        }
+        if (Cross(contour[previous[current]], contour[current], contour[next[current]]) != 0) {
+            triangles.insert(triangles.end(), {previous[current], current, next[current]});
+        }
+        return triangles;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,55 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+namespace shim_host {
+
+    struct Point2d {
+        double x;
+        double y;
+    };
+
+    // A closed polygon, without repeating the first vertex.
+    using Contour = std::vector<Point2d>;
+
+    // Positive for counter-clockwise contours (with the y axis up).
+    double SignedArea(const Contour& contour);
+
+    // Visvalingam-Whyatt simplification of a counter-clockwise contour: repeatedly remove the vertex with the smallest
+    // effective area, as long as all the removed vertices stay within the tolerance of the simplified edges. The
+    // simplified edges are then moved outwards past the removed vertices plus the margin, so that the result still
+    // contains the contour.
+    Contour SimplifyOutwards(const Contour& contour, double tolerance, double margin);
+
+    // Sutherland-Hodgman clipping to the rectangle [0, width] x [0, height]. Vertices on the edges of the rectangle
+    // are exactly on them.
+    Contour ClipToRectangle(const Contour& contour, double width, double height);
+
+    // The rectangle [0, width] x [0, height] minus a counter-clockwise contour clipped to it (see ClipToRectangle()),
+    // as simple contours: the pockets between the contour and the edges of the rectangle, or the rectangle bridged to
+    // the contour when they do not touch.
+    std::vector<Contour> ComplementInRectangle(const Contour& contour, double width, double height);
+
+    // Ear clipping of a simple contour, in either orientation. Returns 3 indices per triangle, counter-clockwise.
+    std::vector<uint32_t> Triangulate(const Contour& contour);
+
+} // namespace shim_host
@@ -0,0 +1,316 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Calibration.h"
+#include "Commands.h"
+#include "FeatureDetector.h"
+#include "Image.h"
+#include "Parallel.h"
+#include "ReferenceDistortion.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    bool ParsePair(const std::string& value, double& first, double& second) {
+        return sscanf(value.c_str(), "%lf%*[ ,]%lf", &first, &second) == 2;
+    }
+
+    int ParseEye(const std::string& name) {
+        return name == "right" || name == "1" ? vr::Eye_Right : vr::Eye_Left;
+    }
+
+    // The display pixel seen through the lens at the given distorted position, ie: the inverse of the radial
+    // distortion, by Newton iterations on the radius.
+    bool UndistortRadial(const ReferenceDistortion::Channel& c, double x, double y, double& outX, double& outY) {
+        const double dx = x - c.codX;
+        const double dy = y - c.codY;
+        const double target = std::sqrt(dx * dx + dy * dy);
+        if (target == 0) {
+            outX = x;
+            outY = y;
+            return true;
+        }
+        double r = target;
+        for (int iteration = 0; iteration < 20; iteration++) {
+            const double r2 = std::min(r * r, c.maxRadius2);
+            const double value = r * (1 + r2 * (c.k1 + r2 * (c.k2 + r2 * c.k3))) - target;
+            const double slope = 1 + r2 * (3 * c.k1 + r2 * (5 * c.k2 + r2 * 7 * c.k3));
+            if (!(slope > 0)) {
+                return false;
+            }
+            const double step = value / slope;
+            r -= step;
+            if (std::abs(step) < 1e-9 * target) {
+                outX = c.codX + dx * r / target;
+                outY = c.codY + dy * r / target;
+                return r >= 0;
+            }
+        }
+        return false;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunCapture(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host capture <output.ppm> [--pattern dots|checkerboard] [--spacing <px>] "
+                    "[--eye left|right] [--variant <name>] [--capture-width <px>] [--capture-height <px>] "
+                    "[--camera-focal <px>] [--supersampling <n>] [--gray]\n");
+            return 1;
+        }
+
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+        const DisplayGeometry geometry = DisplayGeometry::FromDisplay(&host.Vendor());
+        const std::string variant = args.Get("variant", "settings");
+        const std::optional<LensProfile> profile = LensProfile::FindVariant(
+            LensProfile::FromSettings(&host.Runtime().settings), geometry.eyeWidth[vr::Eye_Left], variant);
+        if (!profile) {
+            fprintf(stderr, "Unknown variant: %s\n", variant.c_str());
+            return 1;
+        }
+        const ReferenceDistortion reference(*profile, geometry);
+
+        const int eye = ParseEye(args.Get("eye", "left"));
+        const ReferenceDistortion::Eye& e = reference.GetEye((vr::EVREye)eye);
+        const uint32_t displayWidth = geometry.eyeWidth[eye];
+        const uint32_t displayHeight = geometry.eyeHeight[eye];
+
+        const std::string pattern = args.Get("pattern", "dots");
+        if (pattern != "dots" && pattern != "checkerboard") {
+            fprintf(stderr, "Unknown pattern: %s\n", pattern.c_str());
+            return 1;
+        }
+        const double spacing = args.GetDouble("spacing", 64);
+        double originX = displayWidth / 2.0, originY = displayHeight / 2.0;
+        ParsePair(args.Get("origin"), originX, originY);
+
+        // The camera sits at the eye, with the field of view of the display filling most of the frame.
+        const uint32_t width = (uint32_t)args.GetInt("capture-width", 5472);
+        const uint32_t height = (uint32_t)args.GetInt("capture-height", 3648);
+        const double focal = args.GetDouble(
+            "camera-focal", 0.95 * std::min(width / (e.left + e.right), height / (e.top + e.bottom)));
+        const double centerX = width / 2.0;
+        const double centerY = height / 2.0;
+        const int supersampling = (int)std::max<int64_t>(1, args.GetInt("supersampling", 2));
+        const bool gray = args.Has("gray");
+        const uint32_t threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+
+        const auto Pattern = [&](double x, double y) -> float {
+            if (x < 0 || y < 0 || x >= displayWidth || y >= displayHeight) {
+                return 0.f;
+            }
+            const double u = (x - originX) / spacing;
+            const double v = (y - originY) / spacing;
+            if (pattern == "dots") {
+                const double du = u - std::round(u);
+                const double dv = v - std::round(v);
+                return du * du + dv * dv < 0.2 * 0.2 ? 1.f : 0.f;
+            }
+            return ((int64_t)std::floor(u) + (int64_t)std::floor(v)) & 1 ? 1.f : 0.f;
+        };
+
+        Image image;
+        image.Resize(width, height, gray ? 1 : 3);
+        const auto start = std::chrono::steady_clock::now();
+        ParallelFor(threadCount, height, [&](size_t begin, size_t end) {
+            for (uint32_t y = (uint32_t)begin; y < end; y++) {
+                for (uint32_t x = 0; x < width; x++) {
+                    for (uint32_t channel = 0; channel < image.channels; channel++) {
+                        const ReferenceDistortion::Channel& c = e.channels[gray ? 1 : channel];
+                        float sum = 0;
+                        for (int sy = 0; sy < supersampling; sy++) {
+                            for (int sx = 0; sx < supersampling; sx++) {
+                                const double tangentX = (x + (sx + 0.5) / supersampling - centerX) / focal;
+                                const double tangentY = (y + (sy + 0.5) / supersampling - centerY) / focal;
+                                const double distortedX =
+                                    e.focalLengthX * tangentX + e.skewFactor * tangentY + e.principalPointX;
+                                const double distortedY = e.focalLengthY * tangentY + e.principalPointY;
+                                double displayX, displayY;
+                                if (UndistortRadial(c, distortedX, distortedY, displayX, displayY)) {
+                                    sum += Pattern(displayX, displayY);
+                                }
+                            }
+                        }
+                        const float value = 0.1f + 0.8f * sum / (supersampling * supersampling);
+                        image.Pixel(x, y)[channel] = (uint8_t)std::lround(value * 255);
+                    }
+                }
+            }
+        });
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Everything the detect command needs to turn the features into correspondences.
+        char buffer[64];
+        image.metadata["pattern"] = pattern;
+        image.metadata["spacing"] = std::to_string(spacing);
+        snprintf(buffer, sizeof(buffer), "%.9g %.9g", originX, originY);
+        image.metadata["origin"] = buffer;
+        image.metadata["eye"] = EyeNames[eye];
+        snprintf(buffer, sizeof(buffer), "%u %u", geometry.eyeWidth[vr::Eye_Left], geometry.eyeHeight[vr::Eye_Left]);
+        image.metadata["eye_size"] = buffer;
+        snprintf(buffer, sizeof(buffer), "%.9g", focal);
+        image.metadata["camera_focal"] = buffer;
+        snprintf(buffer, sizeof(buffer), "%.9g %.9g", centerX, centerY);
+        image.metadata["camera_center"] = buffer;
+        image.metadata["variant"] = variant;
+
+        if (!SavePnm(args.Positional()[0], image)) {
+            fprintf(stderr, "Failed to write %s\n", args.Positional()[0].c_str());
+            return 1;
+        }
+        printf("Rendered a %ux%u capture of %s (%s eye, profile %s) in %.3f s to %s\n",
+               width,
+               height,
+               pattern.c_str(),
+               EyeNames[eye],
+               variant.c_str(),
+               seconds,
+               args.Positional()[0].c_str());
+        return 0;
+    }
+
+    int RunDetect(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host detect <capture.pgm|ppm> [--output <correspondences>] [--append] "
+                    "[--pattern dots|checkerboard] [--spacing <px>] [--origin <x,y>] [--eye left|right] "
+                    "[--camera-focal <px>] [--camera-center <x,y>] [--anchor <x,y>] [--threads <n>]\n");
+            return 1;
+        }
+
+        const auto loadStart = std::chrono::steady_clock::now();
+        Image image;
+        if (!LoadPnm(args.Positional()[0], image)) {
+            fprintf(stderr, "Failed to read %s\n", args.Positional()[0].c_str());
+            return 1;
+        }
+        const double loadSeconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+        // The options override what a simulated capture recorded in its header.
+        const auto Get = [&](const std::string& name, const std::string& key) {
+            const auto it = image.metadata.find(key);
+            return args.Get(name, it != image.metadata.end() ? it->second : "");
+        };
+        const std::string pattern = Get("pattern", "pattern").empty() ? "dots" : Get("pattern", "pattern");
+        const double spacing = atof(Get("spacing", "spacing").c_str());
+        const double focal = atof(Get("camera-focal", "camera_focal").c_str());
+        if (spacing <= 0 || focal <= 0) {
+            fprintf(stderr, "The pattern spacing and the camera focal length are required\n");
+            return 1;
+        }
+        const int eye = ParseEye(Get("eye", "eye"));
+        const ShimHost::Options hostOptions = ShimHost::OptionsFromArguments(args);
+        double eyeWidth = hostOptions.display.eyeWidth, eyeHeight = hostOptions.display.eyeHeight;
+        ParsePair(Get("eye-size", "eye_size"), eyeWidth, eyeHeight);
+        double originX = eyeWidth / 2, originY = eyeHeight / 2;
+        ParsePair(Get("origin", "origin"), originX, originY);
+        double centerX = image.width / 2.0, centerY = image.height / 2.0;
+        ParsePair(Get("camera-center", "camera_center"), centerX, centerY);
+        double anchorX = centerX, anchorY = centerY;
+        ParsePair(args.Get("anchor"), anchorX, anchorY);
+
+        DetectorOptions options;
+        options.threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+        options.window = (int)args.GetInt("window", options.window);
+        options.contrast = (float)args.GetDouble("contrast", options.contrast);
+        options.sigma = args.GetDouble("sigma", options.sigma);
+        options.suppressionRadius = (int)args.GetInt("suppression", options.suppressionRadius);
+        options.refinementRadius = (int)args.GetInt("refinement", options.refinementRadius);
+        options.responseThreshold = (float)args.GetDouble("response", options.responseThreshold);
+
+        CorrespondenceSet set;
+        const std::string output = args.Get("output");
+        if (args.Has("append") && !output.empty() && !LoadCorrespondences(output, set)) {
+            set = {};
+        }
+        set.eyeWidth = (uint32_t)eyeWidth;
+        set.eyeHeight = (uint32_t)eyeHeight;
+
+        printf("%s: %ux%u, %u channel(s), loaded in %.3f s\n",
+               args.Positional()[0].c_str(),
+               image.width,
+               image.height,
+               image.channels,
+               loadSeconds);
+        for (uint32_t channel = 0; channel < image.channels; channel++) {
+            const auto start = std::chrono::steady_clock::now();
+            const Plane plane = ExtractPlane(image, channel, options.threadCount);
+            const std::vector<Feature> features = pattern == "checkerboard"
+                                                      ? DetectCheckerboardCorners(plane, options)
+                                                      : DetectDots(plane, options);
+            const std::vector<GridFeature> grid = AssignGrid(features, anchorX, anchorY);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            // A gray capture measures the same features for all the channels.
+            size_t added = 0;
+            for (const GridFeature& feature : grid) {
+                const double displayX = originX + feature.column * spacing;
+                const double displayY = originY + feature.row * spacing;
+                if (displayX < 0 || displayY < 0 || displayX > eyeWidth || displayY > eyeHeight) {
+                    continue;
+                }
+                for (int target = 0; target < 3; target++) {
+                    if (image.channels == 3 && target != (int)channel) {
+                        continue;
+                    }
+                    Correspondence point;
+                    point.eye = (uint8_t)eye;
+                    point.channel = (uint8_t)target;
+                    point.x = (float)displayX;
+                    point.y = (float)displayY;
+                    point.tangentX = (float)((feature.feature.x - centerX) / focal);
+                    point.tangentY = (float)((feature.feature.y - centerY) / focal);
+                    set.points.push_back(point);
+                }
+                added++;
+            }
+            printf("%s: %zu features, %zu on the grid, %.3f s (%.1f Mpixels/s)\n",
+                   image.channels == 3 ? ChannelNames[channel] : "gray",
+                   features.size(),
+                   added,
+                   seconds,
+                   image.width * (double)image.height / seconds / 1e6);
+        }
+
+        if (!output.empty()) {
+            if (!SaveCorrespondences(output, set)) {
+                fprintf(stderr, "Failed to write %s\n", output.c_str());
+                return 1;
+            }
+            printf("Wrote %zu correspondences to %s\n", set.points.size(), output.c_str());
+        }
+        return 0;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "LensProfile.h"
+#include "ShimHost.h"
+
+namespace {
+
+    // A residual grid of small offsets, for the pipeline benchmarks.
+    bool WriteResidualGrid(const std::string& path) {
+        std::ofstream file(path);
+        const int size = 9;
+        file << size << " " << size << "\n";
+        for (int eye = 0; eye < 2; eye++) {
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    file << 0.5f * std::sin(x + eye) << " " << 0.5f * std::cos(y) << "\n";
+                }
+            }
+        }
+        return !!file;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    void RunDistortionBenchmarks(BenchmarkRunner& runner, const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return;
+        }
+
+        vr::IVRDisplayComponent* const display = host.Display();
+        const auto RunSizes = [&](const std::string& prefix) {
+            for (const auto& size : args.GetList("sizes", "16,32,64,128,256,512")) {
+                const int n = std::max(2, atoi(size.c_str()));
+
+                // Sample both eyes in row-major order, like the compositor does.
+                runner.Run(prefix + std::to_string(n), 2.0 * n * n, [&](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++) {
+                        for (int eye = 0; eye < 2; eye++) {
+                            for (int y = 0; y < n; y++) {
+                                const float v = (float)y / (n - 1);
+                                for (int x = 0; x < n; x++) {
+                                    const float u = (float)x / (n - 1);
+                                    DoNotOptimize(display->ComputeDistortion((vr::EVREye)eye, u, v));
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+        };
+
+        const LensProfile baseProfile = LensProfile::FromSettings(&host.Runtime().settings);
+        const auto variants = LensProfile::Variants(baseProfile, host.Vendor().Script().eyeWidth);
+        for (const auto& variant : variants) {
+            host.ChangeSettings([&](FakeSettings& settings) { variant.second.ToSettings(&settings); });
+            RunSizes("ComputeDistortion/" + variant.first + "/");
+        }
+
+        // Baked pipelines cost the same whatever their number of stages.
+        const std::string residualPath =
+            (std::filesystem::temp_directory_path() / "shim_host_bench_residual.txt").string();
+        if (!WriteResidualGrid(residualPath)) {
+            return;
+        }
+        for (const char* pipeline : {"brown_conrady",
+                                     "brown_conrady,vendor",
+                                     "ipd_shift,brown_conrady,vendor",
+                                     "ipd_shift,residual,brown_conrady,vendor"}) {
+            host.ChangeSettings([&](FakeSettings& settings) {
+                baseProfile.ToSettings(&settings);
+                settings.SetString("driver_distortion_shim", "pipeline", pipeline);
+                settings.SetString("driver_distortion_shim", "residual_file", residualPath.c_str());
+                settings.SetFloat("driver_distortion_shim", "ipd_shift", 1.f);
+            });
+            std::string name = pipeline;
+            std::replace(name.begin(), name.end(), ',', '+');
+            RunSizes("ComputeDistortion/pipeline:" + name + "/");
+        }
+
+        // The tables in floats against quantized, which halves the memory read by each lookup.
+        for (const float maxError : {0.f, 0.05f}) {
+            host.ChangeSettings([&](FakeSettings& settings) {
+                settings.SetString("driver_distortion_shim", "pipeline", "ipd_shift,residual,brown_conrady,vendor");
+                settings.SetFloat("driver_distortion_shim", "quantized_table_max_error", maxError);
+            });
+            RunSizes(std::string("ComputeDistortion/table:") + (maxError > 0 ? "unorm16" : "float32") + "/");
+        }
+        std::error_code error;
+        std::filesystem::remove(residualPath, error);
+    }
+
+} // namespace shim_host
@@ -0,0 +1,233 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+#include "LensProfile.h"
+#include "MappedFile.h"
+#include "ShimHost.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+    using namespace shim_host;
+
+    // The input is packed little-endian float pairs (u, v). The forward distortion writes the red, green and blue
+    // coordinates for each point, the inverse distortion writes one pair.
+    constexpr size_t InputStride = 2;
+
+    const float* Channel(const vr::DistortionCoordinates_t& coordinates, int channel) {
+        return channel == 0 ? coordinates.rfRed : channel == 1 ? coordinates.rfGreen : coordinates.rfBlue;
+    }
+
+    // Solve ComputeDistortion(u, v) = target for one channel by Newton iterations, with the Jacobian from finite
+    // differences. NaN when it does not converge (eg: past the fold-over of the model).
+    void InverseDistortion(
+        vr::IVRDisplayComponent* display, vr::EVREye eye, int channel, float targetU, float targetV, float* result) {
+        constexpr float h = 1e-3f;
+        float u = targetU, v = targetV;
+        for (int iteration = 0; iteration < 20; iteration++) {
+            const vr::DistortionCoordinates_t coordinates = display->ComputeDistortion(eye, u, v);
+            const float* const at = Channel(coordinates, channel);
+            const float errorU = at[0] - targetU;
+            const float errorV = at[1] - targetV;
+            if (std::abs(errorU) < 1e-6f && std::abs(errorV) < 1e-6f) {
+                result[0] = u;
+                result[1] = v;
+                return;
+            }
+            const vr::DistortionCoordinates_t alongU = display->ComputeDistortion(eye, u + h, v);
+            const vr::DistortionCoordinates_t alongV = display->ComputeDistortion(eye, u, v + h);
+            const float a = (Channel(alongU, channel)[0] - at[0]) / h, b = (Channel(alongV, channel)[0] - at[0]) / h;
+            const float c = (Channel(alongU, channel)[1] - at[1]) / h, d = (Channel(alongV, channel)[1] - at[1]) / h;
+            const float determinant = a * d - b * c;
+            if (!(std::abs(determinant) > 1e-12f)) {
+                break;
+            }
+            u -= (d * errorU - b * errorV) / determinant;
+            v -= (a * errorV - c * errorU) / determinant;
+        }
+        result[0] = result[1] = std::numeric_limits<float>::quiet_NaN();
+    }
+
+    // Evaluate the points over several threads, handing out blocks that fit in the cache one at a time, so that the
+    // threads move through the input together.
+    void EvaluateBlocks(vr::IVRDisplayComponent* display,
+                        vr::EVREye eye,
+                        int inverseChannel,
+                        const float* input,
+                        float* output,
+                        size_t count,
+                        size_t blockSize,
+                        uint32_t threadCount) {
+        const size_t outputStride = inverseChannel >= 0 ? 2 : 6;
+        const size_t blockCount = (count + blockSize - 1) / blockSize;
+        std::atomic<size_t> nextBlock{0};
+        const auto Run = [&] {
+            size_t block;
+            while ((block = nextBlock++) < blockCount) {
+                const size_t end = std::min(count, (block + 1) * blockSize);
+                for (size_t i = block * blockSize; i < end; i++) {
+                    const float u = input[i * InputStride];
+                    const float v = input[i * InputStride + 1];
+                    float* const result = output + i * outputStride;
+                    if (inverseChannel >= 0) {
+                        InverseDistortion(display, eye, inverseChannel, u, v, result);
+                    } else {
+                        const vr::DistortionCoordinates_t coordinates = display->ComputeDistortion(eye, u, v);
+                        memcpy(result, coordinates.rfRed, sizeof(float) * 2);
+                        memcpy(result + 2, coordinates.rfGreen, sizeof(float) * 2);
+                        memcpy(result + 4, coordinates.rfBlue, sizeof(float) * 2);
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < std::min<size_t>(threadCount, blockCount); i++) {
+            threads.emplace_back(Run);
+        }
+        Run();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunEvaluate(const Arguments& args) {
+        if (args.Positional().size() < 2) {
+            fprintf(stderr,
+                    "Usage: shim_host evaluate <input|-> <output|-> [--eye left|right] [--inverse <red|green|blue>] "
+                    "[--block <points>] [--threads <n>]\n");
+            return 1;
+        }
+
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+        vr::IVRDisplayComponent* const display = host.Display();
+
+        const vr::EVREye eye = args.Get("eye", "left") == "right" ? vr::Eye_Right : vr::Eye_Left;
+        int inverseChannel = -1;
+        if (args.Has("inverse")) {
+            const std::string name = args.Get("inverse", "green");
+            for (int channel = 0; channel < 3; channel++) {
+                if (name == ChannelNames[channel]) {
+                    inverseChannel = channel;
+                }
+            }
+            if (inverseChannel < 0) {
+                fprintf(stderr, "Unknown channel: %s\n", name.c_str());
+                return 1;
+            }
+        }
+        const size_t outputStride = inverseChannel >= 0 ? 2 : 6;
+        const size_t blockSize = (size_t)std::max<int64_t>(1, args.GetInt("block", 8192));
+        const uint32_t threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+
+        const std::string inputPath = args.Positional()[0];
+        const std::string outputPath = args.Positional()[1];
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t count = 0;
+        if (inputPath != "-" && outputPath != "-") {
+            // Both files are mapped: the results are written in place in the output mapping.
+            MappedFile input, output;
+            if (!input.OpenRead(inputPath)) {
+                fprintf(stderr, "Failed to read %s\n", inputPath.c_str());
+                return 1;
+            }
+            count = input.Size() / (InputStride * sizeof(float));
+            if (!output.Create(outputPath, count * outputStride * sizeof(float))) {
+                fprintf(stderr, "Failed to write %s\n", outputPath.c_str());
+                return 1;
+            }
+            EvaluateBlocks(display,
+                           eye,
+                           inverseChannel,
+                           (const float*)input.Data(),
+                           (float*)output.Data(),
+                           count,
+                           blockSize,
+                           threadCount);
+        } else {
+            // Streams are read and written in chunks of a few blocks per thread.
+            FILE* const input = inputPath == "-" ? stdin : fopen(inputPath.c_str(), "rb");
+            FILE* const output = outputPath == "-" ? stdout : fopen(outputPath.c_str(), "wb");
+            if (!input || !output) {
+                fprintf(stderr, "Failed to open %s\n", !input ? inputPath.c_str() : outputPath.c_str());
+                if (input && input != stdin) {
+                    fclose(input);
+                }
+                if (output && output != stdout) {
+                    fclose(output);
+                }
+                return 1;
+            }
+#ifdef _WIN32
+            _setmode(_fileno(input), _O_BINARY);
+            _setmode(_fileno(output), _O_BINARY);
+#endif
+            const size_t chunkSize = blockSize * std::max(1u, threadCount) * 4;
+            std::vector<float> inputChunk(chunkSize * InputStride);
+            std::vector<float> outputChunk(chunkSize * outputStride);
+            bool success = true;
+            size_t read;
+            while ((read = fread(inputChunk.data(), InputStride * sizeof(float), chunkSize, input)) > 0) {
+                EvaluateBlocks(
+                    display, eye, inverseChannel, inputChunk.data(), outputChunk.data(), read, blockSize, threadCount);
+                success = success && fwrite(outputChunk.data(), outputStride * sizeof(float), read, output) == read;
+                count += read;
+            }
+            success = success && !ferror(input) && fflush(output) == 0;
+            if (input != stdin) {
+                fclose(input);
+            }
+            if (output != stdout) {
+                fclose(output);
+            }
+            if (!success) {
+                fprintf(stderr, "Failed to stream the points\n");
+                return 1;
+            }
+        }
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr,
+                "Evaluated %llu points (%s, %s eye) in %.3f s (%.1f Mpoints/s)\n",
+                (unsigned long long)count,
+                inverseChannel >= 0 ? "inverse" : "forward",
+                EyeNames[eye],
+                seconds,
+                count / std::max(seconds, 1e-9) / 1e6);
+        return 0;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,677 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "FakeRuntime.h"
+
+namespace {
+    using namespace shim_host;
+
+    // Just enough JSON to read .vrsettings files: an object of sections, each an object of scalar values.
+    struct VrSettingsParser {
+        const char* cur;
+        const char* end;
+
+        void SkipWhitespace() {
+            while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\n')) {
+                cur++;
+            }
+        }
+
+        bool Expect(char c) {
+            SkipWhitespace();
+            if (cur < end && *cur == c) {
+                cur++;
+                return true;
+            }
+            return false;
+        }
+
+        bool ParseString(std::string& out) {
+            if (!Expect('"')) {
+                return false;
+            }
+            out.clear();
+            while (cur < end && *cur != '"') {
+                if (*cur == '\\' && cur + 1 < end) {
+                    cur++;
+                    switch (*cur) {
+                    case 'n':
+                        out += '\n';
+                        break;
+                    case 't':
+                        out += '\t';
+                        break;
+                    default:
+                        out += *cur;
+                        break;
+                    }
+                } else {
+                    out += *cur;
+                }
+                cur++;
+            }
+            return Expect('"');
+        }
+
+        bool ParseValue(FakeSettings::Value& out) {
+            SkipWhitespace();
+            if (cur >= end) {
+                return false;
+            }
+            if (*cur == '"') {
+                out.type = FakeSettings::Value::Type::String;
+                return ParseString(out.string);
+            } else if (end - cur >= 4 && !strncmp(cur, "true", 4)) {
+                out.type = FakeSettings::Value::Type::Bool;
+                out.boolean = true;
+                cur += 4;
+                return true;
+            } else if (end - cur >= 5 && !strncmp(cur, "false", 5)) {
+                out.type = FakeSettings::Value::Type::Bool;
+                out.boolean = false;
+                cur += 5;
+                return true;
+            }
+            char* numberEnd = nullptr;
+            out.type = FakeSettings::Value::Type::Number;
+            out.number = strtod(cur, &numberEnd);
+            if (numberEnd == cur) {
+                return false;
+            }
+            cur = numberEnd;
+            return true;
+        }
+
+        template <typename TCallback>
+        bool ParseObject(TCallback callback) {
+            if (!Expect('{')) {
+                return false;
+            }
+            if (Expect('}')) {
+                return true;
+            }
+            do {
+                std::string key;
+                if (!ParseString(key) || !Expect(':') || !callback(key)) {
+                    return false;
+                }
+            } while (Expect(','));
+            return Expect('}');
+        }
+    };
+
+} // namespace
+
+namespace shim_host {
+
+    bool FakeSettings::LoadFromFile(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        std::string content;
+        char buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            content.append(buffer, read);
+        }
+        fclose(file);
+
+        VrSettingsParser parser{content.data(), content.data() + content.size()};
+        return parser.ParseObject([&](const std::string& section) {
+            return parser.ParseObject([&](const std::string& key) {
+                Value value;
+                if (!parser.ParseValue(value)) {
+                    return false;
+                }
+                Store(section.c_str(), key.c_str(), std::move(value), nullptr);
+                return true;
+            });
+        });
+    }
+
+    bool FakeSettings::SaveToFile(const std::string& path) const {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+
+        const auto WriteString = [&](const std::string& string) {
+            fputc('"', file);
+            for (const char c : string) {
+                if (c == '"' || c == '\\') {
+                    fputc('\\', file);
+                    fputc(c, file);
+                } else if (c == '\n') {
+                    fputs("\\n", file);
+                } else if (c == '\t') {
+                    fputs("\\t", file);
+                } else {
+                    fputc(c, file);
+                }
+            }
+            fputc('"', file);
+        };
+
+        std::unique_lock lock(m_mutex);
+        fprintf(file, "{");
+        bool firstSection = true;
+        for (const auto& section : m_sections) {
+            fprintf(file, "%s\n  ", firstSection ? "" : ",");
+            WriteString(section.first);
+            fprintf(file, ": {");
+            bool firstKey = true;
+            for (const auto& entry : section.second) {
+                fprintf(file, "%s\n    ", firstKey ? "" : ",");
+                WriteString(entry.first);
+                fprintf(file, ": ");
+                switch (entry.second.type) {
+                case Value::Type::Bool:
+                    fprintf(file, "%s", entry.second.boolean ? "true" : "false");
+                    break;
+                case Value::Type::Number:
+                    // Enough digits to read back the exact float.
+                    fprintf(file, "%.9g", entry.second.number);
+                    break;
+                case Value::Type::String:
+                    WriteString(entry.second.string);
+                    break;
+                }
+                firstKey = false;
+            }
+            fprintf(file, "\n  }");
+            firstSection = false;
+        }
+        fprintf(file, "\n}\n");
+
+        const bool success = !ferror(file);
+        fclose(file);
+        return success;
+    }
+
+    const char* FakeSettings::GetSettingsErrorNameFromEnum(vr::EVRSettingsError eError) {
+        switch (eError) {
+        case vr::VRSettingsError_None:
+            return "VRSettingsError_None";
+        case vr::VRSettingsError_UnsetSettingHasNoDefault:
+            return "VRSettingsError_UnsetSettingHasNoDefault";
+        default:
+            return "VRSettingsError_Unknown";
+        }
+    }
+
+    void FakeSettings::SetBool(const char* pchSection,
+                               const char* pchSettingsKey,
+                               bool bValue,
+                               vr::EVRSettingsError* peError) {
+        Value value;
+        value.type = Value::Type::Bool;
+        value.boolean = bValue;
+        Store(pchSection, pchSettingsKey, std::move(value), peError);
+    }
+
+    void FakeSettings::SetInt32(const char* pchSection,
+                                const char* pchSettingsKey,
+                                int32_t nValue,
+                                vr::EVRSettingsError* peError) {
+        Value value;
+        value.number = nValue;
+        Store(pchSection, pchSettingsKey, std::move(value), peError);
+    }
+
+    void FakeSettings::SetFloat(const char* pchSection,
+                                const char* pchSettingsKey,
+                                float flValue,
+                                vr::EVRSettingsError* peError) {
+        Value value;
+        value.number = flValue;
+        Store(pchSection, pchSettingsKey, std::move(value), peError);
+    }
+
+    void FakeSettings::SetString(const char* pchSection,
+                                 const char* pchSettingsKey,
+                                 const char* pchValue,
+                                 vr::EVRSettingsError* peError) {
+        Value value;
+        value.type = Value::Type::String;
+        value.string = pchValue;
+        Store(pchSection, pchSettingsKey, std::move(value), peError);
+    }
+
+    bool FakeSettings::GetBool(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError) {
+        std::unique_lock lock(m_mutex);
+        const Value* value = Find(pchSection, pchSettingsKey, peError);
+        if (!value) {
+            return false;
+        }
+        return value->type == Value::Type::Bool ? value->boolean : value->number != 0.0;
+    }
+
+    int32_t FakeSettings::GetInt32(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError) {
+        std::unique_lock lock(m_mutex);
+        const Value* value = Find(pchSection, pchSettingsKey, peError);
+        if (!value) {
+            return 0;
+        }
+        return value->type == Value::Type::Bool ? (int32_t)value->boolean : (int32_t)value->number;
+    }
+
+    float FakeSettings::GetFloat(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError) {
+        std::unique_lock lock(m_mutex);
+        const Value* value = Find(pchSection, pchSettingsKey, peError);
+        if (!value) {
+            return 0.f;
+        }
+        return value->type == Value::Type::Bool ? (float)value->boolean : (float)value->number;
+    }
+
+    void FakeSettings::GetString(const char* pchSection,
+                                 const char* pchSettingsKey,
+                                 char* pchValue,
+                                 uint32_t unValueLen,
+                                 vr::EVRSettingsError* peError) {
+        std::unique_lock lock(m_mutex);
+        if (unValueLen) {
+            pchValue[0] = 0;
+        }
+        const Value* value = Find(pchSection, pchSettingsKey, peError);
+        if (!value || value->type != Value::Type::String || !unValueLen) {
+            return;
+        }
+        const size_t length = std::min<size_t>(value->string.size(), unValueLen - 1);
+        memcpy(pchValue, value->string.data(), length);
+        pchValue[length] = 0;
+    }
+
+    void FakeSettings::RemoveSection(const char* pchSection, vr::EVRSettingsError* peError) {
+        std::unique_lock lock(m_mutex);
+        m_sections.erase(pchSection);
+        if (peError) {
+            *peError = vr::VRSettingsError_None;
+        }
+    }
+
+    void FakeSettings::RemoveKeyInSection(const char* pchSection,
+                                          const char* pchSettingsKey,
+                                          vr::EVRSettingsError* peError) {
+        std::unique_lock lock(m_mutex);
+        auto it = m_sections.find(pchSection);
+        if (it != m_sections.end()) {
+            it->second.erase(pchSettingsKey);
+        }
+        if (peError) {
+            *peError = vr::VRSettingsError_None;
+        }
+    }
+
+    const FakeSettings::Value* FakeSettings::Find(const char* pchSection,
+                                                  const char* pchSettingsKey,
+                                                  vr::EVRSettingsError* peError) const {
+        const Value* value = nullptr;
+        auto section = m_sections.find(pchSection);
+        if (section != m_sections.end()) {
+            auto it = section->second.find(pchSettingsKey);
+            if (it != section->second.end()) {
+                value = &it->second;
+            }
+        }
+        if (peError) {
+            *peError = value ? vr::VRSettingsError_None : vr::VRSettingsError_UnsetSettingHasNoDefault;
+        }
+        return value;
+    }
+
+    void FakeSettings::Store(const char* pchSection,
+                             const char* pchSettingsKey,
+                             Value value,
+                             vr::EVRSettingsError* peError) {
+        std::unique_lock lock(m_mutex);
+        m_sections[pchSection][pchSettingsKey] = std::move(value);
+        if (peError) {
+            *peError = vr::VRSettingsError_None;
+        }
+    }
+
+    vr::ETrackedPropertyError FakeProperties::ReadPropertyBatch(vr::PropertyContainerHandle_t ulContainerHandle,
+                                                                vr::PropertyRead_t* pBatch,
+                                                                uint32_t unBatchEntryCount) {
+        std::unique_lock lock(m_mutex);
+        auto container = m_containers.find(ulContainerHandle);
+        if (container == m_containers.end()) {
+            return vr::TrackedProp_InvalidContainer;
+        }
+        for (uint32_t i = 0; i < unBatchEntryCount; i++) {
+            vr::PropertyRead_t& read = pBatch[i];
+            auto it = container->second.find(read.prop);
+            if (it == container->second.end()) {
+                read.eError = vr::TrackedProp_UnknownProperty;
+                continue;
+            }
+            const Property& property = it->second;
+            read.unTag = property.tag;
+            read.unRequiredBufferSize = (uint32_t)property.data.size();
+            if (property.error != vr::TrackedProp_Success) {
+                read.eError = property.error;
+            } else if (read.unBufferSize < property.data.size()) {
+                read.eError = vr::TrackedProp_BufferTooSmall;
+            } else {
+                memcpy(read.pvBuffer, property.data.data(), property.data.size());
+                read.eError = vr::TrackedProp_Success;
+            }
+        }
+        return vr::TrackedProp_Success;
+    }
+
+    vr::ETrackedPropertyError FakeProperties::WritePropertyBatch(vr::PropertyContainerHandle_t ulContainerHandle,
+                                                                 vr::PropertyWrite_t* pBatch,
+                                                                 uint32_t unBatchEntryCount) {
+        if (ulContainerHandle == vr::k_ulInvalidPropertyContainer) {
+            return vr::TrackedProp_InvalidContainer;
+        }
+        std::unique_lock lock(m_mutex);
+        auto& container = m_containers[ulContainerHandle];
+        for (uint32_t i = 0; i < unBatchEntryCount; i++) {
+            vr::PropertyWrite_t& write = pBatch[i];
+            switch (write.writeType) {
+            case vr::PropertyWrite_Set: {
+                Property& property = container[write.prop];
+                property.tag = write.unTag;
+                property.error = vr::TrackedProp_Success;
+                property.data.assign((const uint8_t*)write.pvBuffer,
+                                     (const uint8_t*)write.pvBuffer + write.unBufferSize);
+                break;
+            }
+            case vr::PropertyWrite_Erase:
+                container.erase(write.prop);
+                break;
+            case vr::PropertyWrite_SetError:
+                container[write.prop].error = write.eSetError;
+                break;
+            }
+            write.eError = vr::TrackedProp_Success;
+        }
+        return vr::TrackedProp_Success;
+    }
+
+    const char* FakeProperties::GetPropErrorNameFromEnum(vr::ETrackedPropertyError error) {
+        switch (error) {
+        case vr::TrackedProp_Success:
+            return "TrackedProp_Success";
+        case vr::TrackedProp_UnknownProperty:
+            return "TrackedProp_UnknownProperty";
+        case vr::TrackedProp_BufferTooSmall:
+            return "TrackedProp_BufferTooSmall";
+        case vr::TrackedProp_InvalidContainer:
+            return "TrackedProp_InvalidContainer";
+        default:
+            return "TrackedProp_Unknown";
+        }
+    }
+
+    vr::PropertyContainerHandle_t FakeProperties::TrackedDeviceToPropertyContainer(vr::TrackedDeviceIndex_t nDevice) {
+        if (nDevice == vr::k_unTrackedDeviceIndexInvalid) {
+            return vr::k_ulInvalidPropertyContainer;
+        }
+        std::unique_lock lock(m_mutex);
+        const vr::PropertyContainerHandle_t handle = (vr::PropertyContainerHandle_t)nDevice + 1;
+        m_containers[handle];
+        return handle;
+    }
+
+    bool FakeServerDriverHost::TrackedDeviceAdded(const char* pchDeviceSerialNumber,
+                                                  vr::ETrackedDeviceClass eDeviceClass,
+                                                  vr::ITrackedDeviceServerDriver* pDriver) {
+        uint32_t deviceIndex;
+        {
+            std::unique_lock lock(m_mutex);
+            deviceIndex = (uint32_t)m_devices.size();
+            if (deviceIndex >= vr::k_unMaxTrackedDeviceCount) {
+                return false;
+            }
+            m_devices.push_back({pchDeviceSerialNumber, eDeviceClass, pDriver});
+        }
+
+        // vrserver activates asynchronously, but activating right away is enough for our purpose.
+        return pDriver->Activate(deviceIndex) == vr::VRInitError_None;
+    }
+
+    void FakeServerDriverHost::TrackedDevicePoseUpdated(uint32_t unWhichDevice,
+                                                        const vr::DriverPose_t& newPose,
+                                                        uint32_t unPoseStructSize) {
+    }
+
+    void FakeServerDriverHost::VsyncEvent(double vsyncTimeOffsetSeconds) {
+    }
+
+    void FakeServerDriverHost::VendorSpecificEvent(uint32_t unWhichDevice,
+                                                   vr::EVREventType eventType,
+                                                   const vr::VREvent_Data_t& eventData,
+                                                   double eventTimeOffset) {
+        if (eventType == vr::VREvent_LensDistortionChanged) {
+            lensDistortionChangedCount++;
+        }
+        if (onVendorEvent) {
+            onVendorEvent(unWhichDevice, eventType);
+        }
+    }
+
+    bool FakeServerDriverHost::IsExiting() {
+        return false;
+    }
+
+    bool FakeServerDriverHost::PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent) {
+        std::unique_lock lock(m_mutex);
+        if (m_events.empty() || uncbVREvent < sizeof(vr::VREvent_t)) {
+            return false;
+        }
+        *pEvent = m_events.front();
+        m_events.pop_front();
+        return true;
+    }
+
+    void FakeServerDriverHost::GetRawTrackedDevicePoses(float fPredictedSecondsFromNow,
+                                                        vr::TrackedDevicePose_t* pTrackedDevicePoseArray,
+                                                        uint32_t unTrackedDevicePoseArrayCount) {
+        memset(pTrackedDevicePoseArray, 0, sizeof(vr::TrackedDevicePose_t) * unTrackedDevicePoseArrayCount);
+    }
+
+    void FakeServerDriverHost::RequestRestart(const char* pchLocalizedReason,
+                                              const char* pchExecutableToStart,
+                                              const char* pchArguments,
+                                              const char* pchWorkingDirectory) {
+    }
+
+    uint32_t FakeServerDriverHost::GetFrameTimings(vr::Compositor_FrameTiming* pTiming, uint32_t nFrames) {
+        return 0;
+    }
+
+    void FakeServerDriverHost::SetDisplayEyeToHead(uint32_t unWhichDevice,
+                                                   const vr::HmdMatrix34_t& eyeToHeadLeft,
+                                                   const vr::HmdMatrix34_t& eyeToHeadRight) {
+    }
+
+    void FakeServerDriverHost::SetDisplayProjectionRaw(uint32_t unWhichDevice,
+                                                       const vr::HmdRect2_t& eyeLeft,
+                                                       const vr::HmdRect2_t& eyeRight) {
+    }
+
+    void FakeServerDriverHost::SetRecommendedRenderTargetSize(uint32_t unWhichDevice,
+                                                              uint32_t nWidth,
+                                                              uint32_t nHeight) {
+    }
+
+    void FakeServerDriverHost::QueueEvent(vr::EVREventType eventType, vr::TrackedDeviceIndex_t deviceIndex) {
+        vr::VREvent_t event{};
+        event.eventType = eventType;
+        event.trackedDeviceIndex = deviceIndex;
+
+        std::unique_lock lock(m_mutex);
+        m_events.push_back(event);
+    }
+
+    std::vector<FakeServerDriverHost::Device> FakeServerDriverHost::GetDevices() const {
+        std::unique_lock lock(m_mutex);
+        return m_devices;
+    }
+
+    bool FakeAdapterServerDriverHost::TrackedDeviceAdded(const char* pchDeviceSerialNumber,
+                                                         vr::ETrackedDeviceClass eDeviceClass,
+                                                         vr::ITrackedDeviceServerDriver* pDriver) {
+        return m_target->TrackedDeviceAdded(pchDeviceSerialNumber, eDeviceClass, pDriver);
+    }
+
+    void FakeAdapterServerDriverHost::TrackedDevicePoseUpdated(uint32_t unWhichDevice,
+                                                               const vr::DriverPose_t& newPose,
+                                                               uint32_t unPoseStructSize) {
+        m_target->TrackedDevicePoseUpdated(unWhichDevice, newPose, unPoseStructSize);
+    }
+
+    void FakeAdapterServerDriverHost::VsyncEvent(double vsyncTimeOffsetSeconds) {
+        m_target->VsyncEvent(vsyncTimeOffsetSeconds);
+    }
+
+    void FakeAdapterServerDriverHost::VendorSpecificEvent(uint32_t unWhichDevice,
+                                                          vr::EVREventType eventType,
+                                                          const vr::VREvent_Data_t& eventData,
+                                                          double eventTimeOffset) {
+        m_target->VendorSpecificEvent(unWhichDevice, eventType, eventData, eventTimeOffset);
+    }
+
+    bool FakeAdapterServerDriverHost::IsExiting() {
+        return m_target->IsExiting();
+    }
+
+    bool FakeAdapterServerDriverHost::PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent) {
+        return m_target->PollNextEvent(pEvent, uncbVREvent);
+    }
+
+    void FakeAdapterServerDriverHost::GetRawTrackedDevicePoses(float fPredictedSecondsFromNow,
+                                                               vr::TrackedDevicePose_t* pTrackedDevicePoseArray,
+                                                               uint32_t unTrackedDevicePoseArrayCount) {
+        m_target->GetRawTrackedDevicePoses(
+            fPredictedSecondsFromNow, pTrackedDevicePoseArray, unTrackedDevicePoseArrayCount);
+    }
+
+    void FakeAdapterServerDriverHost::RequestRestart(const char* pchLocalizedReason,
+                                                     const char* pchExecutableToStart,
+                                                     const char* pchArguments,
+                                                     const char* pchWorkingDirectory) {
+        m_target->RequestRestart(pchLocalizedReason, pchExecutableToStart, pchArguments, pchWorkingDirectory);
+    }
+
+    uint32_t FakeAdapterServerDriverHost::GetFrameTimings(vr::Compositor_FrameTiming* pTiming, uint32_t nFrames) {
+        return m_target->GetFrameTimings(pTiming, nFrames);
+    }
+
+    void FakeAdapterServerDriverHost::SetDisplayEyeToHead(uint32_t unWhichDevice,
+                                                          const vr::HmdMatrix34_t& eyeToHeadLeft,
+                                                          const vr::HmdMatrix34_t& eyeToHeadRight) {
+        m_target->SetDisplayEyeToHead(unWhichDevice, eyeToHeadLeft, eyeToHeadRight);
+    }
+
+    void FakeAdapterServerDriverHost::SetDisplayProjectionRaw(uint32_t unWhichDevice,
+                                                              const vr::HmdRect2_t& eyeLeft,
+                                                              const vr::HmdRect2_t& eyeRight) {
+        m_target->SetDisplayProjectionRaw(unWhichDevice, eyeLeft, eyeRight);
+    }
+
+    void FakeAdapterServerDriverHost::SetRecommendedRenderTargetSize(uint32_t unWhichDevice,
+                                                                     uint32_t nWidth,
+                                                                     uint32_t nHeight) {
+        m_target->SetRecommendedRenderTargetSize(unWhichDevice, nWidth, nHeight);
+    }
+
+    void FakeDriverLog::Log(const char* pchLogMessage) {
+        if (verbose) {
+            fprintf(stderr, "[driver] %s\n", pchLogMessage);
+        }
+    }
+
+    uint32_t FakeDriverManager::GetDriverCount() const {
+        return 1;
+    }
+
+    uint32_t FakeDriverManager::GetDriverName(vr::DriverId_t nDriver, char* pchValue, uint32_t unBufferSize) {
+        static const char name[] = "distortion_shim";
+        if (nDriver != 0) {
+            return 0;
+        }
+        if (pchValue && unBufferSize >= sizeof(name)) {
+            memcpy(pchValue, name, sizeof(name));
+        }
+        return sizeof(name);
+    }
+
+    vr::DriverHandle_t FakeDriverManager::GetDriverHandle(const char* pchDriverName) {
+        return strcmp(pchDriverName, "distortion_shim") ? 0 : 1;
+    }
+
+    bool FakeDriverManager::IsEnabled(vr::DriverId_t nDriver) const {
+        return nDriver == 0;
+    }
+
+    uint32_t FakeResources::LoadSharedResource(const char* pchResourceName, char* pchBuffer, uint32_t unBufferLen) {
+        return 0;
+    }
+
+    uint32_t FakeResources::GetResourceFullPath(const char* pchResourceName,
+                                                const char* pchResourceTypeDirectory,
+                                                char* pchPathBuffer,
+                                                uint32_t unBufferLen) {
+        if (pchPathBuffer && unBufferLen) {
+            pchPathBuffer[0] = 0;
+        }
+        return 0;
+    }
+
+    void* FakeRuntime::GetGenericInterface(const char* pchInterfaceVersion, vr::EVRInitError* peError) {
+        const std::string_view interfaceVersion(pchInterfaceVersion);
+        void* result = nullptr;
+        if (interfaceVersion == vr::IVRSettings_Version) {
+            result = (vr::IVRSettings*)&settings;
+        } else if (interfaceVersion == vr::IVRProperties_Version) {
+            result = (vr::IVRProperties*)&properties;
+        } else if (interfaceVersion == vr::IVRServerDriverHost_Version ||
+                   interfaceVersion == "IVRServerDriverHost_005") {
+            result = (vr::IVRServerDriverHost*)&serverDriverHost;
+        } else if (interfaceVersion == "IVRServerDriverHost_004") {
+            result = (vr::IVRServerDriverHost*)&adapterServerDriverHost;
+        } else if (interfaceVersion == vr::IVRDriverLog_Version) {
+            result = (vr::IVRDriverLog*)&driverLog;
+        } else if (interfaceVersion == vr::IVRDriverManager_Version) {
+            result = (vr::IVRDriverManager*)&driverManager;
+        } else if (interfaceVersion == vr::IVRResources_Version) {
+            result = (vr::IVRResources*)&resources;
+        }
+        if (peError) {
+            *peError = result ? vr::VRInitError_None : vr::VRInitError_Init_InterfaceNotFound;
+        }
+        return result;
+    }
+
+    vr::DriverHandle_t FakeRuntime::GetDriverHandle() {
+        return 1;
+    }
+
+} // namespace shim_host
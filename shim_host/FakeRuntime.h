@@ -0,0 +1,250 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace shim_host {
+
+    // In-process stand-in for the vrserver settings store. Values are kept per section/key, and numeric values are
+    // converted on read like vrserver does.
+    class FakeSettings : public vr::IVRSettings {
+      public:
+        // Load the sections from a .vrsettings file (eg: default.vrsettings). Existing keys are overwritten.
+        bool LoadFromFile(const std::string& path);
+
+        // Write all the sections to a .vrsettings file.
+        bool SaveToFile(const std::string& path) const;
+
+        const char* GetSettingsErrorNameFromEnum(vr::EVRSettingsError eError) override;
+        void SetBool(const char* pchSection,
+                     const char* pchSettingsKey,
+                     bool bValue,
+                     vr::EVRSettingsError* peError = nullptr) override;
+        void SetInt32(const char* pchSection,
+                      const char* pchSettingsKey,
+                      int32_t nValue,
+                      vr::EVRSettingsError* peError = nullptr) override;
+        void SetFloat(const char* pchSection,
+                      const char* pchSettingsKey,
+                      float flValue,
+                      vr::EVRSettingsError* peError = nullptr) override;
+        void SetString(const char* pchSection,
+                       const char* pchSettingsKey,
+                       const char* pchValue,
+                       vr::EVRSettingsError* peError = nullptr) override;
+        bool GetBool(const char* pchSection,
+                     const char* pchSettingsKey,
+                     vr::EVRSettingsError* peError = nullptr) override;
+        int32_t GetInt32(const char* pchSection,
+                         const char* pchSettingsKey,
+                         vr::EVRSettingsError* peError = nullptr) override;
+        float GetFloat(const char* pchSection,
+                       const char* pchSettingsKey,
+                       vr::EVRSettingsError* peError = nullptr) override;
+        void GetString(const char* pchSection,
+                       const char* pchSettingsKey,
+                       char* pchValue,
+                       uint32_t unValueLen,
+                       vr::EVRSettingsError* peError = nullptr) override;
+        void RemoveSection(const char* pchSection, vr::EVRSettingsError* peError = nullptr) override;
+        void RemoveKeyInSection(const char* pchSection,
+                                const char* pchSettingsKey,
+                                vr::EVRSettingsError* peError = nullptr) override;
+
+        struct Value {
+            enum class Type { Bool, Number, String } type = Type::Number;
+            bool boolean = false;
+            double number = 0.0;
+            std::string string;
+        };
+
+      private:
+        const Value* Find(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError) const;
+        void Store(const char* pchSection, const char* pchSettingsKey, Value value, vr::EVRSettingsError* peError);
+
+        mutable std::mutex m_mutex;
+        std::map<std::string, std::map<std::string, Value>> m_sections;
+    };
+
+    // In-process stand-in for the vrserver property store. Each tracked device index gets its own container.
+    class FakeProperties : public vr::IVRProperties {
+      public:
+        vr::ETrackedPropertyError ReadPropertyBatch(vr::PropertyContainerHandle_t ulContainerHandle,
+                                                    vr::PropertyRead_t* pBatch,
+                                                    uint32_t unBatchEntryCount) override;
+        vr::ETrackedPropertyError WritePropertyBatch(vr::PropertyContainerHandle_t ulContainerHandle,
+                                                     vr::PropertyWrite_t* pBatch,
+                                                     uint32_t unBatchEntryCount) override;
+        const char* GetPropErrorNameFromEnum(vr::ETrackedPropertyError error) override;
+        vr::PropertyContainerHandle_t TrackedDeviceToPropertyContainer(vr::TrackedDeviceIndex_t nDevice) override;
+
+      private:
+        struct Property {
+            vr::PropertyTypeTag_t tag = vr::k_unInvalidPropertyTag;
+            vr::ETrackedPropertyError error = vr::TrackedProp_Success;
+            std::vector<uint8_t> data;
+        };
+
+        std::mutex m_mutex;
+        std::map<vr::PropertyContainerHandle_t, std::map<vr::ETrackedDeviceProperty, Property>> m_containers;
+    };
+
+    // In-process stand-in for the vrserver driver host. Devices are activated as soon as they are added, and events
+    // must be queued explicitly with QueueEvent().
+    class FakeServerDriverHost : public vr::IVRServerDriverHost {
+      public:
+        bool TrackedDeviceAdded(const char* pchDeviceSerialNumber,
+                                vr::ETrackedDeviceClass eDeviceClass,
+                                vr::ITrackedDeviceServerDriver* pDriver) override;
+        void TrackedDevicePoseUpdated(uint32_t unWhichDevice,
+                                      const vr::DriverPose_t& newPose,
+                                      uint32_t unPoseStructSize) override;
+        void VsyncEvent(double vsyncTimeOffsetSeconds) override;
+        void VendorSpecificEvent(uint32_t unWhichDevice,
+                                 vr::EVREventType eventType,
+                                 const vr::VREvent_Data_t& eventData,
+                                 double eventTimeOffset) override;
+        bool IsExiting() override;
+        bool PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent) override;
+        void GetRawTrackedDevicePoses(float fPredictedSecondsFromNow,
+                                      vr::TrackedDevicePose_t* pTrackedDevicePoseArray,
+                                      uint32_t unTrackedDevicePoseArrayCount) override;
+        void RequestRestart(const char* pchLocalizedReason,
+                            const char* pchExecutableToStart,
+                            const char* pchArguments,
+                            const char* pchWorkingDirectory) override;
+        uint32_t GetFrameTimings(vr::Compositor_FrameTiming* pTiming, uint32_t nFrames) override;
+        void SetDisplayEyeToHead(uint32_t unWhichDevice,
+                                 const vr::HmdMatrix34_t& eyeToHeadLeft,
+                                 const vr::HmdMatrix34_t& eyeToHeadRight) override;
+        void SetDisplayProjectionRaw(uint32_t unWhichDevice,
+                                     const vr::HmdRect2_t& eyeLeft,
+                                     const vr::HmdRect2_t& eyeRight) override;
+        void SetRecommendedRenderTargetSize(uint32_t unWhichDevice, uint32_t nWidth, uint32_t nHeight) override;
+
+        void QueueEvent(vr::EVREventType eventType, vr::TrackedDeviceIndex_t deviceIndex = 0);
+
+        struct Device {
+            std::string serialNumber;
+            vr::ETrackedDeviceClass deviceClass;
+            vr::ITrackedDeviceServerDriver* driver;
+        };
+
+        // The devices as seen by vrserver, ie: after any shimming. The index in the vector is the device index.
+        std::vector<Device> GetDevices() const;
+
+        // Invoked (on the calling thread) for every vendor event, eg: VREvent_LensDistortionChanged.
+        std::function<void(uint32_t deviceIndex, vr::EVREventType eventType)> onVendorEvent;
+
+        std::atomic<uint32_t> lensDistortionChangedCount{0};
+
+      private:
+        mutable std::mutex m_mutex;
+        std::vector<Device> m_devices;
+        std::deque<vr::VREvent_t> m_events;
+    };
+
+    // Stand-in for an older flavor of the driver host that vrserver implements as an adapter over the current one: it
+    // has its own vtable, and forwards every call to the current flavor through its vtable.
+    class FakeAdapterServerDriverHost : public vr::IVRServerDriverHost {
+      public:
+        explicit FakeAdapterServerDriverHost(vr::IVRServerDriverHost* target) : m_target(target) {
+        }
+
+        bool TrackedDeviceAdded(const char* pchDeviceSerialNumber,
+                                vr::ETrackedDeviceClass eDeviceClass,
+                                vr::ITrackedDeviceServerDriver* pDriver) override;
+        void TrackedDevicePoseUpdated(uint32_t unWhichDevice,
+                                      const vr::DriverPose_t& newPose,
+                                      uint32_t unPoseStructSize) override;
+        void VsyncEvent(double vsyncTimeOffsetSeconds) override;
+        void VendorSpecificEvent(uint32_t unWhichDevice,
+                                 vr::EVREventType eventType,
+                                 const vr::VREvent_Data_t& eventData,
+                                 double eventTimeOffset) override;
+        bool IsExiting() override;
+        bool PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent) override;
+        void GetRawTrackedDevicePoses(float fPredictedSecondsFromNow,
+                                      vr::TrackedDevicePose_t* pTrackedDevicePoseArray,
+                                      uint32_t unTrackedDevicePoseArrayCount) override;
+        void RequestRestart(const char* pchLocalizedReason,
+                            const char* pchExecutableToStart,
+                            const char* pchArguments,
+                            const char* pchWorkingDirectory) override;
+        uint32_t GetFrameTimings(vr::Compositor_FrameTiming* pTiming, uint32_t nFrames) override;
+        void SetDisplayEyeToHead(uint32_t unWhichDevice,
+                                 const vr::HmdMatrix34_t& eyeToHeadLeft,
+                                 const vr::HmdMatrix34_t& eyeToHeadRight) override;
+        void SetDisplayProjectionRaw(uint32_t unWhichDevice,
+                                     const vr::HmdRect2_t& eyeLeft,
+                                     const vr::HmdRect2_t& eyeRight) override;
+        void SetRecommendedRenderTargetSize(uint32_t unWhichDevice, uint32_t nWidth, uint32_t nHeight) override;
+
+      private:
+        vr::IVRServerDriverHost* const m_target;
+    };
+
+    class FakeDriverLog : public vr::IVRDriverLog {
+      public:
+        void Log(const char* pchLogMessage) override;
+
+        bool verbose = false;
+    };
+
+    // Only reports ourselves, which is enough for the driver context initialization.
+    class FakeDriverManager : public vr::IVRDriverManager {
+      public:
+        uint32_t GetDriverCount() const override;
+        uint32_t GetDriverName(vr::DriverId_t nDriver, char* pchValue, uint32_t unBufferSize) override;
+        vr::DriverHandle_t GetDriverHandle(const char* pchDriverName) override;
+        bool IsEnabled(vr::DriverId_t nDriver) const override;
+    };
+
+    // Resources are never loaded by the shim, but the driver context initialization requires the interface.
+    class FakeResources : public vr::IVRResources {
+      public:
+        uint32_t LoadSharedResource(const char* pchResourceName, char* pchBuffer, uint32_t unBufferLen) override;
+        uint32_t GetResourceFullPath(const char* pchResourceName,
+                                     const char* pchResourceTypeDirectory,
+                                     char* pchPathBuffer,
+                                     uint32_t unBufferLen) override;
+    };
+
+    // The driver context handed to the driver's Init(). It owns all the fake interfaces.
+    class FakeRuntime : public vr::IVRDriverContext {
+      public:
+        void* GetGenericInterface(const char* pchInterfaceVersion, vr::EVRInitError* peError = nullptr) override;
+        vr::DriverHandle_t GetDriverHandle() override;
+
+        FakeSettings settings;
+        FakeProperties properties;
+        FakeServerDriverHost serverDriverHost;
+
+        // The older flavors: IVRServerDriverHost_005 shares the implementation (and the vtable) of the current flavor,
+        // IVRServerDriverHost_004 is an adapter over it.
+        FakeAdapterServerDriverHost adapterServerDriverHost{&serverDriverHost};
+        FakeDriverLog driverLog;
+        FakeDriverManager driverManager;
+        FakeResources resources;
+    };
+
+} // namespace shim_host
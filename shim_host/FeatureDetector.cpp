@@ -0,0 +1,503 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "FeatureDetector.h"
+#include "Parallel.h"
+
+namespace {
+    using namespace shim_host;
+
+    Plane MakePlane(uint32_t width, uint32_t height) {
+        Plane plane;
+        plane.width = width;
+        plane.height = height;
+        plane.values.resize((size_t)width * height);
+        return plane;
+    }
+
+    // Mean over a (2 radius + 1)^2 window, shrunk at the borders. Running sums along the rows, then down the columns.
+    Plane BoxMean(const Plane& plane, int radius, uint32_t threadCount) {
+        Plane horizontal = MakePlane(plane.width, plane.height);
+        ParallelFor(threadCount, plane.height, [&](size_t begin, size_t end) {
+            std::vector<double> prefix(plane.width + 1);
+            for (size_t y = begin; y < end; y++) {
+                const float* source = plane.Row((uint32_t)y);
+                for (uint32_t x = 0; x < plane.width; x++) {
+                    prefix[x + 1] = prefix[x] + source[x];
+                }
+                float* destination = horizontal.Row((uint32_t)y);
+                for (int x = 0; x < (int)plane.width; x++) {
+                    const int first = std::max(0, x - radius);
+                    const int last = std::min((int)plane.width - 1, x + radius);
+                    destination[x] = (float)((prefix[last + 1] - prefix[first]) / (last - first + 1));
+                }
+            }
+        });
+
+        Plane mean = MakePlane(plane.width, plane.height);
+        ParallelFor(threadCount, plane.height, [&](size_t begin, size_t end) {
+            std::vector<double> sum(plane.width, 0.0);
+            int first = std::max(0, (int)begin - radius);
+            int last = std::min((int)plane.height - 1, (int)begin + radius);
+            for (int y = first; y <= last; y++) {
+                const float* row = horizontal.Row(y);
+                for (uint32_t x = 0; x < plane.width; x++) {
+                    sum[x] += row[x];
+                }
+            }
+            for (int y = (int)begin; y < (int)end; y++) {
+                // Slide the window to [y - radius, y + radius].
+                while (last < std::min((int)plane.height - 1, y + radius)) {
+                    const float* row = horizontal.Row(++last);
+                    for (uint32_t x = 0; x < plane.width; x++) {
+                        sum[x] += row[x];
+                    }
+                }
+                while (first < y - radius) {
+                    const float* row = horizontal.Row(first++);
+                    for (uint32_t x = 0; x < plane.width; x++) {
+                        sum[x] -= row[x];
+                    }
+                }
+                const double scale = 1.0 / (last - first + 1);
+                float* destination = mean.Row(y);
+                for (uint32_t x = 0; x < plane.width; x++) {
+                    destination[x] = (float)(sum[x] * scale);
+                }
+            }
+        });
+        return mean;
+    }
+
+    Plane GaussianBlur(const Plane& plane, double sigma, uint32_t threadCount) {
+        const int radius = std::max(1, (int)std::ceil(3 * sigma));
+        std::vector<float> kernel(2 * radius + 1);
+        float total = 0;
+        for (int i = -radius; i <= radius; i++) {
+            kernel[i + radius] = (float)std::exp(-i * i / (2 * sigma * sigma));
+            total += kernel[i + radius];
+        }
+        for (float& weight : kernel) {
+            weight /= total;
+        }
+
+        Plane horizontal = MakePlane(plane.width, plane.height);
+        ParallelFor(threadCount, plane.height, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++) {
+                const float* source = plane.Row((uint32_t)y);
+                float* destination = horizontal.Row((uint32_t)y);
+                const auto Clamped = [&](int x) {
+                    float value = 0;
+                    for (int i = -radius; i <= radius; i++) {
+                        value += kernel[i + radius] * source[std::min(std::max(x + i, 0), (int)plane.width - 1)];
+                    }
+                    destination[x] = value;
+                };
+
+                // Only the borders need clamping.
+                const int interiorEnd = std::max(radius, (int)plane.width - radius);
+                for (int x = 0; x < std::min(radius, (int)plane.width); x++) {
+                    Clamped(x);
+                }
+                std::fill(destination + radius, destination + interiorEnd, 0.f);
+                for (int i = -radius; i <= radius; i++) {
+                    const float weight = kernel[i + radius];
+                    const float* shifted = source + i;
+                    for (int x = radius; x < interiorEnd; x++) {
+                        destination[x] += weight * shifted[x];
+                    }
+                }
+                for (int x = interiorEnd; x < (int)plane.width; x++) {
+                    Clamped(x);
+                }
+            }
+        });
+
+        // Whole rows at a time, so that the inner loop is a straight multiply-add over contiguous floats.
+        Plane blurred = MakePlane(plane.width, plane.height);
+        ParallelFor(threadCount, plane.height, [&](size_t begin, size_t end) {
+            for (int y = (int)begin; y < (int)end; y++) {
+                float* destination = blurred.Row(y);
+                std::fill(destination, destination + plane.width, 0.f);
+                for (int i = -radius; i <= radius; i++) {
+                    const float* source = horizontal.Row(std::min(std::max(y + i, 0), (int)plane.height - 1));
+                    const float weight = kernel[i + radius];
+                    for (uint32_t x = 0; x < plane.width; x++) {
+                        destination[x] += weight * source[x];
+                    }
+                }
+            }
+        });
+        return blurred;
+    }
+
+    // Central differences, zero on the borders.
+    void Gradients(const Plane& plane, Plane& gradientX, Plane& gradientY, uint32_t threadCount) {
+        gradientX = MakePlane(plane.width, plane.height);
+        gradientY = MakePlane(plane.width, plane.height);
+        ParallelFor(threadCount, plane.height, [&](size_t begin, size_t end) {
+            for (uint32_t y = (uint32_t)std::max<size_t>(begin, 1); y < std::min<size_t>(end, plane.height - 1); y++) {
+                const float* above = plane.Row(y - 1);
+                const float* row = plane.Row(y);
+                const float* below = plane.Row(y + 1);
+                float* gx = gradientX.Row(y);
+                float* gy = gradientY.Row(y);
+                for (uint32_t x = 1; x + 1 < plane.width; x++) {
+                    gx[x] = 0.5f * (row[x + 1] - row[x - 1]);
+                    gy[x] = 0.5f * (below[x] - above[x]);
+                }
+            }
+        });
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    std::vector<Feature> DetectDots(const Plane& plane, const DetectorOptions& options) {
+        const Plane mean = BoxMean(plane, options.window, options.threadCount);
+
+        std::vector<uint8_t> mask(plane.values.size());
+        ParallelFor(options.threadCount, plane.values.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                mask[i] = plane.values[i] > mean.values[i] + options.contrast;
+            }
+        });
+
+        // Flood fill each dot, clearing the mask as we go.
+        std::vector<Feature> features;
+        std::vector<uint32_t> stack;
+        const size_t maxArea = (size_t)options.window * options.window;
+        for (uint32_t start = 0; start < (uint32_t)mask.size(); start++) {
+            if (!mask[start]) {
+                continue;
+            }
+            double sumWeights = 0, sumX = 0, sumY = 0;
+            size_t area = 0;
+            bool touchesBorder = false;
+            mask[start] = 0;
+            stack.push_back(start);
+            while (!stack.empty()) {
+                const uint32_t index = stack.back();
+                stack.pop_back();
+                const uint32_t x = index % plane.width;
+                const uint32_t y = index / plane.width;
+                const double weight = plane.values[index] - mean.values[index];
+                sumWeights += weight;
+                sumX += weight * (x + 0.5);
+                sumY += weight * (y + 0.5);
+                area++;
+                touchesBorder = touchesBorder || x == 0 || y == 0 || x + 1 == plane.width || y + 1 == plane.height;
+
+                const auto Visit = [&](uint32_t neighbor) {
+                    if (mask[neighbor]) {
+                        mask[neighbor] = 0;
+                        stack.push_back(neighbor);
+                    }
+                };
+                if (x > 0) {
+                    Visit(index - 1);
+                }
+                if (x + 1 < plane.width) {
+                    Visit(index + 1);
+                }
+                if (y > 0) {
+                    Visit(index - plane.width);
+                }
+                if (y + 1 < plane.height) {
+                    Visit(index + plane.width);
+                }
+            }
+
+            if (area >= options.minArea && area <= maxArea && !touchesBorder && sumWeights > 0) {
+                features.push_back({sumX / sumWeights, sumY / sumWeights});
+            }
+        }
+        return features;
+    }
+
+    std::vector<Feature> DetectCheckerboardCorners(const Plane& plane, const DetectorOptions& options) {
+        Plane gradientX, gradientY;
+        Gradients(GaussianBlur(plane, options.sigma, options.threadCount), gradientX, gradientY, options.threadCount);
+
+        // Saddle response: minus the determinant of the Hessian, positive at a corner between 4 squares.
+        Plane response = MakePlane(plane.width, plane.height);
+        std::vector<float> maxResponses(std::max(1u, options.threadCount), 0.f);
+        std::atomic<uint32_t> nextSlot{0};
+        ParallelFor(options.threadCount, plane.height, [&](size_t begin, size_t end) {
+            float maxResponse = 0;
+            for (uint32_t y = (uint32_t)std::max<size_t>(begin, 2); y < std::min<size_t>(end, plane.height - 2); y++) {
+                const float* gxAbove = gradientX.Row(y - 1);
+                const float* gxBelow = gradientX.Row(y + 1);
+                const float* gx = gradientX.Row(y);
+                const float* gyAbove = gradientY.Row(y - 1);
+                const float* gyBelow = gradientY.Row(y + 1);
+                float* destination = response.Row(y);
+                for (uint32_t x = 2; x + 2 < plane.width; x++) {
+                    const float ixx = 0.5f * (gx[x + 1] - gx[x - 1]);
+                    const float iyy = 0.5f * (gyBelow[x] - gyAbove[x]);
+                    const float ixy = 0.5f * (gxBelow[x] - gxAbove[x]);
+                    destination[x] = ixy * ixy - ixx * iyy;
+                    maxResponse = std::max(maxResponse, destination[x]);
+                }
+            }
+            maxResponses[nextSlot++] = maxResponse;
+        });
+        const float threshold =
+            options.responseThreshold * *std::max_element(maxResponses.cbegin(), maxResponses.cend());
+
+        // Non-maximum suppression. Ties go to the first pixel in scan order.
+        const int suppression = options.suppressionRadius;
+        std::mutex candidatesMutex;
+        std::vector<Feature> candidates;
+        ParallelFor(options.threadCount, plane.height, [&](size_t begin, size_t end) {
+            std::vector<Feature> local;
+            for (int y = (int)begin; y < (int)end; y++) {
+                const float* row = response.Row(y);
+                for (int x = 0; x < (int)plane.width; x++) {
+                    const float value = row[x];
+                    if (!(value > threshold) || value <= 0) {
+                        continue;
+                    }
+                    bool isMaximum = true;
+                    for (int v = std::max(0, y - suppression);
+                         isMaximum && v <= std::min((int)plane.height - 1, y + suppression);
+                         v++) {
+                        const float* other = response.Row(v);
+                        for (int u = std::max(0, x - suppression); u <= std::min((int)plane.width - 1, x + suppression);
+                             u++) {
+                            const bool before = v < y || (v == y && u < x);
+                            if (before ? other[u] >= value : other[u] > value) {
+                                isMaximum = false;
+                                break;
+                            }
+                        }
+                    }
+                    if (isMaximum) {
+                        local.push_back({(double)x, (double)y});
+                    }
+                }
+            }
+            std::unique_lock lock(candidatesMutex);
+            candidates.insert(candidates.end(), local.cbegin(), local.cend());
+        });
+
+        // Sub-pixel refinement: at the corner c, each gradient g(q) in the window is orthogonal to q - c, so c
+        // solves sum(w g g^T) c = sum(w g g^T q).
+        const int radius = options.refinementRadius;
+        const double sigma2 = 2.0 * (radius / 2.0) * (radius / 2.0);
+        std::vector<uint8_t> valid(candidates.size(), 0);
+        ParallelFor(options.threadCount, candidates.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                Feature corner = candidates[i];
+                bool converged = false;
+                for (int iteration = 0; iteration < 20 && !converged; iteration++) {
+                    const int centerX = (int)std::lround(corner.x);
+                    const int centerY = (int)std::lround(corner.y);
+                    if (centerX - radius < 1 || centerY - radius < 1 || centerX + radius + 1 >= (int)plane.width ||
+                        centerY + radius + 1 >= (int)plane.height) {
+                        break;
+                    }
+                    double a = 0, b = 0, c = 0, bx = 0, by = 0;
+                    for (int y = centerY - radius; y <= centerY + radius; y++) {
+                        for (int x = centerX - radius; x <= centerX + radius; x++) {
+                            const double gx = gradientX.Row(y)[x];
+                            const double gy = gradientY.Row(y)[x];
+                            const double distance2 = (x - corner.x) * (x - corner.x) + (y - corner.y) * (y - corner.y);
+                            const double weight = std::exp(-distance2 / sigma2);
+                            a += weight * gx * gx;
+                            b += weight * gx * gy;
+                            c += weight * gy * gy;
+                            bx += weight * (gx * gx * x + gx * gy * y);
+                            by += weight * (gx * gy * x + gy * gy * y);
+                        }
+                    }
+                    const double determinant = a * c - b * b;
+                    if (!(determinant > 1e-12 * (a + c) * (a + c))) {
+                        break;
+                    }
+                    const Feature refined{(c * bx - b * by) / determinant, (a * by - b * bx) / determinant};
+                    if (std::abs(refined.x - candidates[i].x) > radius ||
+                        std::abs(refined.y - candidates[i].y) > radius) {
+                        break;
+                    }
+                    converged = std::abs(refined.x - corner.x) < 1e-3 && std::abs(refined.y - corner.y) < 1e-3;
+                    corner = refined;
+                    valid[i] = 1;
+                }
+                candidates[i] = {corner.x + 0.5, corner.y + 0.5};
+            }
+        });
+
+        // Candidates that converged to the same corner.
+        std::vector<Feature> features;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (valid[i]) {
+                features.push_back(candidates[i]);
+            }
+        }
+        std::sort(features.begin(), features.end(), [](const Feature& a, const Feature& b) { return a.y < b.y; });
+        std::vector<Feature> unique;
+        for (const Feature& feature : features) {
+            bool duplicate = false;
+            for (auto it = unique.rbegin(); it != unique.rend() && feature.y - it->y < 1.0; ++it) {
+                if (std::abs(feature.x - it->x) < 1.0) {
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (!duplicate) {
+                unique.push_back(feature);
+            }
+        }
+        return unique;
+    }
+
+    std::vector<GridFeature> AssignGrid(const std::vector<Feature>& features, double anchorX, double anchorY) {
+        std::vector<GridFeature> grid;
+        if (features.empty()) {
+            return grid;
+        }
+
+        // Bucket the features for the neighbor queries, with roughly one feature per cell.
+        double minX = features[0].x, maxX = minX, minY = features[0].y, maxY = minY;
+        for (const Feature& feature : features) {
+            minX = std::min(minX, feature.x);
+            maxX = std::max(maxX, feature.x);
+            minY = std::min(minY, feature.y);
+            maxY = std::max(maxY, feature.y);
+        }
+        const double cellSize = std::max(1.0, std::sqrt((maxX - minX + 1) * (maxY - minY + 1) / features.size()));
+        const int columns = (int)((maxX - minX) / cellSize) + 1;
+        const int rows = (int)((maxY - minY) / cellSize) + 1;
+        std::vector<std::vector<uint32_t>> cells((size_t)columns * rows);
+        const auto CellOf = [&](double x, double y, int& column, int& row) {
+            column = (int)std::floor((x - minX) / cellSize);
+            row = (int)std::floor((y - minY) / cellSize);
+        };
+        for (uint32_t i = 0; i < features.size(); i++) {
+            int column, row;
+            CellOf(features[i].x, features[i].y, column, row);
+            cells[(size_t)row * columns + column].push_back(i);
+        }
+        const auto FindNearest = [&](double x, double y, double maxDistance) -> int {
+            int column, row;
+            CellOf(x, y, column, row);
+            const int reach = (int)std::ceil(maxDistance / cellSize);
+            int nearest = -1;
+            double nearestDistance2 = maxDistance * maxDistance;
+            for (int v = std::max(0, row - reach); v <= std::min(rows - 1, row + reach); v++) {
+                for (int u = std::max(0, column - reach); u <= std::min(columns - 1, column + reach); u++) {
+                    for (const uint32_t i : cells[(size_t)v * columns + u]) {
+                        const double distance2 = (features[i].x - x) * (features[i].x - x) +
+                                                 (features[i].y - y) * (features[i].y - y);
+                        if (distance2 < nearestDistance2) {
+                            nearest = (int)i;
+                            nearestDistance2 = distance2;
+                        }
+                    }
+                }
+            }
+            return nearest;
+        };
+
+        uint32_t anchor = 0;
+        for (uint32_t i = 1; i < features.size(); i++) {
+            const auto Distance2 = [&](uint32_t j) {
+                return (features[j].x - anchorX) * (features[j].x - anchorX) +
+                       (features[j].y - anchorY) * (features[j].y - anchorY);
+            };
+            if (Distance2(i) < Distance2(anchor)) {
+                anchor = i;
+            }
+        }
+
+        // The initial lattice vectors: the closest neighbors of the anchor along each axis.
+        struct Vector {
+            double x, y;
+        };
+        Vector axes[2] = {{0, 0}, {0, 0}};
+        for (int axis = 0; axis < 2; axis++) {
+            double best = std::numeric_limits<double>::infinity();
+            for (int v = 0; v < rows; v++) {
+                for (int u = 0; u < columns; u++) {
+                    for (const uint32_t i : cells[(size_t)v * columns + u]) {
+                        const double dx = features[i].x - features[anchor].x;
+                        const double dy = features[i].y - features[anchor].y;
+                        const double along = axis == 0 ? dx : dy;
+                        const double across = axis == 0 ? dy : dx;
+                        const double distance2 = dx * dx + dy * dy;
+                        if (i != anchor && along > 0 && std::abs(across) < along && distance2 < best &&
+                            distance2 < 16 * cellSize * cellSize) {
+                            best = distance2;
+                            axes[axis] = {dx, dy};
+                        }
+                    }
+                }
+            }
+        }
+        grid.push_back({features[anchor], 0, 0});
+        if ((axes[0].x == 0 && axes[0].y == 0) || (axes[1].x == 0 && axes[1].y == 0)) {
+            return grid;
+        }
+
+        // Breadth-first walk, carrying the local lattice vectors along since the distortion changes the spacing.
+        struct Step {
+            uint32_t index;
+            int column, row;
+            Vector axes[2];
+        };
+        std::vector<uint8_t> assigned(features.size(), 0);
+        std::set<std::pair<int, int>> taken = {{0, 0}};
+        std::deque<Step> queue;
+        assigned[anchor] = 1;
+        queue.push_back({anchor, 0, 0, {axes[0], axes[1]}});
+        while (!queue.empty()) {
+            const Step step = queue.front();
+            queue.pop_front();
+            const Feature& from = features[step.index];
+            for (int axis = 0; axis < 2; axis++) {
+                for (const int sign : {1, -1}) {
+                    const Vector& offset = step.axes[axis];
+                    const double length = std::sqrt(offset.x * offset.x + offset.y * offset.y);
+                    const int found = FindNearest(from.x + sign * offset.x, from.y + sign * offset.y, 0.4 * length);
+                    const int column = step.column + (axis == 0 ? sign : 0);
+                    const int row = step.row + (axis == 1 ? sign : 0);
+                    if (found < 0 || assigned[found] || taken.count({column, row})) {
+                        continue;
+                    }
+                    assigned[found] = 1;
+                    taken.insert({column, row});
+                    grid.push_back({features[found], column, row});
+
+                    Step next{(uint32_t)found, column, row, {step.axes[0], step.axes[1]}};
+                    next.axes[axis] = {sign * (features[found].x - from.x), sign * (features[found].y - from.y)};
+                    queue.push_back(next);
+                }
+            }
+        }
+        return grid;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Image.h"
+
+namespace shim_host {
+
+    // Position of a feature in a capture, in pixels.
+    struct Feature {
+        double x;
+        double y;
+    };
+
+    struct DetectorOptions {
+        uint32_t threadCount = 1;
+
+        // Dots: radius of the window for the local mean, in capture pixels, and contrast above that mean.
+        int window = 24;
+        float contrast = 0.1f;
+        size_t minArea = 6;
+
+        // Checkerboard: smoothing, radius of the non-maximum suppression and of the sub-pixel refinement, and
+        // saddle response threshold relative to the strongest corner.
+        double sigma = 1.5;
+        int suppressionRadius = 6;
+        int refinementRadius = 5;
+        float responseThreshold = 0.05f;
+    };
+
+    // Centroids of bright dots, weighted by their intensity above the local mean.
+    std::vector<Feature> DetectDots(const Plane& plane, const DetectorOptions& options);
+
+    // Inner corners of a checkerboard: maxima of the saddle response of the Hessian, refined to sub-pixel by
+    // requiring the gradients around the corner to be orthogonal to their offset from it.
+    std::vector<Feature> DetectCheckerboardCorners(const Plane& plane, const DetectorOptions& options);
+
+    struct GridFeature {
+        Feature feature;
+        int column;
+        int row;
+    };
+
+    // Number the features along the rows and columns of the pattern, starting from the feature closest to the anchor
+    // as (0, 0), and walking to the neighbors from the local spacing of the (distorted) grid.
+    std::vector<GridFeature> AssignGrid(const std::vector<Feature>& features, double anchorX, double anchorY);
+
+} // namespace shim_host
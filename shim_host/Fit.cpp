@@ -0,0 +1,239 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Calibration.h"
+#include "Commands.h"
+#include "FakeRuntime.h"
+#include "ReferenceDistortion.h"
+#include "ShimHost.h"
+
+#include <random>
+
+namespace shim_host {
+
+    int RunSynthesize(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host synthesize <output> [--variant <name>] [--points <n>] [--noise <px>] "
+                    "[--outliers <fraction>] [--seed <n>]\n");
+            return 1;
+        }
+
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+
+        const DisplayGeometry geometry = DisplayGeometry::FromDisplay(&host.Vendor());
+        const LensProfile baseProfile = LensProfile::FromSettings(&host.Runtime().settings);
+        const std::string variant = args.Get("variant", "settings");
+        const std::optional<LensProfile> profile =
+            LensProfile::FindVariant(baseProfile, geometry.eyeWidth[vr::Eye_Left], variant);
+        if (!profile) {
+            fprintf(stderr, "Unknown variant: %s\n", variant.c_str());
+            return 1;
+        }
+        const ReferenceDistortion reference(*profile, geometry);
+
+        const uint32_t pointCount = (uint32_t)std::max<int64_t>(1, args.GetInt("points", 10000));
+        const double noise = args.GetDouble("noise", 0.0);
+        const double outliers = args.GetDouble("outliers", 0.0);
+        std::mt19937 generator((uint32_t)args.GetInt("seed", 1));
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::normal_distribution<double> gaussian(0.0, std::max(noise, 1e-30));
+
+        CorrespondenceSet set;
+        set.eyeWidth = geometry.eyeWidth[vr::Eye_Left];
+        set.eyeHeight = geometry.eyeHeight[vr::Eye_Left];
+        for (int eye = 0; eye < 2; eye++) {
+            const ReferenceDistortion::Eye& e = reference.GetEye((vr::EVREye)eye);
+            for (int channel = 0; channel < 3; channel++) {
+                for (uint32_t i = 0; i < pointCount; i++) {
+                    const double x = uniform(generator) * geometry.eyeWidth[eye];
+                    const double y = uniform(generator) * geometry.eyeHeight[eye];
+
+                    // Through the lens, then back to tangent space.
+                    double distortedX, distortedY;
+                    reference.Distort((vr::EVREye)eye, channel, x, y, distortedX, distortedY);
+                    double tangentY = (distortedY - e.principalPointY) / e.focalLengthY;
+                    double tangentX = (distortedX - e.principalPointX - e.skewFactor * tangentY) / e.focalLengthX;
+
+                    // A misdetected feature: any direction within the field of view.
+                    if (uniform(generator) < outliers) {
+                        tangentX = -e.left + uniform(generator) * (e.left + e.right);
+                        tangentY = -e.top + uniform(generator) * (e.top + e.bottom);
+                    }
+
+                    Correspondence point;
+                    point.eye = (uint8_t)eye;
+                    point.channel = (uint8_t)channel;
+                    point.x = (float)(x + (noise > 0 ? gaussian(generator) : 0.0));
+                    point.y = (float)(y + (noise > 0 ? gaussian(generator) : 0.0));
+                    point.tangentX = (float)tangentX;
+                    point.tangentY = (float)tangentY;
+                    set.points.push_back(point);
+                }
+            }
+        }
+
+        if (!SaveCorrespondences(args.Positional()[0], set)) {
+            fprintf(stderr, "Failed to write %s\n", args.Positional()[0].c_str());
+            return 1;
+        }
+        printf("Wrote %zu correspondences for profile %s (noise %.3f px, %.1f%% outliers) to %s\n",
+               set.points.size(),
+               variant.c_str(),
+               noise,
+               outliers * 100,
+               args.Positional()[0].c_str());
+        return 0;
+    }
+
+    int RunFit(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host fit <correspondences> [--output <vrsettings>] [--threads <n>] "
+                    "[--iterations <n>] [--robust] [--threshold <px>] [--confidence <p>] [--hypotheses <n>]\n");
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        CorrespondenceSet set;
+        if (!LoadCorrespondences(args.Positional()[0], set)) {
+            fprintf(stderr, "Failed to read %s\n", args.Positional()[0].c_str());
+            return 1;
+        }
+        const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%s: %zu correspondences, %ux%u per eye (loaded in %.3f s)\n",
+               args.Positional()[0].c_str(),
+               set.points.size(),
+               set.eyeWidth,
+               set.eyeHeight,
+               loadSeconds);
+
+        FitOptions options;
+        options.threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+        options.maxIterations = (uint32_t)std::max<int64_t>(1, args.GetInt("iterations", 100));
+
+        const bool robust = args.Has("robust");
+        RobustOptions robustOptions;
+        robustOptions.threshold = args.GetDouble("threshold", robustOptions.threshold);
+        robustOptions.confidence = args.GetDouble("confidence", robustOptions.confidence);
+        robustOptions.maxHypotheses =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("hypotheses", robustOptions.maxHypotheses));
+        robustOptions.threadCount = options.threadCount;
+        robustOptions.seed = (uint32_t)args.GetInt("seed", robustOptions.seed);
+
+        LensProfile profile;
+        bool converged = true;
+        for (int eye = 0; eye < 2; eye++) {
+            std::vector<Correspondence> points;
+            std::copy_if(set.points.cbegin(), set.points.cend(), std::back_inserter(points), [&](const auto& point) {
+                return point.eye == eye;
+            });
+            if (points.empty()) {
+                printf("%s eye: no correspondences, keeping the default model\n", EyeNames[eye]);
+                continue;
+            }
+
+            const auto fitStart = std::chrono::steady_clock::now();
+            EyeModel model;
+            FitReport report;
+            if (robust) {
+                std::vector<bool> inliers;
+                RobustReport robustReport;
+                report = FitEyeModelRobust(
+                    points, model, set.eyeWidth, set.eyeHeight, options, robustOptions, inliers, robustReport);
+                for (int channel = 0; channel < 3; channel++) {
+                    printf("%s eye, %s: %zu/%zu coarse inliers after %u hypotheses\n",
+                           EyeNames[eye],
+                           ChannelNames[channel],
+                           robustReport.inlierCount[channel],
+                           robustReport.pointCount[channel],
+                           robustReport.hypotheses[channel]);
+                }
+                printf("%s eye: %zu/%zu inliers after refinement\n",
+                       EyeNames[eye],
+                       (size_t)std::count(inliers.cbegin(), inliers.cend(), true),
+                       points.size());
+            } else {
+                model = EstimateAffine(points, set.eyeWidth, set.eyeHeight);
+                report = FitEyeModel(points, model, set.eyeWidth, options);
+            }
+            const double fitSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - fitStart).count();
+            converged = converged && report.converged;
+
+            printf("%s eye: %zu points, %u iterations%s, %.3f s, RMS %.4f px -> %.4f px\n",
+                   EyeNames[eye],
+                   report.pointCount,
+                   report.iterations,
+                   report.converged ? "" : " (not converged)",
+                   fitSeconds,
+                   report.initialRms,
+                   std::sqrt((report.rms[0] * report.rms[0] + report.rms[1] * report.rms[1] +
+                              report.rms[2] * report.rms[2]) /
+                             3));
+            model.ToProfile(profile, eye, set.eyeWidth, set.eyeHeight);
+
+            const LensProfile::Eye& e = profile.eyes[eye];
+            printf("  focal length %.6f %.6f, principal point %.6f %.6f, skew %.6f\n",
+                   e.focalLengthX,
+                   e.focalLengthY,
+                   e.principalPointX,
+                   e.principalPointY,
+                   e.skewFactor);
+            for (int channel = 0; channel < 3; channel++) {
+                const LensProfile::Channel& c = e.channels[channel];
+                printf("  %-6s cod %.6f %.6f, k %.6g %.6g %.6g, RMS %.4f px, max %.4f px\n",
+                       ChannelNames[channel],
+                       c.codX,
+                       c.codY,
+                       c.k1,
+                       c.k2,
+                       c.k3,
+                       report.rms[channel],
+                       report.maxError[channel]);
+            }
+        }
+
+        const std::string output = args.Get("output");
+        if (!output.empty()) {
+            FakeSettings settings;
+            profile.ToSettings(&settings);
+            if (!settings.SaveToFile(output)) {
+                fprintf(stderr, "Failed to write %s\n", output.c_str());
+                return 1;
+            }
+            printf("Wrote the lens profile to %s\n", output.c_str());
+        }
+
+        printf("%s in %.3f s\n",
+               converged ? "Converged" : "Not converged",
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        return converged ? 0 : 1;
+    }
+
+} // namespace shim_host
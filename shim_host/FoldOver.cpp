@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+#include "LensAnalysis.h"
+#include "LensProfile.h"
+#include "ReferenceDistortion.h"
+#include "ShimHost.h"
+
+namespace shim_host {
+
+    int RunFoldOver(const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+
+        const DisplayGeometry geometry = DisplayGeometry::FromDisplay(&host.Vendor());
+        const LensProfile baseProfile = LensProfile::FromSettings(&host.Runtime().settings);
+        std::vector<std::pair<std::string, LensProfile>> profiles;
+        if (args.Has("settings-only")) {
+            profiles.emplace_back("settings", baseProfile);
+        } else {
+            profiles = LensProfile::Variants(baseProfile, geometry.eyeWidth[vr::Eye_Left]);
+        }
+
+        // Like the shim, the normalized settings are scaled by the dimensions of the left eye for both eyes.
+        const double width = geometry.eyeWidth[vr::Eye_Left];
+        const double height = geometry.eyeHeight[vr::Eye_Left];
+
+        bool foldsInside = false;
+        printf("%-24s %-6s %-6s %14s %14s %14s %12s %12s\n",
+               "profile",
+               "eye",
+               "color",
+               "k1",
+               "k2",
+               "k3",
+               "valid_px",
+               "viewport_px");
+        for (const auto& profile : profiles) {
+            for (int eye = 0; eye < 2; eye++) {
+                for (int channel = 0; channel < 3; channel++) {
+                    const LensProfile::Channel& c = profile.second.eyes[eye].channels[channel];
+                    const double radius = driver_shim::FindFoldOverRadius(c.k1, c.k2, c.k3);
+                    const double viewportRadius = driver_shim::GetViewportMaxRadius(
+                        c.codX * width, c.codY * height, geometry.eyeWidth[eye], geometry.eyeHeight[eye]);
+                    const bool inside = radius < viewportRadius;
+                    foldsInside = foldsInside || inside;
+                    printf("%-24s %-6s %-6s %14.6g %14.6g %14.6g %12.1f %12.1f%s\n",
+                           profile.first.c_str(),
+                           EyeNames[eye],
+                           ChannelNames[channel],
+                           c.k1,
+                           c.k2,
+                           c.k3,
+                           radius,
+                           viewportRadius,
+                           inside ? " FOLDS INSIDE" : "");
+                }
+            }
+        }
+
+        printf("%s\n", foldsInside ? "Some channels fold over inside of the viewport (clamped by the shim)"
+                                   : "No channel folds over inside of the viewport");
+        return 0;
+    }
+
+} // namespace shim_host
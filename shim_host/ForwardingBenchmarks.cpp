@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "ShimDriverManager.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    const BenchmarkResult* FindResult(const BenchmarkRunner& runner, const std::string& name) {
+        const auto& results = runner.Results();
+        const auto it =
+            std::find_if(results.cbegin(), results.cend(), [&](const BenchmarkResult& r) { return r.name == name; });
+        return it != results.cend() ? &*it : nullptr;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    void RunForwardingBenchmarks(BenchmarkRunner& runner, const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start() || !host.IsShimmed()) {
+            return;
+        }
+
+        // The vendor device, as vrserver calls it without the shim. Read through volatile pointers, so that the calls
+        // are not devirtualized.
+        vr::ITrackedDeviceServerDriver* volatile vendorDevicePointer = &host.Vendor();
+        vr::IVRDisplayComponent* volatile vendorDisplayPointer = &host.Vendor();
+        vr::ITrackedDeviceServerDriver* const vendorDevice = vendorDevicePointer;
+        vr::IVRDisplayComponent* const vendorDisplay = vendorDisplayPointer;
+
+        // The same vendor device, wrapped like a controller or a tracker would be.
+        vr::ITrackedDeviceServerDriver* const trackerShim =
+            driver_shim::CreateTrackedDeviceShimDriver(vendorDevice, vr::TrackedDeviceClass_GenericTracker);
+
+        const std::pair<const char*, vr::ITrackedDeviceServerDriver*> devices[] = {
+            {"vendor", vendorDevice}, {"hmd", host.Device()}, {"tracker", trackerShim}};
+        for (const auto& [name, device] : devices) {
+            runner.Run(std::string("Forwarding/GetPose/") + name, 1.0, [&, device = device](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    DoNotOptimize(device->GetPose());
+                }
+            });
+        }
+
+        const std::pair<const char*, vr::IVRDisplayComponent*> displays[] = {{"vendor", vendorDisplay},
+                                                                              {"hmd", host.Display()}};
+        for (const auto& [name, display] : displays) {
+            runner.Run(std::string("Forwarding/IsDisplayOnDesktop/") + name,
+                       1.0,
+                       [&, display = display](uint64_t iterations) {
+                           for (uint64_t i = 0; i < iterations; i++) {
+                               DoNotOptimize(display->IsDisplayOnDesktop());
+                           }
+                       });
+            runner.Run(std::string("Forwarding/GetWindowBounds/") + name,
+                       1.0,
+                       [&, display = display](uint64_t iterations) {
+                           int32_t x, y;
+                           uint32_t width, height;
+                           for (uint64_t i = 0; i < iterations; i++) {
+                               display->GetWindowBounds(&x, &y, &width, &height);
+                               DoNotOptimize(width);
+                           }
+                       });
+            runner.Run(std::string("Forwarding/ComputeInverseDistortion/") + name,
+                       1.0,
+                       [&, display = display](uint64_t iterations) {
+                           vr::HmdVector2_t result;
+                           for (uint64_t i = 0; i < iterations; i++) {
+                               DoNotOptimize(display->ComputeInverseDistortion(&result, vr::Eye_Left, 0, 0.5f, 0.5f));
+                           }
+                       });
+        }
+
+        // The pass-through methods should cost the same as calling the vendor device directly, but for the extra
+        // indirect jump.
+        for (const char* method : {"GetPose", "IsDisplayOnDesktop", "GetWindowBounds", "ComputeInverseDistortion"}) {
+            const std::string prefix = std::string("Forwarding/") + method + "/";
+            const BenchmarkResult* vendor = FindResult(runner, prefix + "vendor");
+            if (!vendor) {
+                continue;
+            }
+            for (const char* shim : {"hmd", "tracker"}) {
+                const BenchmarkResult* shimmed = FindResult(runner, prefix + shim);
+                if (!shimmed) {
+                    continue;
+                }
+                const MannWhitneyResult test = MannWhitneyU(vendor->realTimeNs, shimmed->realTimeNs);
+                printf("%s: %s overhead %+.2f ns/call (p=%.3f)\n",
+                       method,
+                       shim,
+                       Median(shimmed->realTimeNs) - Median(vendor->realTimeNs),
+                       test.pValue);
+            }
+        }
+    }
+
+} // namespace shim_host
@@ -0,0 +1,280 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "Commands.h"
+#include "Contour.h"
+#include "HiddenAreaMesh.h"
+#include "LensProfile.h"
+#include "Parallel.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    // The hidden area of one eye, in render target pixels.
+    struct HiddenArea {
+        Contour visible;
+        std::vector<Contour> pockets;
+        std::vector<Point2d> triangles;
+        double hiddenPixels = 0.0;
+    };
+
+    // The image of the edges of the display through the distortion: for each sample, the channel that lands the
+    // farthest from the center, so that the contour bounds the texels of all channels.
+    Contour TraceVisibleContour(vr::IVRDisplayComponent* display,
+                                vr::EVREye eye,
+                                uint32_t samples,
+                                uint32_t renderWidth,
+                                uint32_t renderHeight) {
+        std::vector<vr::DistortionCoordinates_t> border;
+        for (uint32_t i = 0; i < samples * 4; i++) {
+            const float t = (float)(i % samples) / samples;
+            const float u[] = {t, 1.f, 1.f - t, 0.f};
+            const float v[] = {0.f, t, 1.f, 1.f - t};
+            border.push_back(display->ComputeDistortion(eye, u[i / samples], v[i / samples]));
+        }
+
+        Point2d center{0, 0};
+        for (const auto& coordinates : border) {
+            center.x += coordinates.rfGreen[0] * renderWidth / border.size();
+            center.y += coordinates.rfGreen[1] * renderHeight / border.size();
+        }
+
+        Contour contour;
+        for (const auto& coordinates : border) {
+            const float* const channels[] = {coordinates.rfRed, coordinates.rfGreen, coordinates.rfBlue};
+            Point2d farthest{};
+            double farthestDistance = -1;
+            for (const float* channel : channels) {
+                const Point2d p{channel[0] * (double)renderWidth, channel[1] * (double)renderHeight};
+                const double distance = (p.x - center.x) * (p.x - center.x) + (p.y - center.y) * (p.y - center.y);
+                if (distance > farthestDistance) {
+                    farthest = p;
+                    farthestDistance = distance;
+                }
+            }
+            contour.push_back(farthest);
+        }
+        if (SignedArea(contour) < 0) {
+            std::reverse(contour.begin(), contour.end());
+        }
+        return contour;
+    }
+
+    HiddenArea BuildHiddenArea(
+        const Contour& contour, double tolerance, double margin, uint32_t renderWidth, uint32_t renderHeight) {
+        HiddenArea area;
+        area.visible = ClipToRectangle(SimplifyOutwards(contour, tolerance, margin), renderWidth, renderHeight);
+        area.pockets = ComplementInRectangle(area.visible, renderWidth, renderHeight);
+        for (const Contour& pocket : area.pockets) {
+            area.hiddenPixels += std::abs(SignedArea(pocket));
+            for (const uint32_t index : Triangulate(pocket)) {
+                area.triangles.push_back(pocket[index]);
+            }
+        }
+        return area;
+    }
+
+    driver_shim::HiddenAreaMesh ToUV(const std::vector<Point2d>& points, uint32_t renderWidth, uint32_t renderHeight) {
+        driver_shim::HiddenAreaMesh uv;
+        for (const Point2d& p : points) {
+            uv.push_back({(float)(p.x / renderWidth), (float)(p.y / renderHeight)});
+        }
+        return uv;
+    }
+
+    // Count the texels whose center is covered by the hidden triangles, and among them the ones the distortion samples
+    // (the bilinear footprint of any channel, for every pixel of the display).
+    void VerifyHiddenArea(vr::IVRDisplayComponent* display,
+                          vr::EVREye eye,
+                          const HiddenArea& area,
+                          uint32_t renderWidth,
+                          uint32_t renderHeight,
+                          uint32_t threadCount,
+                          uint64_t& hiddenTexels,
+                          uint64_t& sampledHiddenTexels) {
+        uint32_t x, y, width, height;
+        display->GetEyeOutputViewport(eye, &x, &y, &width, &height);
+
+        std::unique_ptr<std::atomic<uint8_t>[]> sampled(new std::atomic<uint8_t>[(size_t)renderWidth * renderHeight]());
+        ParallelFor(threadCount, height, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; row++) {
+                for (uint32_t column = 0; column < width; column++) {
+                    const vr::DistortionCoordinates_t coordinates =
+                        display->ComputeDistortion(eye, (column + 0.5f) / width, (row + 0.5f) / height);
+                    const float* const channels[] = {coordinates.rfRed, coordinates.rfGreen, coordinates.rfBlue};
+                    for (const float* channel : channels) {
+                        const int64_t left = (int64_t)std::floor(channel[0] * renderWidth - 0.5f);
+                        const int64_t top = (int64_t)std::floor(channel[1] * renderHeight - 0.5f);
+                        for (int64_t ty = std::max<int64_t>(top, 0); ty <= std::min<int64_t>(top + 1, renderHeight - 1);
+                             ty++) {
+                            for (int64_t tx = std::max<int64_t>(left, 0);
+                                 tx <= std::min<int64_t>(left + 1, renderWidth - 1);
+                                 tx++) {
+                                sampled[ty * renderWidth + tx].store(1, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        std::vector<uint8_t> hidden((size_t)renderWidth * renderHeight, 0);
+        for (size_t i = 0; i + 2 < area.triangles.size(); i += 3) {
+            const Point2d& a = area.triangles[i];
+            const Point2d& b = area.triangles[i + 1];
+            const Point2d& c = area.triangles[i + 2];
+            const auto Edge = [](const Point2d& p, const Point2d& q, double px, double py) {
+                return (q.x - p.x) * (py - p.y) - (q.y - p.y) * (px - p.x);
+            };
+            const int64_t minX = std::max<int64_t>(0, (int64_t)std::floor(std::min({a.x, b.x, c.x})));
+            const int64_t maxX = std::min<int64_t>(renderWidth - 1, (int64_t)std::ceil(std::max({a.x, b.x, c.x})));
+            const int64_t minY = std::max<int64_t>(0, (int64_t)std::floor(std::min({a.y, b.y, c.y})));
+            const int64_t maxY = std::min<int64_t>(renderHeight - 1, (int64_t)std::ceil(std::max({a.y, b.y, c.y})));
+            for (int64_t ty = minY; ty <= maxY; ty++) {
+                for (int64_t tx = minX; tx <= maxX; tx++) {
+                    const double px = tx + 0.5, py = ty + 0.5;
+                    if (Edge(a, b, px, py) >= 0 && Edge(b, c, px, py) >= 0 && Edge(c, a, px, py) >= 0) {
+                        hidden[ty * renderWidth + tx] = 1;
+                    }
+                }
+            }
+        }
+
+        hiddenTexels = 0;
+        sampledHiddenTexels = 0;
+        for (size_t i = 0; i < hidden.size(); i++) {
+            hiddenTexels += hidden[i];
+            sampledHiddenTexels += hidden[i] && sampled[i].load(std::memory_order_relaxed);
+        }
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunHiddenArea(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host hiddenarea <output> [--variant <name>] [--samples <n>] [--tolerance <px>] "
+                    "[--margin <px>] [--sweep <list>] [--verify] [--threads <n>]\n");
+            return 1;
+        }
+
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+        vr::IVRDisplayComponent* const display = host.Display();
+
+        // Trace the model of the shim, after applying the variant to its settings.
+        const std::string variant = args.Get("variant", "settings");
+        const std::optional<LensProfile> profile = LensProfile::FindVariant(
+            LensProfile::FromSettings(&host.Runtime().settings), host.Vendor().Script().eyeWidth, variant);
+        if (!profile) {
+            fprintf(stderr, "Unknown variant: %s\n", variant.c_str());
+            return 1;
+        }
+        host.ChangeSettings([&](FakeSettings& settings) { profile->ToSettings(&settings); });
+
+        const uint32_t samples = (uint32_t)std::max<int64_t>(4, args.GetInt("samples", 256));
+        const double tolerance = std::max(0.0, args.GetDouble("tolerance", 1.0));
+        const double margin = std::max(0.0, args.GetDouble("margin", 1.0));
+        const uint32_t threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+        std::vector<double> sweep;
+        for (const std::string& value : args.GetList("sweep", "0.25,0.5,1,2,4,8")) {
+            sweep.push_back(std::max(0.0, std::strtod(value.c_str(), nullptr)));
+        }
+
+        uint32_t renderWidth, renderHeight;
+        display->GetRecommendedRenderTargetSize(&renderWidth, &renderHeight);
+        const double renderPixels = (double)renderWidth * renderHeight;
+
+        driver_shim::HiddenAreaMeshes meshes;
+        bool isValid = true;
+        for (int eye = 0; eye < 2; eye++) {
+            const Contour contour = TraceVisibleContour(display, (vr::EVREye)eye, samples, renderWidth, renderHeight);
+            const HiddenArea exact = BuildHiddenArea(contour, 0.0, 0.0, renderWidth, renderHeight);
+            printf("%s eye: %ux%u render target, exact boundary of %zu vertices hides %.0f pixels (%.2f%%)\n",
+                   EyeNames[eye],
+                   renderWidth,
+                   renderHeight,
+                   exact.visible.size(),
+                   exact.hiddenPixels,
+                   exact.hiddenPixels / renderPixels * 100);
+
+            for (const double value : sweep) {
+                const HiddenArea area = BuildHiddenArea(contour, value, margin, renderWidth, renderHeight);
+                printf("  tolerance %5.2f px: %4zu vertices, %4zu triangles, hides %9.0f pixels (%.2f%%, %+.0f vs "
+                       "exact)\n",
+                       value,
+                       area.visible.size(),
+                       area.triangles.size() / 3,
+                       area.hiddenPixels,
+                       area.hiddenPixels / renderPixels * 100,
+                       area.hiddenPixels - exact.hiddenPixels);
+            }
+
+            const HiddenArea area = BuildHiddenArea(contour, tolerance, margin, renderWidth, renderHeight);
+            auto& eyeMeshes = meshes.meshes[eye];
+            eyeMeshes[vr::k_eHiddenAreaMesh_Standard] = ToUV(area.triangles, renderWidth, renderHeight);
+            for (const uint32_t index : Triangulate(area.visible)) {
+                eyeMeshes[vr::k_eHiddenAreaMesh_Inverse].push_back(
+                    {(float)(area.visible[index].x / renderWidth), (float)(area.visible[index].y / renderHeight)});
+            }
+            eyeMeshes[vr::k_eHiddenAreaMesh_LineLoop] = ToUV(area.visible, renderWidth, renderHeight);
+
+            if (args.Has("verify")) {
+                uint64_t hiddenTexels, sampledHiddenTexels;
+                VerifyHiddenArea(display,
+                                 (vr::EVREye)eye,
+                                 area,
+                                 renderWidth,
+                                 renderHeight,
+                                 threadCount,
+                                 hiddenTexels,
+                                 sampledHiddenTexels);
+                printf("  verify (tolerance %.2f px, margin %.2f px): %llu texels hidden, %llu of them sampled: %s\n",
+                       tolerance,
+                       margin,
+                       (unsigned long long)hiddenTexels,
+                       (unsigned long long)sampledHiddenTexels,
+                       sampledHiddenTexels ? "FAIL" : "PASS");
+                isValid = isValid && !sampledHiddenTexels;
+            }
+        }
+
+        if (!meshes.Save(args.Positional()[0])) {
+            fprintf(stderr, "Failed to write %s\n", args.Positional()[0].c_str());
+            return 1;
+        }
+        printf("Wrote the hidden area meshes (profile %s, tolerance %.2f px, margin %.2f px) to %s\n",
+               variant.c_str(),
+               tolerance,
+               margin,
+               args.Positional()[0].c_str());
+        return isValid ? 0 : 1;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "History.h"
+
+namespace {
+
+    constexpr const char* HistoryHeader = "# shim_host benchmark history v1";
+
+    std::vector<std::string> SplitTabs(const std::string& line) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            const size_t end = line.find('\t', start);
+            fields.push_back(line.substr(start, end - start));
+            if (end == std::string::npos) {
+                break;
+            }
+            start = end + 1;
+        }
+        return fields;
+    }
+
+    std::string Sanitize(std::string value) {
+        std::replace_if(value.begin(), value.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+        return value.empty() ? "-" : value;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    bool AppendHistory(const std::string& path, const std::string& label, const std::vector<BenchmarkResult>& results) {
+        const bool isNew = !std::ifstream(path).good();
+        std::ofstream file(path, std::ios::app);
+        if (!file) {
+            return false;
+        }
+
+        if (isNew) {
+            file << HistoryHeader << "\n";
+        }
+        file << "run\t" << (int64_t)std::time(nullptr) << "\t" << Sanitize(label) << "\t" << Sanitize(HostName())
+             << "\n";
+        char value[32];
+        for (const auto& result : results) {
+            file << Sanitize(result.name);
+            for (const double realTime : result.realTimeNs) {
+                snprintf(value, sizeof(value), "\t%.5g", realTime / result.itemsPerIteration);
+                file << value;
+            }
+            file << "\n";
+        }
+
+        return file.good();
+    }
+
+    std::optional<std::vector<HistoryRun>> LoadHistory(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            fprintf(stderr, "Failed to open %s\n", path.c_str());
+            return {};
+        }
+
+        std::vector<HistoryRun> runs;
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            const auto fields = SplitTabs(line);
+            if (fields[0] == "run") {
+                if (fields.size() < 3) {
+                    fprintf(stderr, "%s:%d: invalid run header\n", path.c_str(), lineNumber);
+                    return {};
+                }
+                HistoryRun run;
+                run.timestamp = atoll(fields[1].c_str());
+                run.label = fields[2];
+                run.hostName = fields.size() > 3 ? fields[3] : "";
+                runs.push_back(std::move(run));
+            } else {
+                if (runs.empty()) {
+                    fprintf(stderr, "%s:%d: result outside of a run\n", path.c_str(), lineNumber);
+                    return {};
+                }
+                std::vector<double>& values = runs.back().nsPerItem[fields[0]];
+                for (size_t i = 1; i < fields.size(); i++) {
+                    values.push_back(atof(fields[i].c_str()));
+                }
+            }
+        }
+
+        return runs;
+    }
+
+} // namespace shim_host
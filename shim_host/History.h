@@ -0,0 +1,45 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Benchmark.h"
+
+namespace shim_host {
+
+    // One bench run, as stored in the history file.
+    struct HistoryRun {
+        int64_t timestamp = 0;
+        std::string label;
+        std::string hostName;
+
+        // Per-repetition real time, in nanoseconds per item, for each benchmark.
+        std::map<std::string, std::vector<double>> nsPerItem;
+    };
+
+    // The history is a tab-separated text file, appended to after each run:
+    //   run <timestamp> <label> <host name>
+    //   <benchmark name> <ns per item, repetition 1> <repetition 2>...
+    bool AppendHistory(const std::string& path, const std::string& label, const std::vector<BenchmarkResult>& results);
+    std::optional<std::vector<HistoryRun>> LoadHistory(const std::string& path);
+
+} // namespace shim_host
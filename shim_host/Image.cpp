@@ -0,0 +1,259 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Image.h"
+#include "Parallel.h"
+
+namespace {
+
+    // Header tokens are separated by whitespace, and comments run until the end of the line.
+    bool ReadHeaderToken(FILE* file, std::string& token, std::map<std::string, std::string>& metadata) {
+        token.clear();
+        int c;
+        while ((c = fgetc(file)) != EOF) {
+            if (c == '#') {
+                std::string comment;
+                while ((c = fgetc(file)) != EOF && c != '\n') {
+                    comment += (char)c;
+                }
+                const size_t keyStart = comment.find_first_not_of(' ');
+                const size_t keyEnd = comment.find(' ', keyStart);
+                if (keyStart != std::string::npos && keyEnd != std::string::npos) {
+                    metadata[comment.substr(keyStart, keyEnd - keyStart)] = comment.substr(keyEnd + 1);
+                }
+            } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                if (!token.empty()) {
+                    return true;
+                }
+            } else {
+                token += (char)c;
+            }
+        }
+        return !token.empty();
+    }
+
+    // CRC-32, 4 bytes at a time (slicing-by-4).
+    uint32_t Crc32(const uint8_t* data, size_t size) {
+        static const auto tables = [] {
+            std::vector<std::array<uint32_t, 256>> tables(4);
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++) {
+                    value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+                }
+                tables[0][i] = value;
+            }
+            for (uint32_t i = 0; i < 256; i++) {
+                for (int table = 1; table < 4; table++) {
+                    tables[table][i] = tables[0][tables[table - 1][i] & 0xff] ^ (tables[table - 1][i] >> 8);
+                }
+            }
+            return tables;
+        }();
+        uint32_t crc = ~0u;
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            crc ^= data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | ((uint32_t)data[i + 3] << 24);
+            crc = tables[3][crc & 0xff] ^ tables[2][(crc >> 8) & 0xff] ^ tables[1][(crc >> 16) & 0xff] ^
+                  tables[0][crc >> 24];
+        }
+        for (; i < size; i++) {
+            crc = tables[0][(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    void AppendBigEndian(std::vector<uint8_t>& buffer, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            buffer.push_back((uint8_t)(value >> shift));
+        }
+    }
+
+    bool WritePngChunk(FILE* file, const char* type, const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> chunk;
+        AppendBigEndian(chunk, (uint32_t)data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        AppendBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+        return fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size();
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    bool LoadPnm(const std::string& path, Image& image) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+
+        image = {};
+        std::string magic, width, height, maxValue;
+        bool success = ReadHeaderToken(file, magic, image.metadata) && (magic == "P5" || magic == "P6") &&
+                       ReadHeaderToken(file, width, image.metadata) &&
+                       ReadHeaderToken(file, height, image.metadata) &&
+                       ReadHeaderToken(file, maxValue, image.metadata);
+        const int max = success ? atoi(maxValue.c_str()) : 0;
+        success = success && max > 0 && max < 65536 && atoi(width.c_str()) > 0 && atoi(height.c_str()) > 0;
+        if (success) {
+            image.Resize(atoi(width.c_str()), atoi(height.c_str()), magic == "P5" ? 1 : 3);
+            if (max < 256) {
+                success = fread(image.pixels.data(), 1, image.pixels.size(), file) == image.pixels.size();
+                if (max != 255) {
+                    for (uint8_t& value : image.pixels) {
+                        value = (uint8_t)std::min(255, value * 255 / max);
+                    }
+                }
+            } else {
+                // 16-bit samples are big-endian.
+                std::vector<uint8_t> samples(image.pixels.size() * 2);
+                success = fread(samples.data(), 1, samples.size(), file) == samples.size();
+                for (size_t i = 0; i < image.pixels.size(); i++) {
+                    const uint32_t value = (samples[2 * i] << 8) | samples[2 * i + 1];
+                    image.pixels[i] = (uint8_t)std::min<uint32_t>(255, value * 255 / max);
+                }
+            }
+        }
+        fclose(file);
+        return success;
+    }
+
+    bool SavePnm(const std::string& path, const Image& image) {
+        if (image.channels != 1 && image.channels != 3) {
+            return false;
+        }
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        fprintf(file, "%s\n", image.channels == 1 ? "P5" : "P6");
+        for (const auto& entry : image.metadata) {
+            fprintf(file, "# %s %s\n", entry.first.c_str(), entry.second.c_str());
+        }
+        fprintf(file, "%u %u\n255\n", image.width, image.height);
+        const bool success = fwrite(image.pixels.data(), 1, image.pixels.size(), file) == image.pixels.size();
+        fclose(file);
+        return success;
+    }
+
+    bool SavePng(const std::string& path, const Image& image) {
+        if (image.channels != 1 && image.channels != 3) {
+            return false;
+        }
+
+        // The scanlines, each with filter type 0, in a zlib stream of stored (uncompressed) deflate blocks.
+        const size_t rowSize = (size_t)image.width * image.channels;
+        std::vector<uint8_t> scanlines;
+        scanlines.reserve((rowSize + 1) * image.height);
+        for (uint32_t y = 0; y < image.height; y++) {
+            scanlines.push_back(0);
+            scanlines.insert(scanlines.end(), image.Pixel(0, y), image.Pixel(0, y) + rowSize);
+        }
+        std::vector<uint8_t> stream = {0x78, 0x01};
+        stream.reserve(scanlines.size() + scanlines.size() / 65535 * 5 + 16);
+        size_t offset = 0;
+        do {
+            const size_t size = std::min<size_t>(65535, scanlines.size() - offset);
+            stream.push_back(offset + size == scanlines.size() ? 1 : 0);
+            stream.push_back((uint8_t)size);
+            stream.push_back((uint8_t)(size >> 8));
+            stream.push_back((uint8_t)~size);
+            stream.push_back((uint8_t)(~size >> 8));
+            stream.insert(stream.end(), scanlines.begin() + offset, scanlines.begin() + offset + size);
+            offset += size;
+        } while (offset < scanlines.size());
+        // Adler-32, with the modulo deferred for as long as the sums cannot overflow.
+        uint32_t a = 1, b = 0;
+        for (size_t begin = 0; begin < scanlines.size(); begin += 5552) {
+            const size_t end = std::min<size_t>(begin + 5552, scanlines.size());
+            for (size_t i = begin; i < end; i++) {
+                a += scanlines[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        AppendBigEndian(stream, (b << 16) | a);
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        bool success = fwrite(signature, 1, sizeof(signature), file) == sizeof(signature);
+
+        std::vector<uint8_t> header;
+        AppendBigEndian(header, image.width);
+        AppendBigEndian(header, image.height);
+        header.insert(header.end(), {8, (uint8_t)(image.channels == 1 ? 0 : 2), 0, 0, 0});
+        success = success && WritePngChunk(file, "IHDR", header);
+        for (const auto& entry : image.metadata) {
+            std::vector<uint8_t> text(entry.first.begin(), entry.first.end());
+            text.push_back(0);
+            text.insert(text.end(), entry.second.begin(), entry.second.end());
+            success = success && WritePngChunk(file, "tEXt", text);
+        }
+        success = success && WritePngChunk(file, "IDAT", stream) && WritePngChunk(file, "IEND", {});
+        fclose(file);
+        return success;
+    }
+
+    bool SaveImage(const std::string& path, const Image& image) {
+        const bool png = path.size() >= 4 && (path.compare(path.size() - 4, 4, ".png") == 0 ||
+                                              path.compare(path.size() - 4, 4, ".PNG") == 0);
+        return png ? SavePng(path, image) : SavePnm(path, image);
+    }
+
+    void ApplyColormap(float value, uint8_t* pixel) {
+        // Piecewise linear between 5 stops.
+        static const float stops[5][3] = {
+            {68, 1, 84}, {59, 82, 139}, {33, 145, 140}, {94, 201, 98}, {253, 231, 37}};
+        const float position = std::min(std::max(value, 0.f), 1.f) * 4;
+        const int index = std::min((int)position, 3);
+        const float t = position - index;
+        for (int channel = 0; channel < 3; channel++) {
+            pixel[channel] =
+                (uint8_t)(stops[index][channel] + t * (stops[index + 1][channel] - stops[index][channel]) + 0.5f);
+        }
+    }
+
+    Plane ExtractPlane(const Image& image, uint32_t channel, uint32_t threadCount) {
+        Plane plane;
+        plane.width = image.width;
+        plane.height = image.height;
+        plane.values.resize((size_t)image.width * image.height);
+        ParallelFor(threadCount, image.height, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++) {
+                const uint8_t* source = image.Pixel(0, (uint32_t)y) + channel;
+                float* destination = plane.Row((uint32_t)y);
+                for (uint32_t x = 0; x < image.width; x++) {
+                    destination[x] = source[(size_t)x * image.channels] * (1.f / 255.f);
+                }
+            }
+        });
+        return plane;
+    }
+
+} // namespace shim_host
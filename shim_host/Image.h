@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace shim_host {
+
+    // An 8-bit image, row-major with interleaved channels (1 for gray, 3 for RGB).
+    struct Image {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t channels = 0;
+        std::vector<uint8_t> pixels;
+
+        // The "# <key> <value>" comments of the file header, eg: how a simulated capture was made.
+        std::map<std::string, std::string> metadata;
+
+        void Resize(uint32_t newWidth, uint32_t newHeight, uint32_t newChannels) {
+            width = newWidth;
+            height = newHeight;
+            channels = newChannels;
+            pixels.assign((size_t)width * height * channels, 0);
+        }
+
+        uint8_t* Pixel(uint32_t x, uint32_t y) {
+            return &pixels[((size_t)y * width + x) * channels];
+        }
+
+        const uint8_t* Pixel(uint32_t x, uint32_t y) const {
+            return &pixels[((size_t)y * width + x) * channels];
+        }
+    };
+
+    // Binary PGM (P5) and PPM (P6) files. 16-bit files are reduced to 8 bits.
+    bool LoadPnm(const std::string& path, Image& image);
+    bool SavePnm(const std::string& path, const Image& image);
+
+    // PNG files, uncompressed, with the metadata as tEXt chunks.
+    bool SavePng(const std::string& path, const Image& image);
+
+    // PNG when the path ends with .png, PGM/PPM otherwise.
+    bool SaveImage(const std::string& path, const Image& image);
+
+    // One channel of an image, as floats between 0 and 1.
+    struct Plane {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<float> values;
+
+        float* Row(uint32_t y) {
+            return &values[(size_t)y * width];
+        }
+
+        const float* Row(uint32_t y) const {
+            return &values[(size_t)y * width];
+        }
+    };
+
+    // Map a value between 0 and 1 to the viridis color scale, into an RGB pixel.
+    void ApplyColormap(float value, uint8_t* pixel);
+
+    Plane ExtractPlane(const Image& image, uint32_t channel, uint32_t threadCount);
+
+} // namespace shim_host
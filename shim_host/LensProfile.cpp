@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "LensProfile.h"
+
+namespace {
+    using namespace shim_host;
+
+    std::string Key(int eye, const char* name) {
+        return std::string(EyeNames[eye]) + "_" + name;
+    }
+
+    std::string Key(int eye, int channel, const char* name) {
+        return std::string(EyeNames[eye]) + "_" + ChannelNames[channel] + "_" + name;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    LensProfile LensProfile::FromSettings(vr::IVRSettings* settings) {
+        LensProfile profile;
+        const auto Get = [&](const std::string& key) { return settings->GetFloat(LensProfileSection, key.c_str()); };
+        for (int eye = 0; eye < 2; eye++) {
+            Eye& e = profile.eyes[eye];
+            e.focalLengthX = Get(Key(eye, "focal_length_x"));
+            e.focalLengthY = Get(Key(eye, "focal_length_y"));
+            e.principalPointX = Get(Key(eye, "principal_point_x"));
+            e.principalPointY = Get(Key(eye, "principal_point_y"));
+            e.skewFactor = Get(Key(eye, "skew_factor"));
+            for (int channel = 0; channel < 3; channel++) {
+                Channel& c = e.channels[channel];
+                c.codX = Get(Key(eye, channel, "cod_x"));
+                c.codY = Get(Key(eye, channel, "cod_y"));
+                c.k1 = Get(Key(eye, channel, "k1"));
+                c.k2 = Get(Key(eye, channel, "k2"));
+                c.k3 = Get(Key(eye, channel, "k3"));
+            }
+        }
+        return profile;
+    }
+
+    void LensProfile::ToSettings(vr::IVRSettings* settings) const {
+        const auto Set = [&](const std::string& key, float value) {
+            settings->SetFloat(LensProfileSection, key.c_str(), value);
+        };
+        for (int eye = 0; eye < 2; eye++) {
+            const Eye& e = eyes[eye];
+            Set(Key(eye, "focal_length_x"), e.focalLengthX);
+            Set(Key(eye, "focal_length_y"), e.focalLengthY);
+            Set(Key(eye, "principal_point_x"), e.principalPointX);
+            Set(Key(eye, "principal_point_y"), e.principalPointY);
+            Set(Key(eye, "skew_factor"), e.skewFactor);
+            for (int channel = 0; channel < 3; channel++) {
+                const Channel& c = e.channels[channel];
+                Set(Key(eye, channel, "cod_x"), c.codX);
+                Set(Key(eye, channel, "cod_y"), c.codY);
+                Set(Key(eye, channel, "k1"), c.k1);
+                Set(Key(eye, channel, "k2"), c.k2);
+                Set(Key(eye, channel, "k3"), c.k3);
+            }
+        }
+    }
+
+    void LensProfile::SetRadial(float k1, float k2, float k3, float chromaticSpread) {
+        for (int eye = 0; eye < 2; eye++) {
+            for (int channel = 0; channel < 3; channel++) {
+                const float scale = 1.f + (channel - 1) * chromaticSpread;
+                Channel& c = eyes[eye].channels[channel];
+                c.k1 = k1 * scale;
+                c.k2 = k2 * scale;
+                c.k3 = k3 * scale;
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, LensProfile>> LensProfile::Variants(const LensProfile& base, uint32_t eyeWidth) {
+        // Scale the coefficients so that each term contributes a plausible amount of distortion at the edge of the
+        // panel.
+        const double halfWidth = eyeWidth / 2.0;
+        const float k1 = (float)(0.1 / std::pow(halfWidth, 2));
+        const float k2 = (float)(0.02 / std::pow(halfWidth, 4));
+        const float k3 = (float)(0.005 / std::pow(halfWidth, 6));
+
+        const struct {
+            const char* name;
+            float k1, k2, k3;
+            float chromaticSpread;
+        } variants[] = {
+            {"identity", 0.f, 0.f, 0.f, 0.f},
+            {"k1", k1, 0.f, 0.f, 0.f},
+            {"k1k2", k1, k2, 0.f, 0.f},
+            {"k1k2k3", k1, k2, k3, 0.f},
+            {"k1k2k3_chromatic", k1, k2, k3, 0.02f},
+            {"pincushion_chromatic", -k1, -k2, 0.f, 0.02f},
+        };
+
+        std::vector<std::pair<std::string, LensProfile>> profiles;
+        for (const auto& variant : variants) {
+            LensProfile profile = base;
+            profile.SetRadial(variant.k1, variant.k2, variant.k3, variant.chromaticSpread);
+            profiles.emplace_back(variant.name, profile);
+        }
+        return profiles;
+    }
+
+    std::optional<LensProfile> LensProfile::FindVariant(const LensProfile& base,
+                                                        uint32_t eyeWidth,
+                                                        const std::string& name) {
+        if (name == "settings") {
+            return base;
+        }
+        for (const auto& variant : Variants(base, eyeWidth)) {
+            if (variant.first == name) {
+                return variant.second;
+            }
+        }
+        return {};
+    }
+
+} // namespace shim_host
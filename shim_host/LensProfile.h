@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace shim_host {
+
+    // The shim's lens parameters, as stored in the driver_distortion_shim settings section. Values are normalized
+    // to the eye viewport, like in default.vrsettings.
+    struct LensProfile {
+        struct Channel {
+            float codX = 0.5f;
+            float codY = 0.5f;
+            float k1 = 0.f;
+            float k2 = 0.f;
+            float k3 = 0.f;
+        };
+
+        struct Eye {
+            float focalLengthX = 0.6f;
+            float focalLengthY = 0.6f;
+            float principalPointX = 0.5f;
+            float principalPointY = 0.5f;
+            float skewFactor = 1.f;
+
+            // Red, green, blue.
+            Channel channels[3];
+        };
+
+        Eye eyes[2];
+
+        static LensProfile FromSettings(vr::IVRSettings* settings);
+        void ToSettings(vr::IVRSettings* settings) const;
+
+        // Apply the same radial coefficients to all channels of both eyes. A non-zero chromatic spread scales the red
+        // and blue coefficients in opposite directions.
+        void SetRadial(float k1, float k2, float k3, float chromaticSpread = 0.f);
+
+        // A set of representative models derived from a base profile, from identity to strong chromatic distortion.
+        // The coefficients are scaled for radii in pixels on a panel of the given width.
+        static std::vector<std::pair<std::string, LensProfile>> Variants(const LensProfile& base, uint32_t eyeWidth);
+
+        // One of the variants by name, or the base profile itself for "settings".
+        static std::optional<LensProfile> FindVariant(const LensProfile& base,
+                                                      uint32_t eyeWidth,
+                                                      const std::string& name);
+    };
+
+    inline constexpr const char* LensProfileSection = "driver_distortion_shim";
+    inline constexpr const char* EyeNames[2] = {"left", "right"};
+    inline constexpr const char* ChannelNames[3] = {"red", "green", "blue"};
+
+} // namespace shim_host
@@ -0,0 +1,128 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "pch.h"
+
+#include "Commands.h"
+#include "DistortionPipeline.h"
+#include "HiddenAreaMesh.h"
+
+namespace {
+    using namespace shim_host;
+
+    struct LoaderCase {
+        const char* name;
+        std::string contents;
+        bool expected;
+    };
+
+    bool WriteFile(const std::string& path, const std::string& contents) {
+        std::ofstream file(path);
+        file << contents;
+        return !!file;
+    }
+
+    // Load each file, and compare the success against the expectation.
+    bool CheckCases(const char* title,
+                    const std::vector<LoaderCase>& cases,
+                    const std::function<bool(const std::string& path)>& load) {
+        const std::string path = (std::filesystem::temp_directory_path() / "shim_host_loaders.txt").string();
+        bool passed = true;
+        for (const LoaderCase& c : cases) {
+            const bool loaded = WriteFile(path, c.contents) && load(path);
+            const bool ok = loaded == c.expected;
+            printf("%s, %s: %s: %s\n", title, c.name, loaded ? "loaded" : "rejected", ok ? "PASS" : "FAIL");
+            passed = passed && ok;
+        }
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return passed;
+    }
+
+    // The offsets of a residual grid for both eyes.
+    std::string ResidualOffsets(uint32_t columns, uint32_t rows) {
+        std::string offsets;
+        for (uint32_t i = 0; i < columns * rows * 2; i++) {
+            offsets += "0.5 -0.25\n";
+        }
+        return offsets;
+    }
+
+    bool CheckResidualGrid() {
+        const std::vector<LoaderCase> cases = {
+            {"valid", "# Comment\n3 2\n" + ResidualOffsets(3, 2), true},
+            {"missing offsets", "3 2\n" + ResidualOffsets(3, 1), false},
+            {"extra offsets", "3 2\n" + ResidualOffsets(3, 3), false},
+            {"no header", "", false},
+            {"one column", "1 2\n" + ResidualOffsets(1, 2), false},
+            {"fractional size", "2.5 2\n" + ResidualOffsets(2, 2), false},
+            {"NaN size", "nan 2\n" + ResidualOffsets(2, 2), false},
+            {"infinite size", "inf 2\n" + ResidualOffsets(2, 2), false},
+            {"negative size", "-3 2\n" + ResidualOffsets(3, 2), false},
+            {"huge size", "1e10 2\n", false},
+            {"too large", "1025 2\n" + ResidualOffsets(1025, 2), false},
+        };
+        return CheckCases("Residual grid", cases, [](const std::string& path) {
+            return driver_shim::ResidualGrid::Load(path) != nullptr;
+        });
+    }
+
+    // A section of a hidden area mesh file, with its vertices.
+    std::string HiddenAreaSection(const char* header, uint32_t vertices) {
+        std::string section = std::string(header) + "\n";
+        for (uint32_t i = 0; i < vertices; i++) {
+            section += "0.25 0.75\n";
+        }
+        return section;
+    }
+
+    bool CheckHiddenAreaMeshes() {
+        const std::vector<LoaderCase> cases = {
+            {"valid",
+             "# Comment\n" + HiddenAreaSection("left standard 6", 6) + HiddenAreaSection("right inverse 3", 3) +
+                 HiddenAreaSection("right line_loop 4", 4),
+             true},
+            {"empty", "", true},
+            {"partial standard triangle", HiddenAreaSection("left standard 4", 4), false},
+            {"partial inverse triangle", HiddenAreaSection("right inverse 5", 5), false},
+            {"missing vertices", HiddenAreaSection("left standard 6", 5), false},
+            {"unknown eye", HiddenAreaSection("center standard 3", 3), false},
+            {"unknown type", HiddenAreaSection("left triangles 3", 3), false},
+            {"too many vertices", HiddenAreaSection("left standard 4294967295", 3), false},
+        };
+        return CheckCases("Hidden area meshes", cases, [](const std::string& path) {
+            driver_shim::HiddenAreaMeshes meshes;
+            return meshes.Load(path);
+        });
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunLoaders(const Arguments& args) {
+        bool passed = CheckResidualGrid();
+        passed = CheckHiddenAreaMeshes() && passed;
+        printf("%s\n", passed ? "PASSED" : "FAILED");
+        return passed ? 0 : 1;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,167 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace shim_host {
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+#ifdef _WIN32
+    bool MappedFile::OpenRead(const std::string& path) {
+        Close();
+        m_file = CreateFileA(path.c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN,
+                             nullptr);
+        LARGE_INTEGER size;
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size)) {
+            Close();
+            return false;
+        }
+        m_size = size.QuadPart;
+        return Map(false);
+    }
+
+    bool MappedFile::Create(const std::string& path, uint64_t size) {
+        Close();
+        m_file = CreateFileA(path.c_str(),
+                             GENERIC_READ | GENERIC_WRITE,
+                             0,
+                             nullptr,
+                             CREATE_ALWAYS,
+                             FILE_FLAG_SEQUENTIAL_SCAN,
+                             nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            Close();
+            return false;
+        }
+        m_size = size;
+        return Map(true);
+    }
+
+    bool MappedFile::Map(bool writable) {
+        // Empty files cannot be mapped, but there is nothing to access either.
+        if (!m_size) {
+            return true;
+        }
+        m_mapping = CreateFileMappingA(m_file,
+                                       nullptr,
+                                       writable ? PAGE_READWRITE : PAGE_READONLY,
+                                       (DWORD)(m_size >> 32),
+                                       (DWORD)m_size,
+                                       nullptr);
+        m_data = m_mapping ? (uint8_t*)MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0)
+                           : nullptr;
+        if (!m_data) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (m_data) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file && m_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_file);
+        }
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+        m_size = 0;
+    }
+#else
+    bool MappedFile::OpenRead(const std::string& path) {
+        Close();
+        m_file = open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (m_file < 0 || fstat(m_file, &status) != 0) {
+            Close();
+            return false;
+        }
+        m_size = (uint64_t)status.st_size;
+        return Map(false);
+    }
+
+    bool MappedFile::Create(const std::string& path, uint64_t size) {
+        Close();
+        m_file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (m_file < 0 || ftruncate(m_file, (off_t)size) != 0) {
+            Close();
+            return false;
+        }
+        m_size = size;
+        return Map(true);
+    }
+
+    bool MappedFile::Map(bool writable) {
+        // Empty files cannot be mapped, but there is nothing to access either.
+        if (!m_size) {
+            return true;
+        }
+        void* const data =
+            mmap(nullptr, m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_file, 0);
+        if (data == MAP_FAILED) {
+            Close();
+            return false;
+        }
+        m_data = (uint8_t*)data;
+        madvise(m_data, m_size, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (m_data) {
+            munmap(m_data, m_size);
+        }
+        if (m_file >= 0) {
+            close(m_file);
+        }
+        m_data = nullptr;
+        m_file = -1;
+        m_size = 0;
+    }
+#endif
+
+} // namespace shim_host
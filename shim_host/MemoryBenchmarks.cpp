@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "Compositor.h"
+#include "LensProfile.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    struct ShimMemory {
+        size_t currentBytes = 0;
+        size_t peakBytes = 0;
+    };
+
+    // Query the shim's memory accounting, like a debugging tool would through vrserver.
+    ShimMemory QueryShimMemory(ShimHost& host) {
+        char response[4096] = {};
+        host.Device()->DebugRequest("distortion_shim:memory", response, sizeof(response));
+
+        ShimMemory memory;
+        std::istringstream lines(response);
+        std::string tag;
+        size_t current, peak;
+        uint64_t allocations;
+        while (lines >> tag >> current >> peak >> allocations) {
+            memory.currentBytes += current;
+            memory.peakBytes += peak;
+        }
+        return memory;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    void RunMemoryBenchmarks(BenchmarkRunner& runner, const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return;
+        }
+
+        const LensProfile base = LensProfile::FromSettings(&host.Runtime().settings);
+        const auto variants = LensProfile::Variants(base, host.Vendor().Script().eyeWidth);
+        const vr::PropertyContainerHandle_t container =
+            host.Runtime().properties.TrackedDeviceToPropertyContainer(host.Vendor().deviceIndex);
+        const int32_t deviceResolution =
+            vr::VRProperties()->GetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32);
+        const int repetitions = BenchmarkRunner::OptionsFromArguments(args).repetitions;
+
+        for (const auto& resolution :
+             args.GetList("resolutions", std::to_string(deviceResolution) + ",64,128,256,512")) {
+            const int32_t n = std::max(2, atoi(resolution.c_str()));
+            vr::VRProperties()->SetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32, n);
+            SimulatedCompositor compositor(host, 1);
+
+            // Change the model then rebuild the mesh, so that any table sized on the mesh is rebuilt too.
+            BenchmarkResult result;
+            result.name = "Memory/" + std::to_string(n);
+            result.iterations = 1;
+            result.itemsPerIteration = 2.0;
+            for (int i = 0; i < repetitions; i++) {
+                const LensProfile& profile = variants[1 + i % (variants.size() - 1)].second;
+                host.ChangeSettings([&](FakeSettings& settings) { profile.ToSettings(&settings); });
+
+                const auto start = std::chrono::steady_clock::now();
+                compositor.Update();
+                const double elapsed =
+                    std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+                const ShimMemory memory = QueryShimMemory(host);
+                result.realTimeNs.push_back(elapsed);
+                result.cpuTimeNs.push_back(elapsed);
+                result.counters["shim_bytes_per_eye"].push_back(memory.currentBytes / 2.0);
+                result.counters["shim_peak_bytes_per_eye"].push_back(memory.peakBytes / 2.0);
+                result.counters["mesh_bytes_per_eye"].push_back((double)n * n * sizeof(vr::DistortionCoordinates_t));
+            }
+            runner.Record(std::move(result));
+        }
+
+        vr::VRProperties()->SetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32, deviceResolution);
+    }
+
+} // namespace shim_host
@@ -0,0 +1,71 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+#include "ShimHost.h"
+
+namespace shim_host {
+
+    int RunMesh(const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+
+        const vr::PropertyContainerHandle_t container =
+            host.Runtime().properties.TrackedDeviceToPropertyContainer(host.Vendor().deviceIndex);
+        const int32_t resolution = (int32_t)args.GetInt(
+            "resolution",
+            vr::VRProperties()->GetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32));
+        if (resolution < 2) {
+            fprintf(stderr, "Invalid mesh resolution: %d\n", resolution);
+            return 1;
+        }
+
+        printf("# shimmed: %s\n", host.IsShimmed() ? "yes" : "no");
+        printf("# eye u v red_u red_v green_u green_v blue_u blue_v\n");
+        for (int eye = 0; eye < 2; eye++) {
+            for (int32_t y = 0; y < resolution; y++) {
+                for (int32_t x = 0; x < resolution; x++) {
+                    const float u = (float)x / (resolution - 1);
+                    const float v = (float)y / (resolution - 1);
+                    const vr::DistortionCoordinates_t result = host.Display()->ComputeDistortion((vr::EVREye)eye, u, v);
+                    printf("%d %.6f %.6f %.6f %.6f %.6f %.6f %.6f %.6f\n",
+                           eye,
+                           u,
+                           v,
+                           result.rfRed[0],
+                           result.rfRed[1],
+                           result.rfGreen[0],
+                           result.rfGreen[1],
+                           result.rfBlue[0],
+                           result.rfBlue[1]);
+                }
+            }
+        }
+
+        return 0;
+    }
+
+} // namespace shim_host
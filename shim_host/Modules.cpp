@@ -0,0 +1,195 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmark.h"
+#include "Commands.h"
+#include "DeviceRegistry.h"
+#include "ModuleIndex.h"
+#include "ShimHost.h"
+
+#include <random>
+
+namespace {
+    using namespace shim_host;
+    using driver_shim::ModuleIndex;
+    using driver_shim::ModuleRange;
+
+    // Random non-overlapping ranges with gaps, and the matching linear lookup.
+    std::vector<ModuleRange> MakeSyntheticRanges(uint32_t count, std::mt19937_64& generator) {
+        std::vector<ModuleRange> ranges;
+        uintptr_t address = 0x10000;
+        for (uint32_t i = 0; i < count; i++) {
+            address += 0x1000 * (1 + generator() % 16);
+            const uintptr_t size = 0x1000 * (1 + generator() % 256);
+            ranges.push_back({address, address + size, "module" + std::to_string(i) + ".dll", i % 7 == 0});
+            address += size;
+        }
+        std::shuffle(ranges.begin(), ranges.end(), generator);
+        return ranges;
+    }
+
+    const ModuleRange* FindLinear(const std::vector<ModuleRange>& ranges, uintptr_t address) {
+        for (const ModuleRange& range : ranges) {
+            if (address >= range.begin && address < range.end) {
+                return &range;
+            }
+        }
+        return nullptr;
+    }
+
+    bool CheckSynthetic(uint32_t rangeCount, uint64_t lookups, uint64_t seed) {
+        std::mt19937_64 generator(seed);
+        const std::vector<ModuleRange> ranges = MakeSyntheticRanges(rangeCount, generator);
+        const ModuleIndex index(ranges);
+
+        // The edges of each range, and random addresses over the whole span.
+        std::vector<uintptr_t> addresses{0, UINTPTR_MAX};
+        uintptr_t span = 0;
+        for (const ModuleRange& range : ranges) {
+            addresses.insert(addresses.end(), {range.begin - 1, range.begin, range.end - 1, range.end});
+            span = std::max(span, range.end);
+        }
+        for (uint64_t i = 0; i < lookups; i++) {
+            addresses.push_back(generator() % (span + 0x10000));
+        }
+
+        uint64_t mismatches = 0;
+        for (const uintptr_t address : addresses) {
+            const ModuleRange* expected = FindLinear(ranges, address);
+            const ModuleRange* actual = index.Find(address);
+            if (!expected != !actual || (expected && expected->name != actual->name)) {
+                if (mismatches++ == 0) {
+                    fprintf(stderr, "Mismatch at %p\n", (void*)address);
+                }
+            }
+        }
+        printf("Synthetic: %u ranges, %zu lookups, %llu mismatches: %s\n",
+               rangeCount,
+               addresses.size(),
+               (unsigned long long)mismatches,
+               mismatches ? "FAIL" : "PASS");
+        return mismatches == 0;
+    }
+
+    bool CheckNames() {
+        const struct {
+            const char* module;
+            const char* targets;
+            bool expected;
+        } cases[] = {
+            {"driver_oasis.dll", "driver_oasis", true},
+            {"DRIVER_OASIS.DLL", "driver_oasis", true},
+            {"driver_oasis.so.1", "driver_lighthouse, driver_oasis", true},
+            {"driver_oasis.dll", "Driver_Oasis.dll", true},
+            {"driver_oasis2.dll", "driver_oasis", false},
+            {"driver_oasis.dll", "", false},
+            {"", "driver_oasis", false},
+        };
+        bool passed = true;
+        for (const auto& c : cases) {
+            const bool actual = driver_shim::IsTargetModuleName(c.module, driver_shim::ParseModuleNames(c.targets));
+            if (actual != c.expected) {
+                fprintf(stderr, "Name mismatch: \"%s\" against \"%s\"\n", c.module, c.targets);
+                passed = false;
+            }
+        }
+        printf("Names: %s\n", passed ? "PASS" : "FAIL");
+        return passed;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunModules(const Arguments& args) {
+        bool passed = CheckNames();
+        const uint64_t lookups = (uint64_t)args.GetInt("lookups", 100000);
+        const uint64_t seed = (uint64_t)args.GetInt("seed", 1);
+        for (const uint32_t count : {1u, 2u, 64u, (uint32_t)std::max<int64_t>(1, args.GetInt("ranges", 4096))}) {
+            passed = CheckSynthetic(count, lookups, seed) && passed;
+        }
+
+        // The modules of this process: the lookup must find our own code.
+        const auto start = std::chrono::steady_clock::now();
+        const std::unique_ptr<ModuleIndex> index = ModuleIndex::FromProcess({});
+        const double buildMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const ModuleRange* self = index->Find((uintptr_t)(void*)&RunModules);
+        printf("Process: %zu modules, indexed in %.3f ms, this code is in %s\n",
+               index->Ranges().size(),
+               buildMs,
+               self ? self->name.c_str() : "(not found)");
+        passed = passed && self;
+
+        // The cost of a lookup, as done by each TrackedDeviceAdded().
+        const uint64_t iterations = 1000000;
+        const auto lookupStart = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            DoNotOptimize(index->Find((uintptr_t)(void*)&RunModules + (i & 0xff)));
+        }
+        printf("Lookup: %.1f ns\n",
+               std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - lookupStart).count() /
+                   iterations);
+
+        // End to end: the scripted HMD is registered from this module, so it is shimmed only when named.
+        if (self) {
+            const std::string selfName = self->name.substr(0, self->name.find('.'));
+            const std::pair<std::string, bool> cases[] = {{selfName, true}, {"driver_other", false}};
+            for (const auto& targets : cases) {
+                ShimHost::Options options = ShimHost::OptionsFromArguments(args);
+                options.overrideSettings = [&](FakeSettings& settings) {
+                    settings.SetString("driver_distortion_shim", "target_drivers", targets.first.c_str());
+                };
+                ShimHost host(options);
+                const bool started = host.Start();
+                const bool ok = started && host.IsShimmed() == targets.second;
+                printf("target_drivers=%s: %s: %s\n",
+                       targets.first.c_str(),
+                       host.IsShimmed() ? "shimmed" : "not shimmed",
+                       ok ? "PASS" : "FAIL");
+                passed = passed && ok;
+            }
+        }
+
+        // Every flavor of the driver host wraps the HMD exactly once: IVRServerDriverHost_005 shares the vtable of the
+        // current flavor, and IVRServerDriverHost_004 is an adapter calling the current flavor through its vtable, ie:
+        // through a second hook.
+        const char* const versions[] = {
+            vr::IVRServerDriverHost_Version, "IVRServerDriverHost_005", "IVRServerDriverHost_004"};
+        for (const char* version : versions) {
+            ShimHost::Options options = ShimHost::OptionsFromArguments(args);
+            options.serverDriverHostVersion = version;
+            ShimHost host(options);
+            const bool started = host.Start();
+            const size_t shimDevices = driver_shim::GetDeviceRegistry().GetActiveDevices()->size();
+            const bool ok = started && host.IsShimmed() && shimDevices == 1;
+            printf("%s: %zu shim device(s): %s\n", version, shimDevices, ok ? "PASS" : "FAIL");
+            passed = passed && ok;
+        }
+
+        printf("%s\n", passed ? "PASSED" : "FAILED");
+        return passed ? 0 : 1;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,46 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace shim_host {
+
+    // Split [0, count) into contiguous ranges of similar size, one per thread, and call function(begin, end) for each
+    // of them. The calling thread takes the first range.
+    template <typename TFunction>
+    void ParallelFor(uint32_t threadCount, size_t count, const TFunction& function) {
+        threadCount = (uint32_t)std::max<size_t>(1, std::min<size_t>(threadCount, count));
+        const auto Run = [&](uint32_t index) {
+            function(count * index / threadCount, count * (index + 1) / threadCount);
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; i++) {
+            threads.emplace_back(Run, i);
+        }
+        Run(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+} // namespace shim_host
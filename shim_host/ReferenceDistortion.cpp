@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "ReferenceDistortion.h"
+
+#include "LensAnalysis.h"
+
+namespace shim_host {
+
+    DisplayGeometry DisplayGeometry::FromDisplay(vr::IVRDisplayComponent* display) {
+        DisplayGeometry geometry;
+        for (int eye = 0; eye < 2; eye++) {
+            uint32_t x, y;
+            display->GetEyeOutputViewport((vr::EVREye)eye, &x, &y, &geometry.eyeWidth[eye], &geometry.eyeHeight[eye]);
+            float left, right, top, bottom;
+            display->GetProjectionRaw((vr::EVREye)eye, &left, &right, &top, &bottom);
+            geometry.projectionRaw[eye][0] = left;
+            geometry.projectionRaw[eye][1] = right;
+            geometry.projectionRaw[eye][2] = top;
+            geometry.projectionRaw[eye][3] = bottom;
+        }
+        return geometry;
+    }
+
+    ReferenceDistortion::ReferenceDistortion(const LensProfile& profile, const DisplayGeometry& geometry)
+        : m_geometry(geometry) {
+        // Like the shim, the normalized settings are scaled by the dimensions of the left eye for both eyes.
+        const double width = geometry.eyeWidth[vr::Eye_Left];
+        const double height = geometry.eyeHeight[vr::Eye_Left];
+
+        for (int eye = 0; eye < 2; eye++) {
+            const LensProfile::Eye& source = profile.eyes[eye];
+            Eye& e = m_eyes[eye];
+            e.focalLengthX = (double)source.focalLengthX * width;
+            e.focalLengthY = (double)source.focalLengthY * height;
+            e.principalPointX = (double)source.principalPointX * width;
+            e.principalPointY = (double)source.principalPointY * height;
+            e.skewFactor = source.skewFactor;
+
+            // The shim passes the bottom tangent as top and vice-versa, then only uses the magnitudes.
+            e.left = std::abs(geometry.projectionRaw[eye][0]);
+            e.right = std::abs(geometry.projectionRaw[eye][1]);
+            e.top = std::abs(geometry.projectionRaw[eye][3]);
+            e.bottom = std::abs(geometry.projectionRaw[eye][2]);
+
+            for (int channel = 0; channel < 3; channel++) {
+                const LensProfile::Channel& c = source.channels[channel];
+                const double maxRadius = driver_shim::FindFoldOverRadius(c.k1, c.k2, c.k3);
+                e.channels[channel] = {
+                    (double)c.codX * width, (double)c.codY * height, c.k1, c.k2, c.k3, maxRadius * maxRadius};
+            }
+        }
+    }
+
+    ReferenceDistortion::Result ReferenceDistortion::Evaluate(vr::EVREye eye, double u, double v) const {
+        const Eye& e = m_eyes[eye];
+        const double x = u * m_geometry.eyeWidth[eye];
+        const double y = v * m_geometry.eyeHeight[eye];
+
+        Result result;
+        for (int channel = 0; channel < 3; channel++) {
+            double distortedX, distortedY;
+            Distort(eye, channel, x, y, distortedX, distortedY);
+
+            // Inverse of the affine transform [fx 0; s fy; cx cy] (row-vector convention).
+            const double tangentY = (distortedY - e.principalPointY) / e.focalLengthY;
+            const double tangentX = (distortedX - e.principalPointX - e.skewFactor * tangentY) / e.focalLengthX;
+
+            result.uv[channel][0] = (tangentX + e.left) / (e.left + e.right);
+            result.uv[channel][1] = (tangentY + e.top) / (e.top + e.bottom);
+        }
+        return result;
+    }
+
+    void ReferenceDistortion::Distort(
+        vr::EVREye eye, int channel, double x, double y, double& outX, double& outY) const {
+        const Channel& c = m_eyes[eye].channels[channel];
+        const double dx = x - c.codX;
+        const double dy = y - c.codY;
+        // Like the shim, do not go past the fold-over radius.
+        const double r2 = std::min(dx * dx + dy * dy, c.maxRadius2);
+        const double d = 1.0 + r2 * (c.k1 + r2 * (c.k2 + r2 * c.k3));
+        outX = dx * d + c.codX;
+        outY = dy * d + c.codY;
+    }
+
+} // namespace shim_host
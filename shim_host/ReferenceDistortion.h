@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "LensProfile.h"
+
+namespace shim_host {
+
+    // What the shim reads from the wrapped display component to evaluate its distortion.
+    struct DisplayGeometry {
+        uint32_t eyeWidth[2] = {};
+        uint32_t eyeHeight[2] = {};
+
+        // As returned by GetProjectionRaw(): left, right, top, bottom.
+        double projectionRaw[2][4] = {};
+
+        static DisplayGeometry FromDisplay(vr::IVRDisplayComponent* display);
+    };
+
+    // Double-precision evaluation of the full distortion chain of HmdShimDriver::ComputeDistortion(): UV to display
+    // pixels, Brown-Conrady, inverse affine to tangent space, then normalization by the projection tangents. This is
+    // the ground truth that every faster path is compared against.
+    class ReferenceDistortion {
+      public:
+        ReferenceDistortion(const LensProfile& profile, const DisplayGeometry& geometry);
+
+        struct Result {
+            // Red, green, blue.
+            double uv[3][2];
+        };
+
+        Result Evaluate(vr::EVREye eye, double u, double v) const;
+
+        // Display pixel coordinates after the radial distortion of one channel, ie: before the affine transform.
+        void Distort(vr::EVREye eye, int channel, double x, double y, double& outX, double& outY) const;
+
+        const DisplayGeometry& Geometry() const {
+            return m_geometry;
+        }
+
+        struct Channel {
+            double codX, codY;
+            double k1, k2, k3;
+
+            // Square of the radius where the channel folds over.
+            double maxRadius2;
+        };
+
+        struct Eye {
+            // Inverse of the affine transform (tangent space to display pixels).
+            double focalLengthX, focalLengthY;
+            double principalPointX, principalPointY;
+            double skewFactor;
+
+            // Tangents, after the shim's normalization.
+            double left, right, top, bottom;
+
+            Channel channels[3];
+        };
+
+        const Eye& GetEye(vr::EVREye eye) const {
+            return m_eyes[eye];
+        }
+
+      private:
+        const DisplayGeometry m_geometry;
+        Eye m_eyes[2];
+    };
+
+} // namespace shim_host
@@ -0,0 +1,288 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmark.h"
+#include "Calibration.h"
+#include "Commands.h"
+#include "FakeRuntime.h"
+#include "Image.h"
+#include "Parallel.h"
+#include "ReferenceDistortion.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    // One evaluation of the source distortion, at normalized display coordinates.
+    struct SourceSample {
+        uint8_t eye;
+        float u, v;
+        vr::DistortionCoordinates_t coordinates;
+    };
+
+    // The output of the mesh command: "<eye> <u> <v> <red u> <red v> <green u> <green v> <blue u> <blue v>" lines.
+    bool LoadMesh(const std::string& path, std::vector<SourceSample>& samples) {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            SourceSample sample;
+            int eye;
+            vr::DistortionCoordinates_t& c = sample.coordinates;
+            if (sscanf(line.c_str(),
+                       "%d %f %f %f %f %f %f %f %f",
+                       &eye,
+                       &sample.u,
+                       &sample.v,
+                       &c.rfRed[0],
+                       &c.rfRed[1],
+                       &c.rfGreen[0],
+                       &c.rfGreen[1],
+                       &c.rfBlue[0],
+                       &c.rfBlue[1]) != 9 ||
+                (eye != 0 && eye != 1)) {
+                return false;
+            }
+            sample.eye = (uint8_t)eye;
+            samples.push_back(sample);
+        }
+        return !samples.empty();
+    }
+
+    // The cost of one ComputeDistortion() call, over a grid of both eyes.
+    double MeasureNanosecondsPerCall(vr::IVRDisplayComponent* display) {
+        constexpr int n = 64;
+        uint64_t calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        double elapsed;
+        do {
+            for (int eye = 0; eye < 2; eye++) {
+                for (int y = 0; y < n; y++) {
+                    for (int x = 0; x < n; x++) {
+                        DoNotOptimize(display->ComputeDistortion((vr::EVREye)eye, (x + 0.5f) / n, (y + 0.5f) / n));
+                    }
+                }
+            }
+            calls += 2 * n * n;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < 0.1);
+        return elapsed * 1e9 / calls;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunRefit(const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+        const DisplayGeometry geometry = DisplayGeometry::FromDisplay(&host.Vendor());
+        const uint32_t width = geometry.eyeWidth[vr::Eye_Left];
+        const uint32_t height = geometry.eyeHeight[vr::Eye_Left];
+
+        // The tangents of the shim's normalization, which only depend on the projection of the display.
+        const ReferenceDistortion reference(LensProfile::FromSettings(&host.Runtime().settings), geometry);
+
+        // Sample the source densely: the vendor's own distortion, the current model of the shim, or a dumped mesh.
+        const std::string source = args.Get("source", "vendor");
+        std::vector<SourceSample> samples;
+        double sourceCost = 0;
+        if (source == "vendor" || source == "shim") {
+            vr::IVRDisplayComponent* const display =
+                source == "vendor" ? static_cast<vr::IVRDisplayComponent*>(&host.Vendor()) : host.Display();
+            const uint32_t n = (uint32_t)std::max<int64_t>(2, args.GetInt("samples", 128));
+            for (int eye = 0; eye < 2; eye++) {
+                for (uint32_t y = 0; y < n; y++) {
+                    for (uint32_t x = 0; x < n; x++) {
+                        SourceSample sample;
+                        sample.eye = (uint8_t)eye;
+                        sample.u = (x + 0.5f) / n;
+                        sample.v = (y + 0.5f) / n;
+                        sample.coordinates = display->ComputeDistortion((vr::EVREye)eye, sample.u, sample.v);
+                        samples.push_back(sample);
+                    }
+                }
+            }
+            sourceCost = MeasureNanosecondsPerCall(display);
+        } else if (source.rfind("mesh:", 0) == 0) {
+            if (!LoadMesh(source.substr(5), samples)) {
+                fprintf(stderr, "Failed to read %s\n", source.substr(5).c_str());
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Unknown source: %s\n", source.c_str());
+            return 1;
+        }
+
+        // One correspondence per sample and channel, weighted towards the center of the viewport if requested.
+        const double centerWeight = args.GetDouble("center-weight", 0.0);
+        std::vector<Correspondence> points[2];
+        for (const SourceSample& sample : samples) {
+            const ReferenceDistortion::Eye& e = reference.GetEye((vr::EVREye)sample.eye);
+            const double du = sample.u - 0.5, dv = (sample.v - 0.5) * height / width;
+            const float weight = (float)(1.0 + centerWeight * std::max(0.0, 1.0 - 4 * (du * du + dv * dv)));
+            const float* const uv[3] = {
+                sample.coordinates.rfRed, sample.coordinates.rfGreen, sample.coordinates.rfBlue};
+            for (int channel = 0; channel < 3; channel++) {
+                Correspondence point;
+                point.eye = sample.eye;
+                point.channel = (uint8_t)channel;
+                point.x = sample.u * geometry.eyeWidth[sample.eye];
+                point.y = sample.v * geometry.eyeHeight[sample.eye];
+                point.tangentX = (float)(uv[channel][0] * (e.left + e.right) - e.left);
+                point.tangentY = (float)(uv[channel][1] * (e.top + e.bottom) - e.top);
+                point.weight = weight;
+                if (std::isfinite(point.tangentX) && std::isfinite(point.tangentY)) {
+                    points[sample.eye].push_back(point);
+                }
+            }
+        }
+
+        FitOptions options;
+        options.threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+        options.maxIterations = (uint32_t)std::max<int64_t>(1, args.GetInt("iterations", 100));
+        const double budget = args.GetDouble("budget", 1.0);
+
+        // From the fewest radial terms up, until one fits within the budget.
+        struct Candidate {
+            int terms;
+            LensProfile profile;
+            EyeModel models[2];
+            double rms = 0, maxError = 0;
+            double cost = 0;
+        };
+        std::vector<Candidate> candidates;
+        const int maxTerms = (int)std::min<int64_t>(3, std::max<int64_t>(1, args.GetInt("terms", 3)));
+        printf("%zu samples from %s", samples.size(), source.c_str());
+        if (sourceCost > 0) {
+            printf(" (%.1f ns per call)", sourceCost);
+        }
+        printf("\n%-6s %12s %12s %14s\n", "terms", "rms_px", "max_px", "ns_per_call");
+        for (int terms = 1; terms <= maxTerms; terms++) {
+            Candidate candidate;
+            candidate.terms = terms;
+            options.radialTerms = terms;
+            double sumSquares = 0;
+            size_t count = 0;
+            for (int eye = 0; eye < 2; eye++) {
+                if (points[eye].empty()) {
+                    continue;
+                }
+                EyeModel& model = candidate.models[eye];
+                model = EstimateAffine(points[eye], width, height);
+                const FitReport report = FitEyeModel(points[eye], model, width, options);
+                model.ToProfile(candidate.profile, eye, width, height);
+                for (int channel = 0; channel < 3; channel++) {
+                    sumSquares += report.rms[channel] * report.rms[channel] * (points[eye].size() / 3.0);
+                    candidate.maxError = std::max(candidate.maxError, report.maxError[channel]);
+                }
+                count += points[eye].size();
+            }
+            candidate.rms = std::sqrt(sumSquares / std::max<size_t>(1, count));
+
+            // What the shim costs with this profile.
+            host.ChangeSettings([&](FakeSettings& settings) { candidate.profile.ToSettings(&settings); });
+            candidate.cost = MeasureNanosecondsPerCall(host.Display());
+            printf("%-6d %12.4f %12.4f %14.1f%s\n",
+                   terms,
+                   candidate.rms,
+                   candidate.maxError,
+                   candidate.cost,
+                   candidate.maxError <= budget ? " within budget" : "");
+            candidates.push_back(candidate);
+            if (candidate.maxError <= budget && !args.Has("all")) {
+                break;
+            }
+        }
+
+        const auto chosen = std::find_if(candidates.cbegin(), candidates.cend(), [&](const Candidate& candidate) {
+            return candidate.maxError <= budget;
+        });
+        const Candidate& result = chosen != candidates.cend() ? *chosen : candidates.back();
+        if (chosen == candidates.cend()) {
+            printf("No model within the budget of %.3f px, keeping %d terms\n", budget, result.terms);
+        }
+
+        const std::string output = args.Get("output");
+        if (!output.empty()) {
+            FakeSettings settings;
+            result.profile.ToSettings(&settings);
+            if (!settings.SaveToFile(output)) {
+                fprintf(stderr, "Failed to write %s\n", output.c_str());
+                return 1;
+            }
+            printf("Wrote the lens profile with %d terms to %s\n", result.terms, output.c_str());
+        }
+
+        // The remaining error of each sample (the worst channel), on the grid of the samples.
+        const std::string errorMap = args.Get("error-map");
+        if (!errorMap.empty()) {
+            const uint32_t n = (uint32_t)std::max<int64_t>(2, args.GetInt("samples", 128));
+            for (int eye = 0; eye < 2; eye++) {
+                Image image;
+                image.Resize(n, n, 3);
+                std::vector<float> errors((size_t)n * n);
+                for (const Correspondence& point : points[eye]) {
+                    double errorX, errorY;
+                    result.models[eye].Residual(point, errorX, errorY);
+                    const uint32_t x = std::min(n - 1, (uint32_t)(point.x / geometry.eyeWidth[eye] * n));
+                    const uint32_t y = std::min(n - 1, (uint32_t)(point.y / geometry.eyeHeight[eye] * n));
+                    float& error = errors[(size_t)y * n + x];
+                    error = std::max(error, (float)std::sqrt(errorX * errorX + errorY * errorY));
+                }
+                const float maxError = std::max(*std::max_element(errors.cbegin(), errors.cend()), 1e-9f);
+                for (uint32_t y = 0; y < n; y++) {
+                    for (uint32_t x = 0; x < n; x++) {
+                        ApplyColormap(errors[(size_t)y * n + x] / maxError, image.Pixel(x, y));
+                    }
+                }
+                char buffer[64];
+                snprintf(buffer, sizeof(buffer), "0 %.6g", maxError);
+                image.metadata["range"] = buffer;
+                image.metadata["eye"] = EyeNames[eye];
+                image.metadata["source"] = source;
+                const std::string path = errorMap + "_" + EyeNames[eye] + ".png";
+                if (!SaveImage(path, image)) {
+                    fprintf(stderr, "Failed to write %s\n", path.c_str());
+                    return 1;
+                }
+                printf("Wrote the error map of the %s eye (up to %.4f px) to %s\n",
+                       EyeNames[eye],
+                       maxError,
+                       path.c_str());
+            }
+        }
+
+        return chosen != candidates.cend() ? 0 : 1;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,373 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmark.h"
+#include "Commands.h"
+#include "DistortionPipeline.h"
+#include "ShimHost.h"
+#include "TraceRecorder.h"
+
+namespace {
+    using namespace shim_host;
+    using driver_shim::trace::Opcode;
+
+    // A setting read by the shim: a number, or a string.
+    struct RecordedSetting {
+        std::string key;
+        float value = 0.f;
+        std::optional<std::string> string;
+    };
+
+    // One call to re-issue, or one settings change to apply.
+    struct ReplayStep {
+        Opcode opcode;
+        vr::EVREye eye = vr::Eye_Left;
+        float u = 0.f;
+        float v = 0.f;
+        vr::DistortionCoordinates_t expected{};
+        std::vector<RecordedSetting> settings;
+    };
+
+    struct Trace {
+        DisplayScript display;
+        std::vector<RecordedSetting> initialSettings;
+        std::vector<ReplayStep> steps;
+        uint64_t computeDistortionCount = 0;
+    };
+
+    class TraceReader {
+      public:
+        explicit TraceReader(std::vector<uint8_t> data) : m_data(std::move(data)) {
+        }
+
+        bool AtEnd() const {
+            return m_offset >= m_data.size();
+        }
+
+        template <typename T>
+        bool Read(T& value) {
+            if (m_data.size() - m_offset < sizeof(T)) {
+                return false;
+            }
+            memcpy(&value, m_data.data() + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        bool ReadString(std::string& value, size_t length) {
+            if (m_data.size() - m_offset < length) {
+                return false;
+            }
+            value.assign((const char*)m_data.data() + m_offset, length);
+            m_offset += length;
+            return true;
+        }
+
+        size_t Offset() const {
+            return m_offset;
+        }
+
+      private:
+        const std::vector<uint8_t> m_data;
+        size_t m_offset = 0;
+    };
+
+    std::optional<Trace> LoadTrace(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "Failed to open %s\n", path.c_str());
+            return {};
+        }
+        TraceReader reader(std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {}));
+
+        uint32_t magic = 0, version = 0;
+        if (!reader.Read(magic) || !reader.Read(version) || magic != driver_shim::trace::Magic || version < 1 ||
+            version > driver_shim::trace::Version) {
+            fprintf(stderr, "%s is not a trace file (or an unsupported version)\n", path.c_str());
+            return {};
+        }
+
+        Trace trace;
+        // Settings read before any SettingsChanged come from Activate().
+        std::vector<RecordedSetting>* settings = &trace.initialSettings;
+        while (!reader.AtEnd()) {
+            const size_t offset = reader.Offset();
+            uint8_t opcode = 0, eye = 0;
+            bool ok = reader.Read(opcode);
+            ReplayStep step{(Opcode)opcode};
+            switch (step.opcode) {
+            case Opcode::Display: {
+                uint32_t x, y, width, height;
+                float projection[4];
+                ok = ok && reader.Read(eye) && eye < 2 && reader.Read(x) && reader.Read(y) && reader.Read(width) &&
+                     reader.Read(height) && reader.Read(projection);
+                if (ok) {
+                    if (eye == vr::Eye_Left) {
+                        trace.display.eyeWidth = width;
+                        trace.display.eyeHeight = height;
+                    }
+                    std::copy(std::begin(projection), std::end(projection), trace.display.projectionRaw[eye]);
+                }
+                break;
+            }
+
+            case Opcode::RenderTargetSize:
+                ok = ok && reader.Read(trace.display.renderWidth) && reader.Read(trace.display.renderHeight);
+                break;
+
+            case Opcode::Setting: {
+                uint8_t length = 0;
+                std::string key;
+                float value = 0.f;
+                ok = ok && reader.Read(length) && reader.ReadString(key, length) && reader.Read(value);
+                if (ok) {
+                    settings->push_back({std::move(key), value});
+                }
+                break;
+            }
+
+            case Opcode::StringSetting: {
+                uint8_t keyLength = 0;
+                uint16_t valueLength = 0;
+                std::string key, value;
+                ok = ok && reader.Read(keyLength) && reader.ReadString(key, keyLength) && reader.Read(valueLength) &&
+                     reader.ReadString(value, valueLength);
+                if (ok) {
+                    settings->push_back({std::move(key), 0.f, std::move(value)});
+                }
+                break;
+            }
+
+            case Opcode::SettingsChanged:
+                trace.steps.push_back(std::move(step));
+                settings = &trace.steps.back().settings;
+                break;
+
+            case Opcode::GetRecommendedRenderTargetSize: {
+                uint32_t size[2];
+                ok = ok && reader.Read(size);
+                trace.steps.push_back(std::move(step));
+                break;
+            }
+
+            case Opcode::GetEyeOutputViewport: {
+                uint32_t viewport[4];
+                ok = ok && reader.Read(eye) && eye < 2 && reader.Read(viewport);
+                step.eye = (vr::EVREye)eye;
+                trace.steps.push_back(std::move(step));
+                break;
+            }
+
+            case Opcode::GetProjectionRaw: {
+                float projection[4];
+                ok = ok && reader.Read(eye) && eye < 2 && reader.Read(projection);
+                step.eye = (vr::EVREye)eye;
+                trace.steps.push_back(std::move(step));
+                break;
+            }
+
+            case Opcode::ComputeDistortion:
+                ok = ok && reader.Read(eye) && eye < 2 && reader.Read(step.u) && reader.Read(step.v) &&
+                     reader.Read(step.expected.rfRed) && reader.Read(step.expected.rfGreen) &&
+                     reader.Read(step.expected.rfBlue);
+                step.eye = (vr::EVREye)eye;
+                trace.steps.push_back(std::move(step));
+                trace.computeDistortionCount++;
+                break;
+
+            default:
+                ok = false;
+                break;
+            }
+
+            if (!ok) {
+                fprintf(stderr, "%s: invalid or truncated record at offset %zu\n", path.c_str(), offset);
+                return {};
+            }
+        }
+
+        return trace;
+    }
+
+    // Whether the shim read a pipeline with the vendor distortion at any point. The trace only has the geometry of the
+    // vendor display, not its distortion (nor the serial number and the cache directory of its table), so such a
+    // session cannot be reproduced.
+    bool UsesVendorDistortion(const Trace& trace) {
+        std::string pipeline;
+        bool composeVendorDistortion = false;
+        const auto Update = [&](const std::vector<RecordedSetting>& settings) {
+            for (const RecordedSetting& setting : settings) {
+                if (setting.key == "pipeline" && setting.string) {
+                    pipeline = *setting.string;
+                } else if (setting.key == "compose_vendor_distortion") {
+                    composeVendorDistortion = setting.value != 0.f;
+                }
+            }
+            if (pipeline.empty()) {
+                return composeVendorDistortion;
+            }
+            driver_shim::PipelineStages stages;
+            return driver_shim::ParsePipeline(pipeline, stages) &&
+                   std::find(stages.cbegin(), stages.cend(), driver_shim::PipelineStage::Vendor) != stages.cend();
+        };
+
+        bool usesVendorDistortion = Update(trace.initialSettings);
+        for (const ReplayStep& step : trace.steps) {
+            if (step.opcode == Opcode::SettingsChanged) {
+                usesVendorDistortion = Update(step.settings) || usesVendorDistortion;
+            }
+        }
+        return usesVendorDistortion;
+    }
+
+    void ApplySettings(ShimHost& host, const std::vector<RecordedSetting>& settings) {
+        host.ChangeSettings([&](FakeSettings& fakeSettings) {
+            for (const RecordedSetting& setting : settings) {
+                if (setting.string) {
+                    fakeSettings.SetString("driver_distortion_shim", setting.key.c_str(), setting.string->c_str());
+                } else {
+                    fakeSettings.SetFloat("driver_distortion_shim", setting.key.c_str(), setting.value);
+                }
+            }
+        });
+    }
+
+    // Issue the calls of the trace, in order. Returns the largest difference between the recorded and replayed
+    // ComputeDistortion() results, in UV units.
+    float Replay(ShimHost& host, const Trace& trace) {
+        vr::IVRDisplayComponent* const display = host.Display();
+        float maxDifference = 0.f;
+        for (const ReplayStep& step : trace.steps) {
+            switch (step.opcode) {
+            case Opcode::SettingsChanged:
+                ApplySettings(host, step.settings);
+                break;
+
+            case Opcode::GetRecommendedRenderTargetSize: {
+                uint32_t width, height;
+                display->GetRecommendedRenderTargetSize(&width, &height);
+                DoNotOptimize(width);
+                break;
+            }
+
+            case Opcode::GetEyeOutputViewport: {
+                uint32_t x, y, width, height;
+                display->GetEyeOutputViewport(step.eye, &x, &y, &width, &height);
+                DoNotOptimize(width);
+                break;
+            }
+
+            case Opcode::GetProjectionRaw: {
+                float left, right, top, bottom;
+                display->GetProjectionRaw(step.eye, &left, &right, &top, &bottom);
+                DoNotOptimize(left);
+                break;
+            }
+
+            case Opcode::ComputeDistortion: {
+                const vr::DistortionCoordinates_t result = display->ComputeDistortion(step.eye, step.u, step.v);
+                for (int i = 0; i < 2; i++) {
+                    maxDifference = std::max({maxDifference,
+                                              std::abs(result.rfRed[i] - step.expected.rfRed[i]),
+                                              std::abs(result.rfGreen[i] - step.expected.rfGreen[i]),
+                                              std::abs(result.rfBlue[i] - step.expected.rfBlue[i])});
+                }
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+        return maxDifference;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunReplay(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr, "Usage: shim_host replay <trace file> [--tolerance <uv>] [--json <path>]\n");
+            return 1;
+        }
+        const std::string path = args.Positional()[0];
+        const std::optional<Trace> trace = LoadTrace(path);
+        if (!trace) {
+            return 1;
+        }
+        printf("%s: %zu calls (%llu ComputeDistortion), %ux%u per eye\n",
+               path.c_str(),
+               trace->steps.size(),
+               (unsigned long long)trace->computeDistortionCount,
+               trace->display.eyeWidth,
+               trace->display.eyeHeight);
+        if (UsesVendorDistortion(*trace)) {
+            fprintf(stderr,
+                    "%s: the session composes the vendor distortion, which is not recorded in traces: it cannot be "
+                    "replayed\n",
+                    path.c_str());
+            return 1;
+        }
+
+        // The vendor display is emulated from the geometry captured in the trace.
+        ShimHost::Options options = ShimHost::OptionsFromArguments(args);
+        options.display = trace->display;
+        options.tracePath.clear();
+        ShimHost host(options);
+        if (!host.Start()) {
+            return 1;
+        }
+        ApplySettings(host, trace->initialSettings);
+
+        // Check that the shim still produces the recorded results before measuring it.
+        const double tolerance = args.GetDouble("tolerance", 1e-5);
+        const float maxDifference = Replay(host, *trace);
+        printf("Max difference with the recorded results: %g UV\n", maxDifference);
+        if (!(maxDifference <= tolerance)) {
+            fprintf(stderr, "Replay does not match the recording (tolerance %g)\n", tolerance);
+            return 1;
+        }
+
+        BenchmarkRunner runner(BenchmarkRunner::OptionsFromArguments(args));
+        const std::string name = "replay/" + path.substr(path.find_last_of("/\\") + 1);
+        if (runner.Matches(name)) {
+            runner.Run(name, (double)trace->steps.size(), [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    ApplySettings(host, trace->initialSettings);
+                    DoNotOptimize(Replay(host, *trace));
+                }
+            });
+        }
+
+        const std::string jsonPath = args.Get("json");
+        if (!jsonPath.empty() && !runner.WriteJson(jsonPath)) {
+            fprintf(stderr, "Failed to write %s\n", jsonPath.c_str());
+            return 1;
+        }
+
+        return 0;
+    }
+
+} // namespace shim_host
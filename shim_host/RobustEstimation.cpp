@@ -0,0 +1,393 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Calibration.h"
+
+#include <random>
+
+namespace {
+    using namespace shim_host;
+
+    // k1..k3 (for normalized radii), fx, s, cx, fy, cy.
+    constexpr int HypothesisParameters = 8;
+    constexpr int SampleSize = 4;
+
+    // The scoring loop works on this many points at a time, with independent accumulators, so that the compiler can
+    // vectorize it without reordering the floating point additions.
+    constexpr size_t BatchWidth = 8;
+
+    // The points of one channel in structure-of-arrays layout, with the radial terms precomputed for the fixed center
+    // of distortion. The arrays are padded to a multiple of the batch width with zeros, which have no residual under
+    // any hypothesis.
+    struct ChannelBatch {
+        size_t count = 0;
+        std::vector<size_t> indices;
+
+        std::vector<float> x, y;
+        std::vector<float> tangentX, tangentY;
+
+        // delta * q^(i + 1), with q the squared normalized radius.
+        std::vector<float> radialX[3], radialY[3];
+
+        ChannelBatch(const std::vector<Correspondence>& points, int channel, double codX, double codY, double radius) {
+            const double invRadius2 = 1.0 / (radius * radius);
+            for (size_t i = 0; i < points.size(); i++) {
+                const Correspondence& point = points[i];
+                if (point.channel != channel) {
+                    continue;
+                }
+                indices.push_back(i);
+                const double dx = point.x - codX;
+                const double dy = point.y - codY;
+                const double q = (dx * dx + dy * dy) * invRadius2;
+                x.push_back(point.x);
+                y.push_back(point.y);
+                tangentX.push_back(point.tangentX);
+                tangentY.push_back(point.tangentY);
+                for (int term = 0; term < 3; term++) {
+                    radialX[term].push_back((float)(dx * std::pow(q, term + 1)));
+                    radialY[term].push_back((float)(dy * std::pow(q, term + 1)));
+                }
+            }
+
+            count = indices.size();
+            const size_t padded = (count + BatchWidth - 1) / BatchWidth * BatchWidth;
+            for (auto* column : {&x, &y, &tangentX, &tangentY}) {
+                column->resize(padded, 0.f);
+            }
+            for (int term = 0; term < 3; term++) {
+                radialX[term].resize(padded, 0.f);
+                radialY[term].resize(padded, 0.f);
+            }
+        }
+
+        // The 2 linear equations contributed by a point: x and y residuals as a function of the hypothesis.
+        void Equations(size_t i, double rowX[HypothesisParameters + 1], double rowY[HypothesisParameters + 1]) const {
+            const double equationX[] = {
+                radialX[0][i], radialX[1][i], radialX[2][i], -tangentX[i], -tangentY[i], -1, 0, 0};
+            const double equationY[] = {radialY[0][i], radialY[1][i], radialY[2][i], 0, 0, 0, -tangentY[i], -1};
+            std::copy(std::begin(equationX), std::end(equationX), rowX);
+            std::copy(std::begin(equationY), std::end(equationY), rowY);
+            rowX[HypothesisParameters] = -x[i];
+            rowY[HypothesisParameters] = -y[i];
+        }
+
+        float SquaredResidual(size_t i, const float theta[HypothesisParameters]) const {
+            const float errorX = x[i] + theta[0] * radialX[0][i] + theta[1] * radialX[1][i] +
+                                 theta[2] * radialX[2][i] - theta[3] * tangentX[i] - theta[4] * tangentY[i] -
+                                 theta[5];
+            const float errorY = y[i] + theta[0] * radialY[0][i] + theta[1] * radialY[1][i] +
+                                 theta[2] * radialY[2][i] - theta[6] * tangentY[i] - theta[7];
+            return errorX * errorX + errorY * errorY;
+        }
+
+        // MSAC cost: the squared residuals, truncated at the threshold.
+        float Score(const float theta[HypothesisParameters], float threshold2) const {
+            float lanes[BatchWidth] = {};
+            for (size_t i = 0; i < x.size(); i += BatchWidth) {
+                for (size_t lane = 0; lane < BatchWidth; lane++) {
+                    lanes[lane] += std::min(SquaredResidual(i + lane, theta), threshold2);
+                }
+            }
+            float cost = 0;
+            for (const float lane : lanes) {
+                cost += lane;
+            }
+            return cost;
+        }
+    };
+
+    // Gaussian elimination with partial pivoting.
+    template <int N>
+    bool SolveLinear(double (&a)[N][N], double (&b)[N]) {
+        for (int column = 0; column < N; column++) {
+            int pivot = column;
+            for (int row = column + 1; row < N; row++) {
+                if (std::abs(a[row][column]) > std::abs(a[pivot][column])) {
+                    pivot = row;
+                }
+            }
+            if (!(std::abs(a[pivot][column]) > 1e-300)) {
+                return false;
+            }
+            std::swap(a[pivot], a[column]);
+            std::swap(b[pivot], b[column]);
+            for (int row = column + 1; row < N; row++) {
+                const double factor = a[row][column] / a[column][column];
+                for (int k = column; k < N; k++) {
+                    a[row][k] -= factor * a[column][k];
+                }
+                b[row] -= factor * b[column];
+            }
+        }
+        for (int row = N - 1; row >= 0; row--) {
+            for (int k = row + 1; k < N; k++) {
+                b[row] -= a[row][k] * b[k];
+            }
+            b[row] /= a[row][row];
+        }
+        return std::all_of(std::begin(b), std::end(b), [](double value) { return std::isfinite(value); });
+    }
+
+    bool SolveMinimal(const ChannelBatch& batch, const size_t sample[SampleSize], double theta[HypothesisParameters]) {
+        double a[HypothesisParameters][HypothesisParameters];
+        double b[HypothesisParameters];
+        for (int i = 0; i < SampleSize; i++) {
+            double rowX[HypothesisParameters + 1], rowY[HypothesisParameters + 1];
+            batch.Equations(sample[i], rowX, rowY);
+            std::copy(rowX, rowX + HypothesisParameters, a[2 * i]);
+            std::copy(rowY, rowY + HypothesisParameters, a[2 * i + 1]);
+            b[2 * i] = rowX[HypothesisParameters];
+            b[2 * i + 1] = rowY[HypothesisParameters];
+        }
+        if (!SolveLinear(a, b)) {
+            return false;
+        }
+        std::copy(std::begin(b), std::end(b), theta);
+        return true;
+    }
+
+    struct Hypothesis {
+        float cost = std::numeric_limits<float>::infinity();
+        uint64_t index = 0;
+        float theta[HypothesisParameters] = {};
+    };
+
+    // Hypotheses are numbered, and each one draws its sample from its own generator, so that the result does not
+    // depend on the number of threads.
+    Hypothesis ScoreHypotheses(const ChannelBatch& batch,
+                               uint64_t first,
+                               uint64_t count,
+                               float threshold2,
+                               const RobustOptions& options,
+                               int channel) {
+        std::atomic<uint64_t> next{first};
+        const uint32_t threadCount = std::max(1u, std::min<uint32_t>(options.threadCount, (uint32_t)count));
+        std::vector<Hypothesis> bests(threadCount);
+        const auto Run = [&](uint32_t thread) {
+            Hypothesis& best = bests[thread];
+            uint64_t index;
+            while ((index = next++) < first + count) {
+                std::mt19937_64 generator(((uint64_t)options.seed << 32) ^ ((uint64_t)channel << 28) ^ index);
+                std::uniform_int_distribution<size_t> distribution(0, batch.count - 1);
+                size_t sample[SampleSize];
+                for (int i = 0; i < SampleSize; i++) {
+                    do {
+                        sample[i] = distribution(generator);
+                    } while (std::find(sample, sample + i, sample[i]) != sample + i);
+                }
+
+                double theta[HypothesisParameters];
+                if (!SolveMinimal(batch, sample, theta)) {
+                    continue;
+                }
+                Hypothesis hypothesis;
+                hypothesis.index = index;
+                std::copy(theta, theta + HypothesisParameters, hypothesis.theta);
+                hypothesis.cost = batch.Score(hypothesis.theta, threshold2);
+                if (hypothesis.cost < best.cost || (hypothesis.cost == best.cost && index < best.index)) {
+                    best = hypothesis;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; i++) {
+            threads.emplace_back(Run, i);
+        }
+        Run(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        Hypothesis best;
+        for (const Hypothesis& hypothesis : bests) {
+            if (hypothesis.cost < best.cost || (hypothesis.cost == best.cost && hypothesis.index < best.index)) {
+                best = hypothesis;
+            }
+        }
+        return best;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    EyeModel EstimateRobust(const std::vector<Correspondence>& points,
+                            uint32_t width,
+                            uint32_t height,
+                            const RobustOptions& options,
+                            std::vector<bool>& inliers,
+                            RobustReport& report) {
+        const double radius = width / 2.0;
+        const double codX = width / 2.0;
+        const double codY = height / 2.0;
+        const float threshold2 = (float)(options.threshold * options.threshold);
+        report = {};
+        inliers.assign(points.size(), false);
+
+        const ChannelBatch batches[3] = {ChannelBatch(points, 0, codX, codY, radius),
+                                         ChannelBatch(points, 1, codX, codY, radius),
+                                         ChannelBatch(points, 2, codX, codY, radius)};
+        for (int channel = 0; channel < 3; channel++) {
+            const ChannelBatch& batch = batches[channel];
+            report.pointCount[channel] = batch.count;
+            if (batch.count < SampleSize) {
+                // Not enough points to tell anything apart.
+                for (const size_t index : batch.indices) {
+                    inliers[index] = true;
+                }
+                report.inlierCount[channel] = batch.count;
+                continue;
+            }
+
+            // Adaptive number of hypotheses, re-evaluated after each round from the best inlier ratio so far.
+            Hypothesis best;
+            uint64_t required = options.maxHypotheses;
+            uint64_t generated = 0;
+            size_t inlierCount = 0;
+            while (generated < required) {
+                const uint64_t round = std::min<uint64_t>(required - generated, std::max(1u, options.threadCount) * 16);
+                const Hypothesis candidate = ScoreHypotheses(batch, generated, round, threshold2, options, channel);
+                generated += round;
+                if (candidate.cost >= best.cost) {
+                    continue;
+                }
+                best = candidate;
+
+                inlierCount = 0;
+                for (size_t i = 0; i < batch.count; i++) {
+                    inlierCount += batch.SquaredResidual(i, best.theta) < threshold2;
+                }
+                const double inlierRatio = (double)inlierCount / batch.count;
+                const double allInliers = std::pow(inlierRatio, SampleSize);
+                if (allInliers >= 1.0) {
+                    required = generated;
+                } else if (allInliers > 0) {
+                    required = std::min<uint64_t>(
+                        options.maxHypotheses,
+                        (uint64_t)std::ceil(std::log(1 - options.confidence) / std::log(1 - allInliers)));
+                }
+            }
+            report.hypotheses[channel] = (uint32_t)generated;
+            report.inlierCount[channel] = inlierCount;
+
+            for (size_t i = 0; i < batch.count; i++) {
+                if (batch.SquaredResidual(i, best.theta) < threshold2) {
+                    inliers[batch.indices[i]] = true;
+                }
+            }
+        }
+
+        // Least squares over the inliers of all channels, with a shared affine transform: fx, s, cx, fy, cy, then
+        // k1..k3 of each channel.
+        constexpr int JointParameters = 5 + 3 * 3;
+        double a[JointParameters][JointParameters] = {};
+        double b[JointParameters] = {};
+        for (int channel = 0; channel < 3; channel++) {
+            const ChannelBatch& batch = batches[channel];
+            for (size_t i = 0; i < batch.count; i++) {
+                if (!inliers[batch.indices[i]]) {
+                    continue;
+                }
+                double rowX[HypothesisParameters + 1], rowY[HypothesisParameters + 1];
+                batch.Equations(i, rowX, rowY);
+                const int base = 5 + 3 * channel;
+                const int indices[HypothesisParameters] = {base, base + 1, base + 2, 0, 1, 2, 3, 4};
+                for (const double* row : {rowX, rowY}) {
+                    for (int m = 0; m < HypothesisParameters; m++) {
+                        if (row[m] == 0) {
+                            continue;
+                        }
+                        for (int n = 0; n < HypothesisParameters; n++) {
+                            a[indices[m]][indices[n]] += row[m] * row[n];
+                        }
+                        b[indices[m]] += row[m] * row[HypothesisParameters];
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < JointParameters; i++) {
+            if (a[i][i] == 0) {
+                a[i][i] = 1;
+            }
+        }
+
+        EyeModel model = EstimateAffine(points, width, height);
+        if (SolveLinear(a, b)) {
+            model.focalLengthX = b[0];
+            model.skewFactor = b[1];
+            model.principalPointX = b[2];
+            model.focalLengthY = b[3];
+            model.principalPointY = b[4];
+            for (int channel = 0; channel < 3; channel++) {
+                EyeModel::Channel& c = model.channels[channel];
+                c.k1 = b[5 + 3 * channel] / std::pow(radius, 2);
+                c.k2 = b[5 + 3 * channel + 1] / std::pow(radius, 4);
+                c.k3 = b[5 + 3 * channel + 2] / std::pow(radius, 6);
+            }
+        }
+        return model;
+    }
+
+    FitReport FitEyeModelRobust(const std::vector<Correspondence>& points,
+                                EyeModel& model,
+                                uint32_t width,
+                                uint32_t height,
+                                const FitOptions& options,
+                                const RobustOptions& robustOptions,
+                                std::vector<bool>& inliers,
+                                RobustReport& report) {
+        RobustOptions coarseOptions = robustOptions;
+        coarseOptions.threshold *= std::max(1.0, robustOptions.coarseScale);
+        model = EstimateRobust(points, width, height, coarseOptions, inliers, report);
+
+        FitReport fitReport;
+        double threshold = coarseOptions.threshold;
+        for (int round = 0; round < 32; round++) {
+            std::vector<Correspondence> inlierPoints;
+            for (size_t i = 0; i < points.size(); i++) {
+                if (inliers[i]) {
+                    inlierPoints.push_back(points[i]);
+                }
+            }
+            fitReport = FitEyeModel(inlierPoints, model, width, options);
+
+            threshold = std::max(robustOptions.threshold, threshold / 2);
+            bool changed = false;
+            for (size_t i = 0; i < points.size(); i++) {
+                double errorX, errorY;
+                model.Residual(points[i], errorX, errorY);
+                const bool inlier = errorX * errorX + errorY * errorY < threshold * threshold;
+                changed = changed || inlier != inliers[i];
+                inliers[i] = inlier;
+            }
+            if (!changed && threshold == robustOptions.threshold) {
+                break;
+            }
+        }
+        return fitReport;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,160 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "ScriptedHmdDriver.h"
+
+namespace shim_host {
+
+    ScriptedHmdDriver::ScriptedHmdDriver(const DisplayScript& script) : m_script(script) {
+    }
+
+    bool ScriptedHmdDriver::Register(const char* serverDriverHostVersion) {
+        vr::EVRInitError eError;
+        vr::IVRServerDriverHost* const driverHost =
+            (vr::IVRServerDriverHost*)vr::VRDriverContext()->GetGenericInterface(serverDriverHostVersion, &eError);
+        if (!driverHost) {
+            return false;
+        }
+
+        // Go through the vtable of the host interface, so that any hook on TrackedDeviceAdded() is invoked.
+        return driverHost->TrackedDeviceAdded(m_script.serialNumber.c_str(), vr::TrackedDeviceClass_HMD, this);
+    }
+
+    vr::EVRInitError ScriptedHmdDriver::Activate(uint32_t unObjectId) {
+        activateCalls++;
+        deviceIndex = unObjectId;
+
+        const vr::PropertyContainerHandle_t container =
+            vr::VRProperties()->TrackedDeviceToPropertyContainer(deviceIndex);
+        vr::VRProperties()->SetStringProperty(container, vr::Prop_SerialNumber_String, m_script.serialNumber.c_str());
+        vr::VRProperties()->SetStringProperty(container, vr::Prop_ModelNumber_String, "Scripted HMD");
+        vr::VRProperties()->SetInt32Property(
+            container, vr::Prop_DistortionMeshResolution_Int32, m_script.distortionMeshResolution);
+        vr::VRProperties()->SetFloatProperty(container, vr::Prop_UserIpdMeters_Float, m_script.ipdMeters);
+
+        return vr::VRInitError_None;
+    }
+
+    void ScriptedHmdDriver::Deactivate() {
+        deactivateCalls++;
+        deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
+    }
+
+    void ScriptedHmdDriver::EnterStandby() {
+    }
+
+    void* ScriptedHmdDriver::GetComponent(const char* pchComponentNameAndVersion) {
+        if (!strcmp(pchComponentNameAndVersion, vr::IVRDisplayComponent_Version)) {
+            return (vr::IVRDisplayComponent*)this;
+        }
+        return nullptr;
+    }
+
+    void ScriptedHmdDriver::DebugRequest(const char* pchRequest,
+                                         char* pchResponseBuffer,
+                                         uint32_t unResponseBufferSize) {
+        if (unResponseBufferSize) {
+            pchResponseBuffer[0] = 0;
+        }
+    }
+
+    vr::DriverPose_t ScriptedHmdDriver::GetPose() {
+        vr::DriverPose_t pose{};
+        pose.qWorldFromDriverRotation.w = 1.0;
+        pose.qDriverFromHeadRotation.w = 1.0;
+        pose.qRotation.w = 1.0;
+        pose.result = vr::TrackingResult_Running_OK;
+        pose.poseIsValid = true;
+        pose.deviceIsConnected = true;
+        return pose;
+    }
+
+    void ScriptedHmdDriver::GetWindowBounds(int32_t* pnX, int32_t* pnY, uint32_t* pnWidth, uint32_t* pnHeight) {
+        *pnX = 0;
+        *pnY = 0;
+        *pnWidth = m_script.eyeWidth * 2;
+        *pnHeight = m_script.eyeHeight;
+    }
+
+    bool ScriptedHmdDriver::IsDisplayOnDesktop() {
+        return false;
+    }
+
+    bool ScriptedHmdDriver::IsDisplayRealDisplay() {
+        return true;
+    }
+
+    void ScriptedHmdDriver::GetRecommendedRenderTargetSize(uint32_t* pnWidth, uint32_t* pnHeight) {
+        *pnWidth = m_script.renderWidth;
+        *pnHeight = m_script.renderHeight;
+    }
+
+    void ScriptedHmdDriver::GetEyeOutputViewport(
+        vr::EVREye eEye, uint32_t* pnX, uint32_t* pnY, uint32_t* pnWidth, uint32_t* pnHeight) {
+        getEyeOutputViewportCalls++;
+        *pnX = eEye == vr::Eye_Left ? 0 : m_script.eyeWidth;
+        *pnY = 0;
+        *pnWidth = m_script.eyeWidth;
+        *pnHeight = m_script.eyeHeight;
+    }
+
+    void ScriptedHmdDriver::GetProjectionRaw(
+        vr::EVREye eEye, float* pfLeft, float* pfRight, float* pfTop, float* pfBottom) {
+        getProjectionRawCalls++;
+        *pfLeft = m_script.projectionRaw[eEye][0];
+        *pfRight = m_script.projectionRaw[eEye][1];
+        *pfTop = m_script.projectionRaw[eEye][2];
+        *pfBottom = m_script.projectionRaw[eEye][3];
+    }
+
+    vr::DistortionCoordinates_t ScriptedHmdDriver::ComputeDistortion(vr::EVREye eEye, float fU, float fV) {
+        computeDistortionCalls++;
+        if (m_script.computeDistortionDelay.count()) {
+            const auto deadline = std::chrono::steady_clock::now() + m_script.computeDistortionDelay;
+            while (std::chrono::steady_clock::now() < deadline) {
+            }
+        }
+
+        const float du = fU - 0.5f;
+        const float dv = fV - 0.5f;
+        const float r2 = du * du + dv * dv;
+        const auto Distort = [&](float* result, float scale) {
+            const float d = scale * (1.f + r2 * (m_script.vendorK1 + r2 * m_script.vendorK2));
+            result[0] = 0.5f + du * d;
+            result[1] = 0.5f + dv * d;
+        };
+
+        vr::DistortionCoordinates_t result{};
+        Distort(result.rfRed, 1.f - m_script.vendorChromaticAberration);
+        Distort(result.rfGreen, 1.f);
+        Distort(result.rfBlue, 1.f + m_script.vendorChromaticAberration);
+        return result;
+    }
+
+    bool ScriptedHmdDriver::ComputeInverseDistortion(
+        vr::HmdVector2_t* pResult, vr::EVREye eEye, uint32_t unChannel, float fU, float fV) {
+        return false;
+    }
+
+} // namespace shim_host
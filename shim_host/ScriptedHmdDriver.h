@@ -0,0 +1,93 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+namespace shim_host {
+
+    // The behavior of the fake vendor display.
+    struct DisplayScript {
+        std::string serialNumber = "SCRIPTED-0001";
+
+        // Panel and render target.
+        uint32_t eyeWidth = 2160;
+        uint32_t eyeHeight = 2160;
+        uint32_t renderWidth = 2880;
+        uint32_t renderHeight = 2880;
+        int32_t distortionMeshResolution = 43;
+        float ipdMeters = 0.064f;
+
+        // Tangents of the half-angles, as returned by GetProjectionRaw(), for each eye.
+        float projectionRaw[2][4] = {{-1.3f, 1.1f, -1.2f, 1.2f}, {-1.1f, 1.3f, -1.2f, 1.2f}};
+
+        // The vendor's own distortion: a radial polynomial in UV space with lateral chromatic aberration.
+        float vendorK1 = 0.22f;
+        float vendorK2 = 0.05f;
+        float vendorChromaticAberration = 0.015f;
+
+        // Simulated cost of the vendor's ComputeDistortion().
+        std::chrono::nanoseconds computeDistortionDelay{0};
+    };
+
+    // A fake vendor HMD driver. It registers itself like a real driver would, and counts the calls it receives.
+    class ScriptedHmdDriver : public vr::ITrackedDeviceServerDriver, public vr::IVRDisplayComponent {
+      public:
+        explicit ScriptedHmdDriver(const DisplayScript& script);
+
+        // Announce the device to vrserver, ie: through IVRServerDriverHost::TrackedDeviceAdded() of the given flavor.
+        bool Register(const char* serverDriverHostVersion = vr::IVRServerDriverHost_Version);
+
+        vr::EVRInitError Activate(uint32_t unObjectId) override;
+        void Deactivate() override;
+        void EnterStandby() override;
+        void* GetComponent(const char* pchComponentNameAndVersion) override;
+        void DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize) override;
+        vr::DriverPose_t GetPose() override;
+
+        void GetWindowBounds(int32_t* pnX, int32_t* pnY, uint32_t* pnWidth, uint32_t* pnHeight) override;
+        bool IsDisplayOnDesktop() override;
+        bool IsDisplayRealDisplay() override;
+        void GetRecommendedRenderTargetSize(uint32_t* pnWidth, uint32_t* pnHeight) override;
+        void GetEyeOutputViewport(
+            vr::EVREye eEye, uint32_t* pnX, uint32_t* pnY, uint32_t* pnWidth, uint32_t* pnHeight) override;
+        void GetProjectionRaw(vr::EVREye eEye, float* pfLeft, float* pfRight, float* pfTop, float* pfBottom) override;
+        vr::DistortionCoordinates_t ComputeDistortion(vr::EVREye eEye, float fU, float fV) override;
+        bool ComputeInverseDistortion(
+            vr::HmdVector2_t* pResult, vr::EVREye eEye, uint32_t unChannel, float fU, float fV) override;
+
+        const DisplayScript& Script() const {
+            return m_script;
+        }
+
+        vr::TrackedDeviceIndex_t deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
+
+        std::atomic<uint64_t> activateCalls{0};
+        std::atomic<uint64_t> deactivateCalls{0};
+        std::atomic<uint64_t> getEyeOutputViewportCalls{0};
+        std::atomic<uint64_t> getProjectionRawCalls{0};
+        std::atomic<uint64_t> computeDistortionCalls{0};
+
+      private:
+        const DisplayScript m_script;
+    };
+
+} // namespace shim_host
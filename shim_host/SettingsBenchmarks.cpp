@@ -0,0 +1,96 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "LensAnalysis.h"
+#include "LensProfile.h"
+#include "ShimHost.h"
+
+namespace shim_host {
+
+    void RunSettingsBenchmarks(BenchmarkRunner& runner, const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return;
+        }
+
+        const LensProfile base = LensProfile::FromSettings(&host.Runtime().settings);
+        const auto variants = LensProfile::Variants(base, host.Vendor().Script().eyeWidth);
+        const LensProfile& profileA = variants[1].second;
+        const LensProfile& profileB = variants.back().second;
+        vr::IVRDisplayComponent* const display = host.Display();
+
+        // A settings event that does not touch the distortion: the cost of re-reading the model.
+        host.ChangeSettings([&](FakeSettings& settings) { profileA.ToSettings(&settings); });
+        runner.Run("SettingsChange/unchanged", 1.0, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                host.ChangeSettings([](FakeSettings&) {});
+            }
+        });
+
+        // Alternate between two models, so that each event commits a new model and notifies the compositor.
+        runner.Run("SettingsChange/changed", 1.0, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                const LensProfile& profile = (i & 1) ? profileA : profileB;
+                host.ChangeSettings([&](FakeSettings& settings) { profile.ToSettings(&settings); });
+            }
+        });
+
+        // The fold-over analysis that runs upon each commit, for one channel.
+        std::vector<LensProfile::Channel> channels;
+        for (const auto& variant : variants) {
+            channels.push_back(variant.second.eyes[0].channels[0]);
+        }
+        runner.Run("FoldOverAnalysis", 1.0, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                const LensProfile::Channel& c = channels[i % channels.size()];
+                DoNotOptimize(driver_shim::FindFoldOverRadius(c.k1, c.k2, c.k3));
+            }
+        });
+
+        // The latency until the compositor has a new mesh: the settings change, then the full mesh resampling at the
+        // resolution advertised by the device.
+        const vr::PropertyContainerHandle_t container =
+            host.Runtime().properties.TrackedDeviceToPropertyContainer(host.Vendor().deviceIndex);
+        const int n =
+            std::max(2, vr::VRProperties()->GetInt32Property(container, vr::Prop_DistortionMeshResolution_Int32));
+        const std::string name = "MeshRebuild/" + std::to_string(n);
+        runner.Run(name, 1.0, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                const LensProfile& profile = (i & 1) ? profileA : profileB;
+                host.ChangeSettings([&](FakeSettings& settings) { profile.ToSettings(&settings); });
+                for (int eye = 0; eye < 2; eye++) {
+                    for (int y = 0; y < n; y++) {
+                        const float v = (float)y / (n - 1);
+                        for (int x = 0; x < n; x++) {
+                            const float u = (float)x / (n - 1);
+                            DoNotOptimize(display->ComputeDistortion((vr::EVREye)eye, u, v));
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+} // namespace shim_host
@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "ShimHost.h"
+
+// Entry point of the shim driver (Driver.cpp).
+HMD_DLL_EXPORT void* HmdDriverFactory(const char* pInterfaceName, int* pReturnCode);
+
+namespace shim_host {
+
+    ShimHost::Options ShimHost::OptionsFromArguments(const Arguments& args) {
+        Options options;
+        options.settingsPath = args.Get("settings", options.settingsPath);
+        options.verbose = args.Has("verbose");
+        options.tracePath = args.Get("trace");
+        options.display.eyeWidth = (uint32_t)args.GetInt("eye-width", options.display.eyeWidth);
+        options.display.eyeHeight = (uint32_t)args.GetInt("eye-height", options.display.eyeHeight);
+        options.display.distortionMeshResolution =
+            (int32_t)args.GetInt("mesh-resolution", options.display.distortionMeshResolution);
+        return options;
+    }
+
+    ShimHost::ShimHost(const Options& options) : m_options(options), m_vendor(options.display) {
+        m_runtime.driverLog.verbose = options.verbose;
+    }
+
+    ShimHost::~ShimHost() {
+        Stop();
+    }
+
+    bool ShimHost::Start() {
+        if (!m_runtime.settings.LoadFromFile(m_options.settingsPath)) {
+            fprintf(stderr, "Failed to load settings from %s\n", m_options.settingsPath.c_str());
+            return false;
+        }
+        if (!m_options.tracePath.empty()) {
+            m_runtime.settings.SetString("driver_distortion_shim", "trace_file", m_options.tracePath.c_str());
+        }
+        if (m_options.overrideSettings) {
+            m_options.overrideSettings(m_runtime.settings);
+        }
+
+        int returnCode = 0;
+        m_provider =
+            (vr::IServerTrackedDeviceProvider*)HmdDriverFactory(vr::IServerTrackedDeviceProvider_Version, &returnCode);
+        if (!m_provider) {
+            fprintf(stderr, "HmdDriverFactory() failed: %d\n", returnCode);
+            return false;
+        }
+
+        const vr::EVRInitError status = m_provider->Init(&m_runtime);
+        if (status != vr::VRInitError_None) {
+            fprintf(stderr, "Init() failed: %d\n", (int)status);
+            m_provider = nullptr;
+            return false;
+        }
+
+        // The vendor driver is loaded after the shim (lower loadPriority).
+        if (!m_vendor.Register(m_options.serverDriverHostVersion.c_str())) {
+            fprintf(stderr, "TrackedDeviceAdded() failed\n");
+            return false;
+        }
+
+        const auto devices = m_runtime.serverDriverHost.GetDevices();
+        if (devices.empty()) {
+            return false;
+        }
+        m_device = devices.back().driver;
+        m_display = (vr::IVRDisplayComponent*)m_device->GetComponent(vr::IVRDisplayComponent_Version);
+
+        return m_display != nullptr;
+    }
+
+    void ShimHost::Stop() {
+        if (m_device) {
+            m_device->Deactivate();
+            m_device = nullptr;
+            m_display = nullptr;
+        }
+        if (m_provider) {
+            m_provider->Cleanup();
+            m_provider = nullptr;
+        }
+    }
+
+    void ShimHost::RunFrame() {
+        m_provider->RunFrame();
+    }
+
+    void ShimHost::ChangeSettings(const std::function<void(FakeSettings&)>& change) {
+        change(m_runtime.settings);
+        m_runtime.serverDriverHost.QueueEvent(vr::VREvent_AnyDriverSettingsChanged);
+        RunFrame();
+    }
+
+} // namespace shim_host
@@ -0,0 +1,96 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Arguments.h"
+#include "FakeRuntime.h"
+#include "ScriptedHmdDriver.h"
+
+namespace shim_host {
+
+    // Loads the shim driver in-process, like vrserver would: HmdDriverFactory(), Init() with the fake runtime, then
+    // the scripted vendor driver registers its HMD, which the shim's TrackedDeviceAdded hook wraps.
+    class ShimHost {
+      public:
+        struct Options {
+            std::string settingsPath = "base/resources/settings/default.vrsettings";
+            DisplayScript display;
+            bool verbose = false;
+
+            // Record the display calls received by the shim (the trace_file setting).
+            std::string tracePath;
+
+            // The flavor of IVRServerDriverHost that the scripted vendor driver registers its HMD through.
+            std::string serverDriverHostVersion = vr::IVRServerDriverHost_Version;
+
+            // Applied to the settings after loading them, before the shim is loaded.
+            std::function<void(FakeSettings&)> overrideSettings;
+        };
+
+        // Common options: --settings <path>, --verbose, --eye-width <px>, --eye-height <px>, --mesh-resolution <n>,
+        // --trace <path>.
+        static Options OptionsFromArguments(const Arguments& args);
+
+        explicit ShimHost(const Options& options);
+        ~ShimHost();
+
+        bool Start();
+        void Stop();
+
+        // Run one frame of the shim driver, ie: drain the pending events.
+        void RunFrame();
+
+        // Modify the settings and notify the driver, like the SteamVR settings UI does.
+        void ChangeSettings(const std::function<void(FakeSettings&)>& change);
+
+        FakeRuntime& Runtime() {
+            return m_runtime;
+        }
+
+        ScriptedHmdDriver& Vendor() {
+            return m_vendor;
+        }
+
+        // The device and display component as seen by vrserver, ie: the shim when it wrapped the vendor device.
+        vr::ITrackedDeviceServerDriver* Device() const {
+            return m_device;
+        }
+
+        vr::IVRDisplayComponent* Display() const {
+            return m_display;
+        }
+
+        bool IsShimmed() const {
+            return m_device && m_device != &m_vendor;
+        }
+
+      private:
+        const Options m_options;
+        FakeRuntime m_runtime;
+        ScriptedHmdDriver m_vendor;
+        vr::IServerTrackedDeviceProvider* m_provider = nullptr;
+        vr::ITrackedDeviceServerDriver* m_device = nullptr;
+        vr::IVRDisplayComponent* m_display = nullptr;
+    };
+
+} // namespace shim_host
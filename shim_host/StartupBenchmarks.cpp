@@ -0,0 +1,110 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    struct PhaseTiming {
+        std::string name;
+        double durationMs = 0.0;
+        double budgetMs = 0.0;
+        uint64_t count = 0;
+    };
+
+    // Query the shim's startup timings, like a debugging tool would through vrserver.
+    std::vector<PhaseTiming> QueryStartupTimings(ShimHost& host) {
+        char response[4096] = {};
+        host.Device()->DebugRequest("distortion_shim:startup", response, sizeof(response));
+
+        std::vector<PhaseTiming> timings;
+        std::istringstream lines(response);
+        std::string line;
+        while (std::getline(lines, line)) {
+            PhaseTiming timing;
+            std::istringstream fields(line);
+            if (fields >> timing.name >> timing.durationMs >> timing.budgetMs >> timing.count) {
+                timings.push_back(std::move(timing));
+            }
+        }
+        return timings;
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    void RunStartupBenchmarks(BenchmarkRunner& runner, const Arguments& args) {
+        const ShimHost::Options options = ShimHost::OptionsFromArguments(args);
+        const int repetitions = BenchmarkRunner::OptionsFromArguments(args).repetitions;
+
+        // Each repetition boots a new fake vrserver. The shim is only loaded once per process, so the phases of the
+        // first boot (eg: InstallHook) are only measured once, when this suite runs first.
+        BenchmarkResult total;
+        total.name = "Startup/Start";
+        total.iterations = 1;
+        std::map<std::string, BenchmarkResult> phases;
+        std::map<std::string, uint64_t> counts;
+        std::map<std::string, double> budgets;
+        for (int i = 0; i < repetitions; i++) {
+            ShimHost host(options);
+            const auto start = std::chrono::steady_clock::now();
+            if (!host.Start()) {
+                return;
+            }
+            const double elapsed =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            total.realTimeNs.push_back(elapsed);
+            total.cpuTimeNs.push_back(elapsed);
+
+            for (const PhaseTiming& timing : QueryStartupTimings(host)) {
+                // Only the phases that ran during this boot.
+                if (timing.count == counts[timing.name]) {
+                    continue;
+                }
+                counts[timing.name] = timing.count;
+                budgets[timing.name] = timing.budgetMs;
+
+                BenchmarkResult& result = phases[timing.name];
+                result.name = "Startup/" + timing.name;
+                result.iterations = 1;
+                result.realTimeNs.push_back(timing.durationMs * 1e6);
+                result.cpuTimeNs.push_back(timing.durationMs * 1e6);
+            }
+        }
+
+        runner.Record(std::move(total));
+        for (auto& [name, result] : phases) {
+            const double budgetMs = budgets[name];
+            const double worstMs = *std::max_element(result.realTimeNs.begin(), result.realTimeNs.end()) / 1e6;
+            runner.Record(std::move(result));
+            if (budgetMs > 0.0 && worstMs > budgetMs) {
+                printf("  ^ OVER BUDGET: %.3f ms (budget %.3f ms)\n", worstMs, budgetMs);
+            }
+        }
+    }
+
+} // namespace shim_host
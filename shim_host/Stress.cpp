@@ -0,0 +1,218 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+#include "LensProfile.h"
+#include "ShimHost.h"
+
+#include <random>
+
+namespace {
+    using namespace shim_host;
+
+    struct StressPoint {
+        vr::EVREye eye;
+        float u;
+        float v;
+    };
+
+    struct PhaseResult {
+        double seconds = 0.0;
+        uint64_t calls = 0;
+        uint64_t inconsistentResults = 0;
+        uint64_t modelSwitches = 0;
+        uint64_t settingsEvents = 0;
+        uint64_t activationCycles = 0;
+    };
+
+    bool SameResult(const vr::DistortionCoordinates_t& a, const vr::DistortionCoordinates_t& b) {
+        return !memcmp(&a, &b, sizeof(a));
+    }
+
+    class StressTest {
+      public:
+        StressTest(ShimHost& host, uint32_t seed) : m_host(host), m_seed(seed) {
+            // Each variant, and a copy with a single setting changed (like a slider in the settings UI).
+            const auto variants = LensProfile::Variants(LensProfile::FromSettings(&host.Runtime().settings),
+                                                        host.Vendor().Script().eyeWidth);
+            for (const auto& variant : variants) {
+                m_profiles.push_back(variant.second);
+                LensProfile tweaked = variant.second;
+                tweaked.eyes[vr::Eye_Left].channels[1].codX += 0.01f;
+                m_profiles.push_back(tweaked);
+            }
+
+            std::mt19937 generator(seed);
+            std::uniform_real_distribution<float> distribution(0.f, 1.f);
+            for (int i = 0; i < 256; i++) {
+                const float u = distribution(generator);
+                m_points.push_back({(vr::EVREye)(i & 1), u, distribution(generator)});
+            }
+
+            // The results of every model version, computed without any concurrency.
+            for (const LensProfile& profile : m_profiles) {
+                m_host.ChangeSettings([&](FakeSettings& settings) { profile.ToSettings(&settings); });
+                std::vector<vr::DistortionCoordinates_t> expected;
+                for (const StressPoint& point : m_points) {
+                    expected.push_back(m_host.Display()->ComputeDistortion(point.eye, point.u, point.v));
+                }
+                m_expected.push_back(std::move(expected));
+            }
+        }
+
+        // Distortion callers on the worker threads, and optionally model changes and activation cycles on the
+        // calling thread.
+        PhaseResult Run(uint32_t threadCount, double seconds, bool contended) {
+            PhaseResult result;
+            std::atomic<bool> stop{false};
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> inconsistentResults{0};
+
+            std::vector<std::thread> callers;
+            for (uint32_t i = 0; i < threadCount; i++) {
+                callers.emplace_back([&, i] {
+                    std::mt19937 generator(m_seed + i);
+                    vr::IVRDisplayComponent* const display = m_host.Display();
+                    uint64_t localCalls = 0;
+                    size_t lastVersion = 0;
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        const size_t index = generator() % m_points.size();
+                        const StressPoint& point = m_points[index];
+                        const vr::DistortionCoordinates_t distorted =
+                            display->ComputeDistortion(point.eye, point.u, point.v);
+                        localCalls++;
+
+                        // The result must match one of the model versions exactly, for all channels.
+                        if (!SameResult(distorted, m_expected[lastVersion][index])) {
+                            size_t version = 0;
+                            while (version < m_expected.size() && !SameResult(distorted, m_expected[version][index])) {
+                                version++;
+                            }
+                            if (version == m_expected.size()) {
+                                if (inconsistentResults++ == 0) {
+                                    fprintf(stderr,
+                                            "Inconsistent result for eye %d at (%f, %f)\n",
+                                            (int)point.eye,
+                                            point.u,
+                                            point.v);
+                                }
+                            } else {
+                                lastVersion = version;
+                            }
+                        }
+                    }
+                    calls += localCalls;
+                });
+            }
+
+            std::mt19937 generator(m_seed ^ 0xc0ffee);
+            const uint32_t deviceIndex = m_host.Vendor().deviceIndex;
+            const auto start = std::chrono::steady_clock::now();
+            const auto deadline = start + std::chrono::duration<double>(seconds);
+            while (std::chrono::steady_clock::now() < deadline) {
+                if (!contended) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+
+                switch (generator() % 4) {
+                case 0:
+                case 1: {
+                    // Switch to another model.
+                    const LensProfile& profile = m_profiles[generator() % m_profiles.size()];
+                    m_host.ChangeSettings([&](FakeSettings& settings) { profile.ToSettings(&settings); });
+                    result.modelSwitches++;
+                    break;
+                }
+                case 2:
+                    // A settings event that does not affect the model.
+                    m_host.ChangeSettings([](FakeSettings&) {});
+                    result.settingsEvents++;
+                    break;
+                case 3:
+                    m_host.Device()->Deactivate();
+                    m_host.Device()->Activate(deviceIndex);
+                    result.activationCycles++;
+                    break;
+                }
+            }
+
+            stop = true;
+            for (auto& caller : callers) {
+                caller.join();
+            }
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            result.calls = calls;
+            result.inconsistentResults = inconsistentResults;
+            return result;
+        }
+
+      private:
+        ShimHost& m_host;
+        const uint32_t m_seed;
+        std::vector<LensProfile> m_profiles;
+        std::vector<StressPoint> m_points;
+        std::vector<std::vector<vr::DistortionCoordinates_t>> m_expected;
+    };
+
+    void PrintPhase(const char* name, uint32_t threadCount, const PhaseResult& result) {
+        printf("%-10s %2u threads  %8.2f Mcalls/s (%7.2f Mcalls/s per thread)  %6llu switches  %6llu events  %5llu "
+               "cycles  %llu inconsistent\n",
+               name,
+               threadCount,
+               result.calls / result.seconds * 1e-6,
+               result.calls / result.seconds * 1e-6 / threadCount,
+               (unsigned long long)result.modelSwitches,
+               (unsigned long long)result.settingsEvents,
+               (unsigned long long)result.activationCycles,
+               (unsigned long long)result.inconsistentResults);
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunStress(const Arguments& args) {
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+
+        const uint32_t threadCount = (uint32_t)std::max<int64_t>(
+            1, args.GetInt("threads", std::max(4u, std::thread::hardware_concurrency())));
+        const double seconds = args.GetDouble("duration", 2.0);
+        StressTest test(host, (uint32_t)args.GetInt("seed", 1));
+
+        // The throughput without any model change, for reference.
+        const PhaseResult quiet = test.Run(threadCount, seconds / 2, false);
+        PrintPhase("quiet", threadCount, quiet);
+        const PhaseResult contended = test.Run(threadCount, seconds, true);
+        PrintPhase("contended", threadCount, contended);
+
+        const uint64_t inconsistentResults = quiet.inconsistentResults + contended.inconsistentResults;
+        printf("%s\n", inconsistentResults ? "FAILED" : "PASSED");
+        return inconsistentResults ? 1 : 0;
+    }
+
+} // namespace shim_host
@@ -0,0 +1,260 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+#include "Image.h"
+#include "LensProfile.h"
+#include "Parallel.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    // A position in pixels of the rendered eye image, and its derivatives along the display axes.
+    struct Sample {
+        float x;
+        float y;
+        float dxdx;
+        float dxdy;
+        float dydx;
+        float dydy;
+    };
+
+    enum PixelState : uint8_t { Valid, Outside, Folded };
+
+} // namespace
+
+namespace shim_host {
+
+    int RunVisualize(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host visualize <output prefix> [--variant <name>] [--eye left|right|both] "
+                    "[--scale <n>] [--grid <n>] [--format png|ppm] [--threads <n>]\n");
+            return 1;
+        }
+
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+        vr::IVRDisplayComponent* const display = host.Display();
+
+        // Visualize the model of the shim, after applying the variant to its settings.
+        const std::string variant = args.Get("variant", "settings");
+        const std::optional<LensProfile> profile = LensProfile::FindVariant(
+            LensProfile::FromSettings(&host.Runtime().settings), host.Vendor().Script().eyeWidth, variant);
+        if (!profile) {
+            fprintf(stderr, "Unknown variant: %s\n", variant.c_str());
+            return 1;
+        }
+        host.ChangeSettings([&](FakeSettings& settings) { profile->ToSettings(&settings); });
+
+        const std::string prefix = args.Positional()[0];
+        const std::string format = args.Get("format", "png");
+        const std::string eyes = args.Get("eye", "both");
+        const uint32_t scale = (uint32_t)std::max<int64_t>(1, args.GetInt("scale", 1));
+        const float gridCount = (float)std::max<int64_t>(1, args.GetInt("grid", 16));
+        const uint32_t threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+        uint32_t renderWidth, renderHeight;
+        display->GetRecommendedRenderTargetSize(&renderWidth, &renderHeight);
+
+        for (int eye = 0; eye < 2; eye++) {
+            if (eyes != "both" && eyes != EyeNames[eye]) {
+                continue;
+            }
+            uint32_t viewportX, viewportY, viewportWidth, viewportHeight;
+            display->GetEyeOutputViewport((vr::EVREye)eye, &viewportX, &viewportY, &viewportWidth, &viewportHeight);
+            const uint32_t width = std::max(2u, viewportWidth / scale);
+            const uint32_t height = std::max(2u, viewportHeight / scale);
+            const auto start = std::chrono::steady_clock::now();
+
+            // One call to the shim per pixel, at the pixel centers.
+            std::vector<vr::DistortionCoordinates_t> coordinates((size_t)width * height);
+            ParallelFor(threadCount, height, [&](size_t begin, size_t end) {
+                for (size_t y = begin; y < end; y++) {
+                    const float v = (y + 0.5f) / height;
+                    for (uint32_t x = 0; x < width; x++) {
+                        coordinates[y * width + x] =
+                            display->ComputeDistortion((vr::EVREye)eye, (x + 0.5f) / width, v);
+                    }
+                }
+            });
+            const auto evaluated = std::chrono::steady_clock::now();
+
+            // The coordinates of each channel in pixels of the rendered eye image, and their derivatives per display
+            // pixel by central differences (one-sided on the edges).
+            const float pixelScale = (float)viewportWidth / width;
+            const auto Evaluate = [&](uint32_t x, uint32_t y, int channel, Sample& sample) {
+                const auto Texel = [&](uint32_t x, uint32_t y, int axis) {
+                    const vr::DistortionCoordinates_t& c = coordinates[(size_t)y * width + x];
+                    const float* const uv = channel == 0 ? c.rfRed : channel == 1 ? c.rfGreen : c.rfBlue;
+                    return uv[axis] * (axis == 0 ? renderWidth : renderHeight);
+                };
+                const uint32_t left = x > 0 ? x - 1 : x;
+                const uint32_t right = x + 1 < width ? x + 1 : x;
+                const uint32_t up = y > 0 ? y - 1 : y;
+                const uint32_t down = y + 1 < height ? y + 1 : y;
+                const float spanX = (right - left) * pixelScale;
+                const float spanY = (down - up) * pixelScale;
+                sample.x = Texel(x, y, 0);
+                sample.y = Texel(x, y, 1);
+                sample.dxdx = (Texel(right, y, 0) - Texel(left, y, 0)) / spanX;
+                sample.dydx = (Texel(right, y, 1) - Texel(left, y, 1)) / spanX;
+                sample.dxdy = (Texel(x, down, 0) - Texel(x, up, 0)) / spanY;
+                sample.dydy = (Texel(x, down, 1) - Texel(x, up, 1)) / spanY;
+            };
+            const auto Inside = [&](const Sample& sample) {
+                return sample.x >= 0 && sample.y >= 0 && sample.x <= renderWidth && sample.y <= renderHeight;
+            };
+
+            Image grid, chromatic, densityMap, valid;
+            for (Image* image : {&grid, &chromatic, &densityMap, &valid}) {
+                image->Resize(width, height, 3);
+                image->metadata["eye"] = EyeNames[eye];
+                image->metadata["variant"] = variant;
+            }
+            const float cellWidth = renderWidth / gridCount;
+            const float cellHeight = renderHeight / gridCount;
+            // The chromatic separation (the distance from red and blue to green) and the pixel density of green
+            // (rendered pixels per display pixel, along each axis), then their ranges over the valid region for the
+            // color scales.
+            std::vector<float> separation((size_t)width * height);
+            std::vector<float> density((size_t)width * height);
+            std::vector<uint8_t> state((size_t)width * height);
+            ParallelFor(threadCount, height, [&](size_t begin, size_t end) {
+                for (uint32_t y = (uint32_t)begin; y < end; y++) {
+                    for (uint32_t x = 0; x < width; x++) {
+                        const size_t i = (size_t)y * width + x;
+                        Sample samples[3];
+                        bool inside = true, folded = false;
+                        for (int channel = 0; channel < 3; channel++) {
+                            Sample& sample = samples[channel];
+                            Evaluate(x, y, channel, sample);
+                            inside = inside && Inside(sample);
+                            folded = folded || sample.dxdx * sample.dydy - sample.dxdy * sample.dydx <= 0;
+                        }
+
+                        // The lines of the grid of the rendered image, for each channel, antialiased over about a
+                        // display pixel: the distance to the nearest line, in display pixels, from the derivatives.
+                        uint8_t* const gridPixel = grid.Pixel(x, y);
+                        for (int channel = 0; channel < 3; channel++) {
+                            const Sample& sample = samples[channel];
+                            if (!Inside(sample)) {
+                                gridPixel[channel] = 0;
+                                continue;
+                            }
+                            const float cellX = sample.x / cellWidth;
+                            const float cellY = sample.y / cellHeight;
+                            const float distanceX = std::abs(cellX - (int)(cellX + 0.5f)) * cellWidth /
+                                                    std::sqrt(sample.dxdx * sample.dxdx + sample.dxdy * sample.dxdy);
+                            const float distanceY = std::abs(cellY - (int)(cellY + 0.5f)) * cellHeight /
+                                                    std::sqrt(sample.dydx * sample.dydx + sample.dydy * sample.dydy);
+                            const float coverage =
+                                1.f - std::min(std::min(distanceX, distanceY) / pixelScale / 1.5f, 1.f);
+                            gridPixel[channel] = (uint8_t)(32 + 223 * coverage);
+                        }
+
+                        const Sample& green = samples[1];
+                        const float redX = samples[0].x - green.x, redY = samples[0].y - green.y;
+                        const float blueX = samples[2].x - green.x, blueY = samples[2].y - green.y;
+                        separation[i] = std::sqrt(std::max(redX * redX + redY * redY, blueX * blueX + blueY * blueY));
+                        density[i] = std::sqrt(std::abs(green.dxdx * green.dydy - green.dxdy * green.dydx));
+                        state[i] = folded ? Folded : inside ? Valid : Outside;
+                    }
+                }
+            });
+            float maxSeparation = 0, minDensity = std::numeric_limits<float>::max(), maxDensity = 0;
+            size_t validCount = 0, foldedCount = 0;
+            for (size_t i = 0; i < state.size(); i++) {
+                foldedCount += state[i] == Folded;
+                if (state[i] == Valid) {
+                    validCount++;
+                    maxSeparation = std::max(maxSeparation, separation[i]);
+                    minDensity = std::min(minDensity, density[i]);
+                    maxDensity = std::max(maxDensity, density[i]);
+                }
+            }
+            if (!validCount) {
+                minDensity = maxDensity = 0;
+            }
+
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "0 %.6g", maxSeparation);
+            chromatic.metadata["range"] = buffer;
+            snprintf(buffer, sizeof(buffer), "%.6g %.6g", minDensity, maxDensity);
+            densityMap.metadata["range"] = buffer;
+            ParallelFor(threadCount, height, [&](size_t begin, size_t end) {
+                for (uint32_t y = (uint32_t)begin; y < end; y++) {
+                    for (uint32_t x = 0; x < width; x++) {
+                        const size_t i = (size_t)y * width + x;
+                        if (state[i] == Valid) {
+                            ApplyColormap(maxSeparation > 0 ? separation[i] / maxSeparation : 0, chromatic.Pixel(x, y));
+                            ApplyColormap(
+                                maxDensity > minDensity ? (density[i] - minDensity) / (maxDensity - minDensity) : 0,
+                                densityMap.Pixel(x, y));
+                        }
+
+                        // White where valid, red past the edges of the rendered image, magenta where it folds over.
+                        uint8_t* const validPixel = valid.Pixel(x, y);
+                        validPixel[0] = 255;
+                        validPixel[1] = state[i] == Valid ? 255 : 0;
+                        validPixel[2] = state[i] == Outside ? 0 : 255;
+                    }
+                }
+            });
+            const auto rendered = std::chrono::steady_clock::now();
+
+            for (const auto& output : {std::make_pair("grid", &grid),
+                                       std::make_pair("chromatic", &chromatic),
+                                       std::make_pair("density", &densityMap),
+                                       std::make_pair("valid", &valid)}) {
+                const std::string path = prefix + "_" + EyeNames[eye] + "_" + output.first + "." + format;
+                if (!SaveImage(path, *output.second)) {
+                    fprintf(stderr, "Failed to write %s\n", path.c_str());
+                    return 1;
+                }
+            }
+
+            const size_t center = (size_t)(height / 2) * width + width / 2;
+            printf("%s: %ux%u, chromatic separation up to %.2f px, density %.3f-%.3f (%.3f at the center), "
+                   "%.1f%% valid, %.1f%% folded, evaluated in %.3f s, rendered in %.3f s\n",
+                   EyeNames[eye],
+                   width,
+                   height,
+                   maxSeparation,
+                   minDensity,
+                   maxDensity,
+                   density[center],
+                   100.0 * validCount / state.size(),
+                   100.0 * foldedCount / state.size(),
+                   std::chrono::duration<double>(evaluated - start).count(),
+                   std::chrono::duration<double>(rendered - evaluated).count());
+        }
+
+        return 0;
+    }
+
+} // namespace shim_host
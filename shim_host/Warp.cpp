@@ -0,0 +1,135 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+#include "Compositor.h"
+#include "Image.h"
+#include "LensProfile.h"
+#include "ShimHost.h"
+
+namespace {
+    using namespace shim_host;
+
+    // A grid of white lines over a color gradient, where the distortion and the chromatic aberration are easy to see.
+    void RenderTestImage(uint32_t width, uint32_t height, Image& image) {
+        image.Resize(width, height, 3);
+        const uint32_t spacing = std::max(8u, width / 32);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t* const pixel = image.Pixel(x, y);
+                if (x % spacing < 2 || y % spacing < 2) {
+                    pixel[0] = pixel[1] = pixel[2] = 255;
+                } else {
+                    pixel[0] = (uint8_t)(32 + 96 * x / width);
+                    pixel[1] = (uint8_t)32;
+                    pixel[2] = (uint8_t)(32 + 96 * y / height);
+                }
+            }
+        }
+    }
+
+} // namespace
+
+namespace shim_host {
+
+    int RunWarp(const Arguments& args) {
+        if (args.Positional().empty()) {
+            fprintf(stderr,
+                    "Usage: shim_host warp <output.ppm|png> [--input <eye image.ppm|pgm>] [--eye left|right] "
+                    "[--variant <name>] [--resolution <n>] [--threads <n>] [--repetitions <n>]\n");
+            return 1;
+        }
+
+        ShimHost host(ShimHost::OptionsFromArguments(args));
+        if (!host.Start()) {
+            return 1;
+        }
+        vr::IVRDisplayComponent* const display = host.Display();
+
+        // Warp with the model of the shim, after applying the variant to its settings.
+        const std::string variant = args.Get("variant", "settings");
+        const std::optional<LensProfile> profile = LensProfile::FindVariant(
+            LensProfile::FromSettings(&host.Runtime().settings), host.Vendor().Script().eyeWidth, variant);
+        if (!profile) {
+            fprintf(stderr, "Unknown variant: %s\n", variant.c_str());
+            return 1;
+        }
+        host.ChangeSettings([&](FakeSettings& settings) { profile->ToSettings(&settings); });
+
+        const vr::PropertyContainerHandle_t container =
+            host.Runtime().properties.TrackedDeviceToPropertyContainer(host.Vendor().deviceIndex);
+        if (args.Has("resolution")) {
+            vr::VRProperties()->SetInt32Property(
+                container, vr::Prop_DistortionMeshResolution_Int32, (int32_t)args.GetInt("resolution", 0));
+        }
+        const uint32_t threadCount =
+            (uint32_t)std::max<int64_t>(1, args.GetInt("threads", std::thread::hardware_concurrency()));
+        SimulatedCompositor compositor(host, threadCount);
+        compositor.BuildMesh();
+
+        Image source;
+        const std::string input = args.Get("input");
+        if (!input.empty()) {
+            if (!LoadPnm(input, source)) {
+                fprintf(stderr, "Failed to read %s\n", input.c_str());
+                return 1;
+            }
+        } else {
+            uint32_t renderWidth, renderHeight;
+            display->GetRecommendedRenderTargetSize(&renderWidth, &renderHeight);
+            RenderTestImage(renderWidth, renderHeight, source);
+        }
+
+        const vr::EVREye eye = args.Get("eye", "left") == "right" ? vr::Eye_Right : vr::Eye_Left;
+        uint32_t x, y, width, height;
+        display->GetEyeOutputViewport(eye, &x, &y, &width, &height);
+
+        Image output;
+        const int64_t repetitions = std::max<int64_t>(1, args.GetInt("repetitions", 5));
+        double best = std::numeric_limits<double>::max();
+        for (int64_t i = 0; i < repetitions; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            WarpImage(source, compositor.Mesh(eye), compositor.Resolution(), width, height, output, threadCount);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        if (!SaveImage(args.Positional()[0], output)) {
+            fprintf(stderr, "Failed to write %s\n", args.Positional()[0].c_str());
+            return 1;
+        }
+        printf("Warped %ux%u into %ux%u (%s eye, profile %s, mesh %d, %u thread(s)) in %.3f ms (%.1f Mpixels/s)\n",
+               source.width,
+               source.height,
+               width,
+               height,
+               EyeNames[eye],
+               variant.c_str(),
+               compositor.Resolution(),
+               threadCount,
+               best * 1e3,
+               width * (double)height / best / 1e6);
+        return 0;
+    }
+
+} // namespace shim_host
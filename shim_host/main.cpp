@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "Commands.h"
+
+namespace {
+    using namespace shim_host;
+
+    struct Command {
+        const char* name;
+        const char* description;
+        int (*run)(const Arguments& args);
+    };
+
+    const Command commands[] = {
+        {"mesh", "Dump the distortion mesh computed by the shim", RunMesh},
+        {"evaluate", "Evaluate the distortion of the shim over a file of points", RunEvaluate},
+        {"warp", "Apply the distortion of the shim to an eye image", RunWarp},
+        {"visualize", "Render diagnostic images of the distortion of the shim", RunVisualize},
+        {"bench", "Run the benchmark suites", RunBench},
+        {"compare", "Flag the benchmark regressions against a baseline", RunCompare},
+        {"accuracy", "Check the distortion paths against the reference evaluator", RunAccuracy},
+        {"foldover", "Report where the lens model folds over", RunFoldOver},
+        {"synthesize", "Write synthetic calibration correspondences", RunSynthesize},
+        {"capture", "Render a simulated capture of a calibration pattern", RunCapture},
+        {"detect", "Detect calibration features in a capture", RunDetect},
+        {"fit", "Fit the lens profile to calibration correspondences", RunFit},
+        {"refit", "Approximate another distortion with the lens model of the shim", RunRefit},
+        {"compose", "Check the composition on top of the vendor distortion", RunCompose},
+        {"hiddenarea", "Derive the hidden area meshes from the lens model", RunHiddenArea},
+        {"modules", "Check the module index used to find the target driver", RunModules},
+        {"loaders", "Check the file loaders against valid and corrupt files", RunLoaders},
+        {"replay", "Replay and measure a trace recorded by the shim", RunReplay},
+        {"stress", "Check the model consistency under concurrent settings changes", RunStress},
+    };
+
+    void PrintUsage() {
+        fprintf(stderr, "Usage: shim_host <command> [options]\n\nCommands:\n");
+        for (const auto& command : commands) {
+            fprintf(stderr, "  %-12s %s\n", command.name, command.description);
+        }
+        fprintf(stderr,
+                "\nCommon options:\n"
+                "  --settings <path>        .vrsettings file to load (default: "
+                "base/resources/settings/default.vrsettings)\n"
+                "  --eye-width <px>         Panel width of the scripted HMD\n"
+                "  --eye-height <px>        Panel height of the scripted HMD\n"
+                "  --mesh-resolution <n>    Prop_DistortionMeshResolution_Int32 of the scripted HMD\n"
+                "  --trace <path>           Record the display calls received by the shim\n"
+                "  --verbose                Print the driver log\n");
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    for (const auto& command : commands) {
+        if (!strcmp(argv[1], command.name)) {
+            return command.run(Arguments(argc - 2, argv + 2));
+        }
+    }
+
+    fprintf(stderr, "Unknown command: %s\n\n", argv[1]);
+    PrintUsage();
+    return 1;
+}